@@ -0,0 +1,682 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "a_star.h"
+#include "a_star_kernel.h"
+#include "frontier/pqueue.h"
+
+#ifdef KS_A_STAR_DEBUG
+#include <stdio.h>
+#endif
+
+/**
+ * The search kernel. It is always inlined into the specialised kernels
+ * below with 'connectivity' and 'heuristic' being constants. So, the
+ * compiler generates a distinct kernel for each combination.
+ */
+static inline __attribute__((always_inline))
+int a_star_kernel(struct a_star_search *const search,
+                  const enum maze_connectivity connectivity,
+                  const enum maze_heuristic heuristic)
+{
+	struct maze_grid *const grid = search->grid;
+
+	const unsigned neighbours = (connectivity == CONNECTIVITY_8) ? 8 : 4;
+	const unsigned straight_cost = (connectivity == CONNECTIVITY_8) ? A_STAR_STRAIGHT_COST_8 : A_STAR_STRAIGHT_COST_4;
+	const unsigned goal_row = search->goal_row,
+	               goal_col = search->goal_col;
+	const size_t goal_cell = grid_cell(grid, goal_row, goal_col),
+	             start_cell = grid_cell(grid, search->start_row, search->start_col);
+	const unsigned weight = search->weight*WEIGHT_ONE + 0.5;
+
+	int ret_val = ERRNOPATH;
+	size_t generated = 0;
+	search->nodes_expanded = 0;
+
+	struct min_heap frontier;
+	initialise_min_heap(&frontier);
+
+	// insert the start pixel into the frontier
+	struct heap_elem curr;
+
+	curr.row = search->start_row;
+	curr.col = search->start_col;
+	curr.heuristic = weighted(heuristic_value(heuristic, straight_cost,
+	                                          abs_diff(curr.row, goal_row), abs_diff(curr.col, goal_col)),
+	                          weight);
+	curr.key = curr.heuristic;
+
+	grid->dist[start_cell] = 0;
+	grid->parent[start_cell] = GRID_DIR_NONE;
+
+	if (min_heap_insert(&frontier, &curr))
+	{
+		ret_val = ERRSEARCHMEMORY;
+		goto CLEANUP;
+	}
+
+	while (!min_heap_empty(&frontier))
+	{
+		extract_min(&frontier, &curr);
+
+		const size_t curr_cell = grid_cell(grid, curr.row, curr.col);
+		const unsigned curr_dist = grid->dist[curr_cell];
+
+		// skip the stale entries of pixels whose distance was lowered after
+		// they were inserted into the frontier
+		if (curr.key - curr.heuristic != curr_dist)
+		{
+			continue;
+		}
+
+		if (curr_cell == goal_cell)
+		{
+			ret_val = 0;
+			break;
+		}
+
+		search->nodes_expanded++;
+
+		bool clear[9];
+
+#pragma GCC unroll 8
+		for (unsigned dir = 1; dir <= neighbours; dir++)
+		{
+			size_t adj_cell;
+			unsigned cost;
+
+			if (!next_pixel(grid, &curr, dir, straight_cost, clear, &adj_cell, &cost) ||
+			    curr_dist+cost >= grid->dist[adj_cell])
+			{
+				continue;
+			}
+
+			// set the attributes
+			grid->dist[adj_cell] = curr_dist+cost;
+			grid->parent[adj_cell] = GRID_DIR_OPPOSITE(dir);
+
+			// insert the element into the frontier
+			struct heap_elem adj_elem;
+
+			adj_elem.row = curr.row + grid_dir_row[dir];
+			adj_elem.col = curr.col + grid_dir_col[dir];
+			adj_elem.heuristic = weighted(heuristic_value(heuristic, straight_cost,
+			                                              abs_diff(adj_elem.row, goal_row),
+			                                              abs_diff(adj_elem.col, goal_col)),
+			                              weight);
+			adj_elem.key = curr_dist+cost + adj_elem.heuristic;
+
+#ifdef KS_A_STAR_DEBUG
+			printf("a_star_kernel: heuristic (tie breaker): %u key: %u for pixel: (%u, %u)\n",
+			       adj_elem.heuristic, adj_elem.key, adj_elem.row, adj_elem.col);
+#endif
+
+			if (min_heap_insert(&frontier, &adj_elem))
+			{
+				ret_val = ERRSEARCHMEMORY;
+				goto CLEANUP;
+			}
+
+			generated++;
+		}
+	}
+
+CLEANUP:
+	search->nodes_generated = generated;
+	search->frontier_peak = frontier.peak_size;
+	delete_min_heap(&frontier);
+	return ret_val;
+}
+
+/**
+ * The cost of the path left in the grid, found by following the predecessors
+ * from the given pixel. It could be less than the distance of the pixel: the
+ * distances (and the predecessors) of the pixels in the path could have been
+ * lowered after the pixel was reached through them.
+ */
+static unsigned path_cost(const struct maze_grid *const grid, const unsigned straight_cost,
+                          unsigned row, unsigned col)
+{
+	unsigned cost = 0;
+	unsigned char parent;
+
+	while ((parent = grid->parent[grid_cell(grid, row, col)]) != GRID_DIR_NONE)
+	{
+		cost += (parent > GRID_DIR_DOWN) ? A_STAR_DIAGONAL_COST_8 : straight_cost;
+		row += grid_dir_row[parent];
+		col += grid_dir_col[parent];
+	}
+
+	return cost;
+}
+
+/**
+ * The flags of a pixel used during the anytime search.
+ */
+#define ANYTIME_CLOSED 1       // expanded during the current repetition
+#define ANYTIME_INCONSISTENT 2 // distance lowered after it was expanded
+
+/**
+ * A step of the path found by a previous repetition of the anytime search.
+ */
+struct path_step
+{
+	size_t cell;
+	unsigned char parent;
+};
+
+/**
+ * The state of the anytime search that is kept across the repetitions.
+ */
+struct anytime_state
+{
+	unsigned char *flags;           // ANYTIME_* flags of every cell
+	struct heap_elem *inconsistent; // pixels expanded before their distance was lowered
+	size_t inconsistent_count, inconsistent_capacity;
+	struct path_step *path;         // the last path found
+	size_t path_length, path_capacity;
+	unsigned path_cost;
+};
+
+/**
+ * Remember that the distance of the given pixel was lowered after it
+ * was expanded.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int add_inconsistent(struct anytime_state *const state, const struct heap_elem *const elem)
+{
+	if (state->inconsistent_count == state->inconsistent_capacity)
+	{
+		const size_t new_capacity = (state->inconsistent_capacity == 0) ? 1024 : 2*state->inconsistent_capacity;
+		struct heap_elem *const temp = realloc(state->inconsistent, new_capacity*sizeof(struct heap_elem));
+
+		if (temp == NULL)
+		{
+			return 1;
+		}
+
+		state->inconsistent = temp;
+		state->inconsistent_capacity = new_capacity;
+	}
+
+	state->inconsistent[state->inconsistent_count++] = *elem;
+	return 0;
+}
+
+/**
+ * Save the path (from the goal pixel) left in the grid. The next
+ * repetition might change the predecessors of the pixels in it.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int save_path(struct anytime_state *const state, const struct maze_grid *const grid,
+                     unsigned row, unsigned col)
+{
+	const size_t goal_cell = grid_cell(grid, row, col);
+	unsigned char parent;
+
+	state->path_length = 0;
+	state->path_cost = grid->dist[goal_cell];
+
+	do
+	{
+		if (state->path_length == state->path_capacity)
+		{
+			const size_t new_capacity = (state->path_capacity == 0) ? 1024 : 2*state->path_capacity;
+			struct path_step *const temp = realloc(state->path, new_capacity*sizeof(struct path_step));
+
+			if (temp == NULL)
+			{
+				return 1;
+			}
+
+			state->path = temp;
+			state->path_capacity = new_capacity;
+		}
+
+		const size_t cell = grid_cell(grid, row, col);
+		parent = grid->parent[cell];
+
+		state->path[state->path_length].cell = cell;
+		state->path[state->path_length].parent = parent;
+		state->path_length++;
+
+		row += grid_dir_row[parent];
+		col += grid_dir_col[parent];
+	} while (parent != GRID_DIR_NONE);
+
+	return 0;
+}
+
+/**
+ * Put the path saved using 'save_path' back into the grid.
+ */
+static void restore_path(const struct anytime_state *const state, struct maze_grid *const grid)
+{
+	for (size_t step = 0; step < state->path_length; step++)
+	{
+		grid->parent[state->path[step].cell] = state->path[step].parent;
+	}
+
+	grid->dist[state->path[0].cell] = state->path_cost;
+}
+
+/**
+ * The anytime (ARA-star) search kernel. Specialised in the same way as
+ * 'a_star_kernel'.
+ *
+ * Each repetition expands a pixel at most once. A pixel whose distance is
+ * lowered after it was expanded is remembered as inconsistent and is put
+ * back into the frontier only for the next repetition.
+ */
+static inline __attribute__((always_inline))
+int ara_star_kernel(struct a_star_search *const search,
+                    const enum maze_connectivity connectivity,
+                    const enum maze_heuristic heuristic)
+{
+	struct maze_grid *const grid = search->grid;
+
+	const unsigned neighbours = (connectivity == CONNECTIVITY_8) ? 8 : 4;
+	const unsigned straight_cost = (connectivity == CONNECTIVITY_8) ? A_STAR_STRAIGHT_COST_8 : A_STAR_STRAIGHT_COST_4;
+	const unsigned goal_row = search->goal_row,
+	               goal_col = search->goal_col;
+	const size_t goal_cell = grid_cell(grid, goal_row, goal_col),
+	             start_cell = grid_cell(grid, search->start_row, search->start_col);
+	const unsigned weight_step = A_STAR_ANYTIME_WEIGHT_STEP*WEIGHT_ONE;
+	unsigned weight = search->weight*WEIGHT_ONE + 0.5;
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	int ret_val = ERRNOPATH;
+	size_t generated = 0;
+	search->nodes_expanded = 0;
+
+	struct anytime_state state;
+	memset(&state, 0, sizeof(struct anytime_state));
+
+	struct min_heap frontier, next_frontier;
+	initialise_min_heap(&frontier);
+	initialise_min_heap(&next_frontier);
+
+	state.flags = calloc(grid->cells, sizeof(unsigned char));
+
+	if (state.flags == NULL)
+	{
+		ret_val = ERRSEARCHMEMORY;
+		goto CLEANUP;
+	}
+
+	// insert the start pixel into the frontier
+	struct heap_elem curr;
+
+	curr.row = search->start_row;
+	curr.col = search->start_col;
+	curr.heuristic = weighted(heuristic_value(heuristic, straight_cost,
+	                                          abs_diff(curr.row, goal_row), abs_diff(curr.col, goal_col)),
+	                          weight);
+	curr.key = curr.heuristic;
+
+	grid->dist[start_cell] = 0;
+	grid->parent[start_cell] = GRID_DIR_NONE;
+
+	if (min_heap_insert(&frontier, &curr))
+	{
+		ret_val = ERRSEARCHMEMORY;
+		goto CLEANUP;
+	}
+
+	while (1)
+	{
+		bool expired = false;
+
+		// improve the path until no pixel in the frontier could lead to a cheaper one
+		while (!min_heap_empty(&frontier))
+		{
+			extract_min(&frontier, &curr);
+
+			const size_t curr_cell = grid_cell(grid, curr.row, curr.col);
+			const unsigned curr_dist = grid->dist[curr_cell];
+
+			if (curr.key - curr.heuristic != curr_dist || (state.flags[curr_cell] & ANYTIME_CLOSED))
+			{
+				continue;
+			}
+
+			if (curr.key >= grid->dist[goal_cell])
+			{
+				if (min_heap_insert(&frontier, &curr))
+				{
+					ret_val = ERRSEARCHMEMORY;
+					goto CLEANUP;
+				}
+				break;
+			}
+
+			// the budget is checked only once in a while as reading the clock isn't free
+			if (ret_val == 0 && search->time_budget > 0 && (search->nodes_expanded & 4095) == 0 &&
+			    elapsed_seconds(&start) >= search->time_budget)
+			{
+				expired = true;
+				break;
+			}
+
+			state.flags[curr_cell] |= ANYTIME_CLOSED;
+			search->nodes_expanded++;
+
+			bool clear[9];
+
+#pragma GCC unroll 8
+			for (unsigned dir = 1; dir <= neighbours; dir++)
+			{
+				size_t adj_cell;
+				unsigned cost;
+
+				if (!next_pixel(grid, &curr, dir, straight_cost, clear, &adj_cell, &cost) ||
+				    curr_dist+cost >= grid->dist[adj_cell])
+				{
+					continue;
+				}
+
+				grid->dist[adj_cell] = curr_dist+cost;
+				grid->parent[adj_cell] = GRID_DIR_OPPOSITE(dir);
+
+				struct heap_elem adj_elem;
+
+				adj_elem.row = curr.row + grid_dir_row[dir];
+				adj_elem.col = curr.col + grid_dir_col[dir];
+
+				if (state.flags[adj_cell] & ANYTIME_CLOSED)
+				{
+					if (!(state.flags[adj_cell] & ANYTIME_INCONSISTENT))
+					{
+						state.flags[adj_cell] |= ANYTIME_INCONSISTENT;
+
+						if (add_inconsistent(&state, &adj_elem))
+						{
+							ret_val = ERRSEARCHMEMORY;
+							goto CLEANUP;
+						}
+					}
+					continue;
+				}
+
+				adj_elem.heuristic = weighted(heuristic_value(heuristic, straight_cost,
+				                                              abs_diff(adj_elem.row, goal_row),
+				                                              abs_diff(adj_elem.col, goal_col)),
+				                              weight);
+				adj_elem.key = curr_dist+cost + adj_elem.heuristic;
+
+				if (min_heap_insert(&frontier, &adj_elem))
+				{
+					ret_val = ERRSEARCHMEMORY;
+					goto CLEANUP;
+				}
+
+				generated++;
+			}
+		}
+
+		if (expired)
+		{
+			// the repetition was cut short; the previous path is the result
+			restore_path(&state, grid);
+			break;
+		}
+
+		if (grid->dist[goal_cell] == GRID_UNVISITED)
+		{
+			break;
+		}
+
+		// the distance of the goal pixel could be higher than the cost of
+		// the path left in the grid; the path is the one reported
+		const unsigned cost = path_cost(grid, straight_cost, goal_row, goal_col);
+		grid->dist[goal_cell] = cost;
+
+		const unsigned next_weight = (weight > WEIGHT_ONE + weight_step) ? weight - weight_step : WEIGHT_ONE;
+
+		// Move the frontier and the inconsistent pixels into the frontier of
+		// the next repetition while finding the least (unweighted) key among
+		// them. No path could cost less than it.
+		uint64_t least_key = cost;
+
+		while (!min_heap_empty(&frontier))
+		{
+			extract_min(&frontier, &curr);
+
+			const size_t curr_cell = grid_cell(grid, curr.row, curr.col);
+
+			if (curr.key - curr.heuristic != grid->dist[curr_cell] || (state.flags[curr_cell] & ANYTIME_CLOSED))
+			{
+				continue;
+			}
+
+			if (add_inconsistent(&state, &curr))
+			{
+				ret_val = ERRSEARCHMEMORY;
+				goto CLEANUP;
+			}
+		}
+
+		for (size_t pixel = 0; pixel < state.inconsistent_count; pixel++)
+		{
+			struct heap_elem *const elem = state.inconsistent + pixel;
+			const unsigned elem_dist = grid->dist[grid_cell(grid, elem->row, elem->col)];
+			const unsigned elem_heuristic = heuristic_value(heuristic, straight_cost,
+			                                                abs_diff(elem->row, goal_row),
+			                                                abs_diff(elem->col, goal_col));
+
+			if ((uint64_t)elem_dist + elem_heuristic < least_key)
+			{
+				least_key = (uint64_t)elem_dist + elem_heuristic;
+			}
+
+			elem->heuristic = weighted(elem_heuristic, next_weight);
+			elem->key = elem_dist + elem->heuristic;
+
+			if (min_heap_insert(&next_frontier, elem))
+			{
+				ret_val = ERRSEARCHMEMORY;
+				goto CLEANUP;
+			}
+		}
+
+		state.inconsistent_count = 0;
+		memset(state.flags, 0, grid->cells);
+
+		struct min_heap temp = frontier;
+		frontier = next_frontier;
+		next_frontier = temp;
+
+		// report the path
+		ret_val = 0;
+
+		search->solution.cost = cost;
+		search->solution.weight = (double)weight/WEIGHT_ONE;
+
+		// the least key is a lower bound on the least cost only if the heuristic
+		// never overestimates; otherwise nothing is known until the weight is 1
+		if (a_star_heuristic_admissible(connectivity, heuristic))
+		{
+			search->solution.bound = (least_key > 0) ? (double)cost/least_key : search->solution.weight;
+			if (search->solution.bound > search->solution.weight)
+			{
+				search->solution.bound = search->solution.weight;
+			}
+		}
+		else
+		{
+			search->solution.bound = 0;
+		}
+		search->solution.nodes_expanded = search->nodes_expanded;
+		search->solution.seconds = elapsed_seconds(&start);
+
+#ifdef KS_A_STAR_DEBUG
+		printf("ara_star_kernel: weight: %.2f cost: %u bound: %.3f expanded: %zu\n",
+		       search->solution.weight, cost, search->solution.bound, search->nodes_expanded);
+#endif
+
+		if (search->on_solution != NULL)
+		{
+			search->on_solution(&search->solution, search->solution_data);
+		}
+
+		if (weight == WEIGHT_ONE || (search->solution.bound > 0 && search->solution.bound <= 1.0) ||
+		    (search->time_budget > 0 && search->solution.seconds >= search->time_budget))
+		{
+			break;
+		}
+
+		// the path could be restored only if it has been saved
+		if (save_path(&state, grid, goal_row, goal_col))
+		{
+			break;
+		}
+
+		weight = next_weight;
+	}
+
+CLEANUP:
+	search->nodes_generated = generated;
+	search->frontier_peak = (frontier.peak_size > next_frontier.peak_size) ? frontier.peak_size
+	                                                                      : next_frontier.peak_size;
+	delete_min_heap(&next_frontier);
+	delete_min_heap(&frontier);
+	free(state.path);
+	free(state.inconsistent);
+	free(state.flags);
+	return ret_val;
+}
+
+/**
+ * Defines the kernels specialised for the given connectivity and heuristic.
+ */
+#define A_STAR_KERNELS(connectivity, heuristic) \
+	static int a_star_##connectivity##_##heuristic(struct a_star_search *const search) \
+	{ \
+		return a_star_kernel(search, connectivity, heuristic); \
+	} \
+	\
+	static int ara_star_##connectivity##_##heuristic(struct a_star_search *const search) \
+	{ \
+		return ara_star_kernel(search, connectivity, heuristic); \
+	}
+
+A_STAR_KERNELS(CONNECTIVITY_4, HEURISTIC_NONE)
+A_STAR_KERNELS(CONNECTIVITY_4, HEURISTIC_MANHATTAN)
+A_STAR_KERNELS(CONNECTIVITY_4, HEURISTIC_OCTILE)
+A_STAR_KERNELS(CONNECTIVITY_4, HEURISTIC_EUCLIDEAN)
+A_STAR_KERNELS(CONNECTIVITY_8, HEURISTIC_NONE)
+A_STAR_KERNELS(CONNECTIVITY_8, HEURISTIC_MANHATTAN)
+A_STAR_KERNELS(CONNECTIVITY_8, HEURISTIC_OCTILE)
+A_STAR_KERNELS(CONNECTIVITY_8, HEURISTIC_EUCLIDEAN)
+
+static int (*const a_star_kernels[A_STAR_CONNECTIVITIES][A_STAR_HEURISTICS])(struct a_star_search *const) =
+	KERNEL_TABLE(a_star);
+
+static int (*const ara_star_kernels[A_STAR_CONNECTIVITIES][A_STAR_HEURISTICS])(struct a_star_search *const) =
+	KERNEL_TABLE(ara_star);
+
+void initialise_a_star_search(struct a_star_search *const search)
+{
+	search->connectivity = CONNECTIVITY_4;
+	search->heuristic = HEURISTIC_MANHATTAN;
+	search->weight = 1.0;
+	search->anytime = 0;
+	search->time_budget = 0;
+	search->threads = 1;
+	search->on_solution = NULL;
+	search->solution_data = NULL;
+	search->nodes_expanded = 0;
+	search->nodes_generated = 0;
+	search->frontier_peak = 0;
+}
+
+int a_star_heuristic_admissible(const enum maze_connectivity connectivity,
+                                const enum maze_heuristic heuristic)
+{
+	// a diagonal move costs less than the two straight moves counted for it
+	return !(connectivity == CONNECTIVITY_8 && heuristic == HEURISTIC_MANHATTAN);
+}
+
+int a_star_costs_fit(const size_t clear_pixels, const unsigned width, const unsigned height,
+                     const enum maze_connectivity connectivity, const double weight)
+{
+	const unsigned straight_cost = (connectivity == CONNECTIVITY_8) ? A_STAR_STRAIGHT_COST_8 : A_STAR_STRAIGHT_COST_4,
+	               max_move_cost = (connectivity == CONNECTIVITY_8) ? A_STAR_DIAGONAL_COST_8 : A_STAR_STRAIGHT_COST_4;
+
+	if (clear_pixels >= GRID_UNVISITED/max_move_cost || !(weight >= 1.0 && weight <= A_STAR_WEIGHT_MAX))
+	{
+		return 0;
+	}
+
+	// the weight is applied in fixed point as done by the kernels
+	const uint64_t max_heuristic = (uint64_t)straight_cost*((uint64_t)width + height),
+	               max_weighted = (max_heuristic*(uint64_t)(weight*WEIGHT_ONE + 0.5)) >> WEIGHT_SHIFT;
+
+	return (uint64_t)clear_pixels*max_move_cost + max_weighted < GRID_UNVISITED;
+}
+
+int a_star_search(struct a_star_search *const search)
+{
+	if (search == NULL || search->grid == NULL ||
+	    (unsigned)search->connectivity >= A_STAR_CONNECTIVITIES ||
+	    (unsigned)search->heuristic >= A_STAR_HEURISTICS ||
+	    !(search->weight >= 1.0 && search->weight <= A_STAR_WEIGHT_MAX) ||
+	    search->threads == 0)
+	{
+		return ERRNOPATH;
+	}
+
+	// the keys would wrap around and corrupt the order of the frontier
+	if (!a_star_costs_fit(grid_clear_pixels(search->grid), search->grid->width, search->grid->height,
+	                      search->connectivity, search->weight))
+	{
+		return ERRSEARCHRANGE;
+	}
+
+#ifdef KS_A_STAR_DEBUG
+	printf("a_star_search: connectivity: %u, heuristic: %u, weight: %.2f, anytime: %d, threads: %u\n",
+	       (unsigned)search->connectivity, (unsigned)search->heuristic, search->weight,
+	       search->anytime, search->threads);
+#endif
+
+	if (search->anytime)
+	{
+		return ara_star_kernels[search->connectivity][search->heuristic](search);
+	}
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	const int ret_val = (search->threads > 1) ? hda_star_search(search)
+	                                          : a_star_kernels[search->connectivity][search->heuristic](search);
+
+	if (ret_val == 0)
+	{
+		const unsigned weight = search->weight*WEIGHT_ONE + 0.5;
+		const unsigned straight_cost = (search->connectivity == CONNECTIVITY_8) ? A_STAR_STRAIGHT_COST_8
+		                                                                         : A_STAR_STRAIGHT_COST_4;
+
+		// a pixel could be reached through the pixels whose distances are
+		// lowered later (when the heuristic is weighted or the search is
+		// parallel), so the cost is that of the path left in the grid
+		search->solution.cost = path_cost(search->grid, straight_cost, search->goal_row, search->goal_col);
+		search->grid->dist[grid_cell(search->grid, search->goal_row, search->goal_col)] = search->solution.cost;
+		search->solution.weight = (double)weight/WEIGHT_ONE;
+		search->solution.bound = a_star_heuristic_admissible(search->connectivity, search->heuristic)
+		                         ? search->solution.weight : 0;
+		search->solution.nodes_expanded = search->nodes_expanded;
+		search->solution.seconds = elapsed_seconds(&start);
+
+		if (search->on_solution != NULL)
+		{
+			search->on_solution(&search->solution, search->solution_data);
+		}
+	}
+
+	return ret_val;
+}
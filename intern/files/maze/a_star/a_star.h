@@ -0,0 +1,187 @@
+#ifndef KS_MAZE_SOLVER_A_STAR
+#define KS_MAZE_SOLVER_A_STAR
+
+#include "../grid/maze_grid.h"
+
+// #define KS_A_STAR_DEBUG
+
+/**
+ * The A-star search over the grid of a maze.
+ *
+ * The search kernel is specialised at compile time for every combination
+ * of the connectivity and the heuristic. So, the loop over the neighbours
+ * of a pixel is fully unrolled and doesn't have to check which kind of
+ * movement or heuristic is in use. 'a_star_search' dispatches the search
+ * to the right kernel at runtime.
+ *
+ * Bounded-suboptimal search:
+ *
+ * With a weight (epsilon) greater than 1 the key of a pixel becomes
+ * g + epsilon*h (weighted A-star). Fewer pixels are expanded and the cost
+ * of the path found is at most epsilon times the least cost.
+ *
+ * Anytime search (ARA-star):
+ *
+ * A path is first found quickly using the given weight. The search is then
+ * repeated with smaller weights until the weight becomes 1 (i.e., the path
+ * is a least cost path) or the time budget expires. Every repetition reuses
+ * the distances found so far and only expands the pixels whose distances
+ * have to change. Each path found is reported along with the bound on its
+ * suboptimality that has been proven so far.
+ *
+ * The bounds hold only for the heuristics that never overestimate the cost.
+ *
+ * Parallel search (HDA-star):
+ *
+ * With more than one thread the pixels are distributed among the threads
+ * by hashing and every thread searches the pixels it owns. The path found
+ * is as good as the one found by the sequential search. The anytime search
+ * is always sequential.
+ */
+
+/**
+ * The pixels a pixel could move to.
+ *
+ *   CONNECTIVITY_4 - the left, top, right and bottom pixels
+ *   CONNECTIVITY_8 - the above ones and the diagonal pixels
+ *
+ * A diagonal move is allowed only when both the straight pixels next to
+ * it are clear (i.e., a path cannot cut through the corner of a hurdle).
+ */
+enum maze_connectivity
+{
+	CONNECTIVITY_4,
+	CONNECTIVITY_8
+};
+
+/**
+ * The heuristic used to estimate the cost to reach the destination.
+ *
+ * All the heuristics except HEURISTIC_MANHATTAN with CONNECTIVITY_8 never
+ * overestimate the cost. So, the path found using them is a shortest path.
+ * With HEURISTIC_MANHATTAN and CONNECTIVITY_8 the path could be longer and
+ * no bound is known on its cost (see 'a_star_heuristic_admissible').
+ * HEURISTIC_NONE turns the search into Dijkstra's algorithm.
+ */
+enum maze_heuristic
+{
+	HEURISTIC_NONE,
+	HEURISTIC_MANHATTAN,
+	HEURISTIC_OCTILE,
+	HEURISTIC_EUCLIDEAN
+};
+
+#define A_STAR_CONNECTIVITIES 2
+#define A_STAR_HEURISTICS 4
+
+/**
+ * The cost of a move.
+ *
+ * With CONNECTIVITY_4 every move costs 1. With CONNECTIVITY_8 the costs
+ * are scaled so that the ratio of the cost of a diagonal move to that of
+ * a straight move is close to (but never less than) sqrt(2).
+ */
+#define A_STAR_STRAIGHT_COST_4 1
+#define A_STAR_STRAIGHT_COST_8 70
+#define A_STAR_DIAGONAL_COST_8 99
+
+/**
+ * The largest weight of the heuristic (the weights are kept in fixed point).
+ */
+#define A_STAR_WEIGHT_MAX 1000.0
+
+/**
+ * The amount by which the weight is lowered after each repetition of the
+ * anytime search.
+ */
+#define A_STAR_ANYTIME_WEIGHT_STEP 0.5
+
+/**
+ * Error codes
+ */
+#define ERRNOPATH 1
+#define ERRSEARCHMEMORY 2
+#define ERRSEARCHRANGE 3 // the costs could overflow the distances (see 'a_star_costs_fit')
+
+/**
+ * A path found by the search.
+ */
+struct a_star_solution
+{
+	unsigned cost;           // cost of the path
+	double weight;           // weight used to find the path
+	double bound;            // the cost is at most 'bound' times the least cost
+	                         // (0 when the heuristic overestimates the cost)
+	size_t nodes_expanded;   // pixels expanded so far
+	double seconds;          // time elapsed since the search started
+};
+
+/**
+ * The input and the results of a search.
+ *
+ * weight      - the weight (epsilon) of the heuristic; 1 for the plain A-star
+ *               search. It must be in [1, A_STAR_WEIGHT_MAX].
+ * anytime     - non-zero to keep improving the path as described above
+ * time_budget - seconds after which the anytime search stops improving the
+ *               path; 0 for no limit. The first path is always found.
+ * threads     - number of threads that search in parallel; 1 for the
+ *               sequential search
+ * on_solution - called (if not NULL) with every path found along with
+ *               'solution_data'
+ */
+struct a_star_search
+{
+	struct maze_grid *grid;
+	unsigned start_row, start_col;
+	unsigned goal_row, goal_col;
+	enum maze_connectivity connectivity;
+	enum maze_heuristic heuristic;
+	double weight;
+	int anytime;
+	double time_budget;
+	unsigned threads;
+	void (*on_solution)(const struct a_star_solution *const solution, void *const solution_data);
+	void *solution_data;
+
+	// filled in by the search
+	size_t nodes_expanded;
+	size_t nodes_generated;  // pixels put into the frontier (or sent to their owner)
+	size_t frontier_peak;    // most pixels in the frontier at once (summed across threads)
+	struct a_star_solution solution; // the path left in the grid
+};
+
+/**
+ * Initialise the given search to use CONNECTIVITY_4, HEURISTIC_MANHATTAN and
+ * the plain sequential A-star search. The grid, start and goal pixels are left untouched.
+ */
+void initialise_a_star_search(struct a_star_search *const search);
+
+/**
+ * Returns non-zero if the given heuristic never overestimates the cost of
+ * reaching the goal using the given connectivity (i.e., the path found is
+ * a shortest path when the weight is 1).
+ */
+int a_star_heuristic_admissible(const enum maze_connectivity connectivity,
+                                const enum maze_heuristic heuristic);
+
+/**
+ * Returns non-zero if the distances and the keys of a search using the given
+ * connectivity and weight fit in the distances of the grid. No path could cost
+ * more than passing through every clear pixel using the costliest move and no
+ * heuristic is more than the weighted Manhattan distance across the maze.
+ */
+int a_star_costs_fit(const size_t clear_pixels, const unsigned width, const unsigned height,
+                     const enum maze_connectivity connectivity, const double weight);
+
+/**
+ * Find a least cost path from the start pixel to the goal pixel in the grid.
+ *
+ * The distances (costs) and the predecessors of the pixels reached are
+ * stored in the grid. The path could be constructed by following the
+ * predecessors starting from the goal pixel.
+ *
+ * Returns 0 on success or a non-zero value indicating the error on failure.
+ */
+int a_star_search(struct a_star_search *const search);
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef KS_MAZE_SOLVER_A_STAR_KERNEL
+#define KS_MAZE_SOLVER_A_STAR_KERNEL
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "a_star.h"
+#include "frontier/pqueue.h"
+
+/**
+ * The helpers shared by the search kernels. Private to the A-star search;
+ * they are always inlined into the specialised kernels.
+ */
+
+/**
+ * The straight directions next to each of the diagonal directions.
+ * A diagonal move is possible only if both of them are clear.
+ */
+static const unsigned char diagonal_sides[][2] = {
+	[GRID_DIR_UP_LEFT]    = { GRID_DIR_UP,   GRID_DIR_LEFT  },
+	[GRID_DIR_UP_RIGHT]   = { GRID_DIR_UP,   GRID_DIR_RIGHT },
+	[GRID_DIR_DOWN_RIGHT] = { GRID_DIR_DOWN, GRID_DIR_RIGHT },
+	[GRID_DIR_DOWN_LEFT]  = { GRID_DIR_DOWN, GRID_DIR_LEFT  }
+};
+
+/**
+ * The heuristic value of a pixel that is 'row_diff' rows and 'col_diff'
+ * columns away from the goal pixel, in the units of 'straight_cost'.
+ */
+static inline __attribute__((always_inline))
+unsigned heuristic_value(const enum maze_heuristic heuristic, const unsigned straight_cost,
+                         const unsigned row_diff, const unsigned col_diff)
+{
+	const unsigned max_diff = (row_diff > col_diff) ? row_diff : col_diff,
+	               min_diff = (row_diff > col_diff) ? col_diff : row_diff;
+
+	switch (heuristic)
+	{
+		case HEURISTIC_MANHATTAN:
+			return straight_cost*(row_diff+col_diff);
+
+		case HEURISTIC_OCTILE:
+			// (max_diff-min_diff) straight moves and 'min_diff' diagonal moves
+			return (straight_cost*(A_STAR_STRAIGHT_COST_8*max_diff +
+			                       (A_STAR_DIAGONAL_COST_8-A_STAR_STRAIGHT_COST_8)*min_diff)) /
+			       A_STAR_STRAIGHT_COST_8;
+
+		case HEURISTIC_EUCLIDEAN:
+			return (unsigned)(straight_cost*sqrt((double)row_diff*row_diff + (double)col_diff*col_diff));
+
+		default:
+			return 0;
+	}
+}
+
+static inline __attribute__((always_inline))
+unsigned abs_diff(const unsigned a, const unsigned b)
+{
+	return (a > b) ? a-b : b-a;
+}
+
+/**
+ * The weights are used in fixed point with WEIGHT_SHIFT fractional bits.
+ */
+#define WEIGHT_SHIFT 8
+#define WEIGHT_ONE (1u << WEIGHT_SHIFT)
+
+static inline __attribute__((always_inline))
+unsigned weighted(const unsigned heuristic, const unsigned weight)
+{
+	if (weight == WEIGHT_ONE)
+	{
+		return heuristic;
+	}
+
+	return ((uint64_t)heuristic*weight) >> WEIGHT_SHIFT;
+}
+
+static inline
+double elapsed_seconds(const struct timespec *const start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec)/1e9;
+}
+
+/**
+ * Finds the pixel next to 'curr' in the direction 'dir' and the cost of
+ * moving to it. 'clear' holds whether the pixels in the directions before
+ * 'dir' could be moved to; the entry for 'dir' is filled in.
+ *
+ * Returns true if the pixel could be moved to.
+ */
+static inline __attribute__((always_inline))
+bool next_pixel(const struct maze_grid *const grid, const struct heap_elem *const curr,
+                const unsigned dir, const unsigned straight_cost, bool clear[],
+                size_t *const adj_cell, unsigned *const cost)
+{
+	*adj_cell = grid_cell(grid, curr->row + grid_dir_row[dir], curr->col + grid_dir_col[dir]);
+	*cost = straight_cost;
+
+	clear[dir] = grid_is_clear(grid, *adj_cell);
+
+	if (dir > GRID_DIR_DOWN)
+	{
+		clear[dir] &= clear[diagonal_sides[dir][0]] & clear[diagonal_sides[dir][1]];
+		*cost = A_STAR_DIAGONAL_COST_8;
+	}
+
+	return clear[dir];
+}
+
+/**
+ * Defines the table of the kernels named 'prefix'_<connectivity>_<heuristic>.
+ */
+#define KERNEL_TABLE(prefix) \
+	{ \
+		[CONNECTIVITY_4] = { \
+			[HEURISTIC_NONE]      = prefix##_CONNECTIVITY_4_HEURISTIC_NONE, \
+			[HEURISTIC_MANHATTAN] = prefix##_CONNECTIVITY_4_HEURISTIC_MANHATTAN, \
+			[HEURISTIC_OCTILE]    = prefix##_CONNECTIVITY_4_HEURISTIC_OCTILE, \
+			[HEURISTIC_EUCLIDEAN] = prefix##_CONNECTIVITY_4_HEURISTIC_EUCLIDEAN \
+		}, \
+		[CONNECTIVITY_8] = { \
+			[HEURISTIC_NONE]      = prefix##_CONNECTIVITY_8_HEURISTIC_NONE, \
+			[HEURISTIC_MANHATTAN] = prefix##_CONNECTIVITY_8_HEURISTIC_MANHATTAN, \
+			[HEURISTIC_OCTILE]    = prefix##_CONNECTIVITY_8_HEURISTIC_OCTILE, \
+			[HEURISTIC_EUCLIDEAN] = prefix##_CONNECTIVITY_8_HEURISTIC_EUCLIDEAN \
+		} \
+	}
+
+/**
+ * The parallel (hash distributed) search. Expects 'search->threads' to be
+ * greater than 1.
+ */
+int hda_star_search(struct a_star_search *const search);
+
+#endif
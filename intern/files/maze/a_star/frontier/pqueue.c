@@ -19,19 +19,27 @@ int initialise_min_heap(struct min_heap *const mheap)
 	// not required if calloc is used;
 	// but you can't be sure
 	mheap->capacity = mheap->heap_size = 0;
+	mheap->peak_size = 0;
 	mheap->elements = NULL;
 	return 0;
 }
 
+void delete_min_heap(struct min_heap *const mheap)
+{
+	free(mheap->elements);
+	mheap->elements = NULL;
+	mheap->capacity = mheap->heap_size = 0;
+}
+
 // macros to find the offsets of the parent/children nodes for a given node offset
 #define PARENT(i) ((size_t)(math_floor((double)(i)/2.0)))
 #define LEFT(i) (2*(i))
 #define RIGHT(i) ( 2 * (i) + 1)
 
 inline static
-void swap_nodes(struct heap_elem **const m, struct heap_elem **const n)
+void swap_nodes(struct heap_elem *const m, struct heap_elem *const n)
 {
-	struct heap_elem *const swap_temp = *m;
+	const struct heap_elem swap_temp = *m;
 	*m = *n;
 	*n = swap_temp;
 }
@@ -41,11 +49,11 @@ int check_swap_condition(struct min_heap *const mheap,
                          const unsigned first_offset, const unsigned second_offset)
 {
 	return (
-	        (*(mheap->elements + first_offset))->key < (*(mheap->elements + second_offset))->key ||
+	        (mheap->elements + first_offset)->key < (mheap->elements + second_offset)->key ||
 	        (
-	         /* Use the heuristic value of the node (val) to break ties */
-	         (*(mheap->elements + first_offset))->key == (*(mheap->elements + second_offset))->key &&
-	         (*(mheap->elements + first_offset))->val->heuristic < (*(mheap->elements + second_offset))->val->heuristic
+	         /* Use the heuristic value of the pixel to break ties */
+	         (mheap->elements + first_offset)->key == (mheap->elements + second_offset)->key &&
+	         (mheap->elements + first_offset)->heuristic < (mheap->elements + second_offset)->heuristic
 	        )
 	       );
 }
@@ -72,7 +80,7 @@ static int heap_decrease_key(struct min_heap *const mheap, size_t elem_offset, u
 	}
 #endif
 
-	if (new_key > (*(mheap->elements + elem_offset))->key)
+	if (new_key > (mheap->elements + elem_offset)->key)
 	{
 
 #ifdef KS_PRIORITY_QUEUE_DEBUG
@@ -84,7 +92,7 @@ static int heap_decrease_key(struct min_heap *const mheap, size_t elem_offset, u
 	}
 
 	// assign the new key
-	(*(mheap->elements + elem_offset))->key = new_key;
+	(mheap->elements + elem_offset)->key = new_key;
 
 	// ensure the heap order property is maintained
 	while (elem_offset>1 && check_swap_condition(mheap, elem_offset, PARENT(elem_offset)))
@@ -99,25 +107,26 @@ static int heap_decrease_key(struct min_heap *const mheap, size_t elem_offset, u
 	return 0;
 }
 
-int min_heap_insert(struct min_heap *const mheap, struct heap_elem *const elem)
+int min_heap_insert(struct min_heap *const mheap, const struct heap_elem *const elem)
 {
 	if (mheap == NULL || elem == NULL)
 	{
 		return ERRNULL;
 	}
 
-	static const unsigned increment = 20;
+	static const size_t increment = 20;
 
 	// allocate memory to store the element if the heap doesn't have enough
-	if (mheap->heap_size == mheap->capacity)
+	// (the elements are indexed from 1)
+	if (mheap->heap_size+1 >= mheap->capacity)
 	{
-		const unsigned new_size = mheap->capacity + increment;
+		const size_t new_size = mheap->capacity + increment;
 
 #ifdef KS_PRIORITY_QUEUE_DEBUG
 		printf("min_heap_insert: re-allocating memory to store heap elements. new_size: %zu\n", new_size);
 #endif
 
-		struct heap_elem **alloc_temp = realloc(mheap->elements, new_size*sizeof(struct heap_elem*));
+		struct heap_elem *alloc_temp = realloc(mheap->elements, new_size*sizeof(struct heap_elem));
 		if (alloc_temp == NULL)
 		{
 			return ERRMEMORY;
@@ -128,7 +137,12 @@ int min_heap_insert(struct min_heap *const mheap, struct heap_elem *const elem)
 	}
 
 	mheap->heap_size++;
-	(*(mheap->elements + mheap->heap_size)) = elem;
+	*(mheap->elements + mheap->heap_size) = *elem;
+
+	if (mheap->heap_size > mheap->peak_size)
+	{
+		mheap->peak_size = mheap->heap_size;
+	}
 
 	if (heap_decrease_key(mheap, mheap->heap_size, elem->key))
 	{
@@ -189,16 +203,16 @@ void min_heapify(struct min_heap *const mheap, size_t elem_offset)
 	} while (smallest != smallest_prev);
 }
 
-struct heap_elem *extract_min(struct min_heap *const mheap)
+int extract_min(struct min_heap *const mheap, struct heap_elem *const min)
 {
-	if (mheap == NULL)
+	if (mheap == NULL || min == NULL)
 	{
 
 #ifdef KS_PRIORITY_QUEUE_DEBUG
 		printf("extract_min: Invalid heap!\n");
 #endif
 
-		return NULL;
+		return ERRNULL;
 	}
 
 	if (mheap->heap_size < 1)
@@ -208,10 +222,10 @@ struct heap_elem *extract_min(struct min_heap *const mheap)
 		printf("extract_min: Heap underflow!\n");
 #endif
 
-		return NULL;
+		return ERRHEAP;
 	}
 
-	struct heap_elem *min = *(mheap->elements + 1);
+	*min = *(mheap->elements + 1);
 
 	// put the last element of the heap as the first element
 	*(mheap->elements + 1) = *(mheap->elements + mheap->heap_size);
@@ -221,7 +235,7 @@ struct heap_elem *extract_min(struct min_heap *const mheap)
 	// ensure the heap order property is maintained
 	min_heapify(mheap, 1);
 
-	return min;
+	return 0;
 }
 
 inline int min_heap_empty(struct min_heap *const heap)
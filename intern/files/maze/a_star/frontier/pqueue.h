@@ -1,7 +1,7 @@
 #ifndef KS_PRIORITY_QUEUE_A_STAR
 #define KS_PRIORITY_QUEUE_A_STAR
 
-#include "../../graph/maze_graph.h"
+#include <stddef.h>
 
 // #define KS_PRIORITY_QUEUE_DEBUG
 
@@ -14,8 +14,9 @@
  * End user note on memory management:
  *
  * The end user is expected to take care of allocating/de-allocating the memory
- * for the heap and the elements of the heap. No explicit memory management is
- * done internally to allocate memory for the heap or its elements.
+ * for the heap. The elements are copied into the heap by value, so the end user
+ * doesn't need to allocate memory for them. The memory that holds the elements
+ * is freed using 'delete_min_heap'.
  */
 
 
@@ -38,15 +39,18 @@
  * A heap element.
  *
  * The key is used to specifies the weight of the value,
- * The key is "not" required to be unique.
+ * The key is "not" required to be unique. Ties between equal keys are
+ * broken using the heuristic value.
  *
- * Each key corresponds to a value the weight of which the
+ * Each key corresponds to a pixel (row, col) the weight of which the
  * key represents.
  */
 struct heap_elem
 {
 	unsigned key;
-	struct node *val;
+	unsigned heuristic;
+	unsigned row;
+	unsigned col;
 };
 #pragma pack(pop)
 
@@ -77,9 +81,10 @@ struct heap_elem
  */
 struct min_heap
 {
-	unsigned heap_size;
-	unsigned capacity;
-	struct heap_elem **elements;
+	size_t heap_size;
+	size_t capacity;
+	size_t peak_size;  // most elements held at once since the heap was initialised
+	struct heap_elem *elements;
 };
 
 /**
@@ -90,19 +95,25 @@ struct min_heap
 int initialise_min_heap(struct min_heap *const mheap);
 
 /**
- * Insert a node into the given min-heap.
+ * Free the memory that holds the elements of the given min-heap. The
+ * peak size is kept.
+ */
+void delete_min_heap(struct min_heap *const mheap);
+
+/**
+ * Insert a copy of the given element into the given min-heap.
  *
  * Returns 0 on success or a non-zero value indicating the error on failure.
  */
-int min_heap_insert(struct min_heap *const mheap, struct heap_elem *const elem_to_insert);
+int min_heap_insert(struct min_heap *const mheap, const struct heap_elem *const elem_to_insert);
 
 /**
- * Returns the heap element with the minimum value (key) among all the elements
- * in the given min-heap.
+ * Removes the heap element with the minimum value (key) among all the elements
+ * in the given min-heap and copies it into 'min'.
  *
- * Returns a pointer to a valid heap element on success or returns NULL on failure.
+ * Returns 0 on success or a non-zero value on failure.
  */
-struct heap_elem *extract_min(struct min_heap *const mheap);
+int extract_min(struct min_heap *const mheap, struct heap_elem *const min);
 
 /**
  * Returns a non-zero value if the heap is empty else returns 0.
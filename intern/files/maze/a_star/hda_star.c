@@ -0,0 +1,523 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include "a_star.h"
+#include "a_star_kernel.h"
+#include "frontier/pqueue.h"
+
+#ifdef KS_A_STAR_DEBUG
+#include <stdio.h>
+#endif
+
+/**
+ * Hash distributed A-star (HDA-star).
+ *
+ * Every pixel is owned by one of the threads. The owner is found by hashing
+ * the block of HDA_BLOCK_DIMENSION x HDA_BLOCK_DIMENSION pixels the pixel
+ * lies in. Hashing blocks instead of single pixels keeps most of the
+ * neighbours of a pixel with the same owner and so fewer messages are sent.
+ *
+ * Only the owner of a pixel writes its distance and predecessor. So, each
+ * thread runs the usual search over its own frontier. A pixel generated for
+ * another thread is sent to its owner as a message. The messages for a
+ * thread are collected in batches and a full batch is pushed onto the
+ * mailbox of the owner, which is a lock-free stack of batches.
+ *
+ * Termination: 'work' counts the threads that are active plus the pixels
+ * that have been sent but not yet received. A thread adds the pixels it
+ * sends before pushing them and only becomes idle once it has sent all
+ * that it has. A thread becomes active again only by receiving pixels,
+ * which are counted in 'work'. So, once 'work' drops to 0 it never rises
+ * again and the search is over.
+ *
+ * Optimality: the cost of the best path found so far (the distance of the
+ * goal pixel) is shared. Pixels whose key is not less than it are never
+ * expanded. The search ends only when no thread has a pixel that could
+ * lead to a cheaper path. So, the path is as good as the one found by the
+ * sequential search.
+ */
+
+#define HDA_BLOCK_SHIFT 3
+#define HDA_BLOCK_DIMENSION (1u << HDA_BLOCK_SHIFT)
+
+/**
+ * Number of pixels sent in a batch.
+ */
+#define HDA_BATCH_SIZE 256
+
+/**
+ * Number of pixels expanded between the checks of the mailbox.
+ */
+#define HDA_EXPANSIONS_PER_POLL 256
+
+struct hda_message
+{
+	unsigned row, col;
+	unsigned dist;
+	unsigned char parent;
+};
+
+struct hda_batch
+{
+	struct hda_batch *next;
+	unsigned count;
+	struct hda_message messages[HDA_BATCH_SIZE];
+};
+
+struct hda_thread
+{
+	struct hda_shared *shared;
+	unsigned id;
+	pthread_t thread;
+
+	struct hda_batch *mailbox;   // pushed onto by the other threads
+	struct hda_batch **outgoing; // the batch being filled for each thread
+	struct min_heap frontier;
+	size_t nodes_expanded;
+	size_t nodes_generated;
+	int error;
+};
+
+struct hda_shared
+{
+	struct a_star_search *search;
+	struct hda_thread *threads;
+	unsigned num_threads;
+
+	unsigned best_cost; // distance of the goal pixel
+	unsigned long work; // active threads + pixels sent but not yet received
+	int done;
+};
+
+static inline
+unsigned pixel_owner(const struct hda_shared *const shared, const unsigned row, const unsigned col)
+{
+	const uint32_t hash = ((row >> HDA_BLOCK_SHIFT)*UINT32_C(0x9E3779B1)) ^
+	                      ((col >> HDA_BLOCK_SHIFT)*UINT32_C(0x85EBCA77));
+
+	return (hash ^ (hash >> 16)) % shared->num_threads;
+}
+
+/**
+ * Push the batch onto the mailbox of the given thread.
+ */
+static void post_batch(struct hda_thread *const to, struct hda_batch *const batch)
+{
+	batch->next = __atomic_load_n(&to->mailbox, __ATOMIC_RELAXED);
+
+	while (!__atomic_compare_exchange_n(&to->mailbox, &batch->next, batch, true,
+	                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+		;
+}
+
+/**
+ * Send the batch being filled for thread 'to' (if any).
+ */
+static void flush_outgoing(struct hda_thread *const self, const unsigned to)
+{
+	struct hda_batch *const batch = self->outgoing[to];
+
+	if (batch == NULL)
+	{
+		return;
+	}
+
+	self->outgoing[to] = NULL;
+
+	// counted before it is visible to the receiver
+	__atomic_add_fetch(&self->shared->work, batch->count, __ATOMIC_SEQ_CST);
+	post_batch(self->shared->threads + to, batch);
+}
+
+/**
+ * Queue a pixel to be sent to its owner.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int send_pixel(struct hda_thread *const self, const unsigned to,
+                      const struct hda_message *const message)
+{
+	struct hda_batch *batch = self->outgoing[to];
+
+	if (batch == NULL)
+	{
+		batch = malloc(sizeof(struct hda_batch));
+
+		if (batch == NULL)
+		{
+			return 1;
+		}
+
+		batch->count = 0;
+		self->outgoing[to] = batch;
+	}
+
+	batch->messages[batch->count++] = *message;
+
+	if (batch->count == HDA_BATCH_SIZE)
+	{
+		flush_outgoing(self, to);
+	}
+
+	return 0;
+}
+
+/**
+ * The pixel has been reached by a path of length 'dist'. Record it if the
+ * path is shorter than the one known (the caller is the owner of the pixel).
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static inline __attribute__((always_inline))
+int relax_pixel(struct hda_thread *const self, const struct hda_message *const message,
+                const enum maze_heuristic heuristic, const unsigned straight_cost, const unsigned weight)
+{
+	struct a_star_search *const search = self->shared->search;
+	struct maze_grid *const grid = search->grid;
+	const size_t cell = grid_cell(grid, message->row, message->col);
+
+	if (message->dist >= grid->dist[cell])
+	{
+		return 0;
+	}
+
+	// the other threads only read the distance to filter the pixels they send
+	__atomic_store_n(grid->dist + cell, message->dist, __ATOMIC_RELAXED);
+	grid->parent[cell] = message->parent;
+
+	if (message->row == search->goal_row && message->col == search->goal_col)
+	{
+		__atomic_store_n(&self->shared->best_cost, message->dist, __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	struct heap_elem elem;
+
+	elem.row = message->row;
+	elem.col = message->col;
+	elem.heuristic = weighted(heuristic_value(heuristic, straight_cost,
+	                                          abs_diff(elem.row, search->goal_row),
+	                                          abs_diff(elem.col, search->goal_col)),
+	                          weight);
+	elem.key = message->dist + elem.heuristic;
+
+	return min_heap_insert(&self->frontier, &elem);
+}
+
+/**
+ * Receive the pixels in the mailbox.
+ *
+ * Returns the number of pixels received.
+ */
+static inline __attribute__((always_inline))
+unsigned long receive_pixels(struct hda_thread *const self, const enum maze_heuristic heuristic,
+                             const unsigned straight_cost, const unsigned weight)
+{
+	struct hda_batch *batch = __atomic_exchange_n(&self->mailbox, NULL, __ATOMIC_ACQUIRE);
+	unsigned long received = 0;
+
+	while (batch != NULL)
+	{
+		struct hda_batch *const next = batch->next;
+
+		for (unsigned message = 0; message < batch->count; message++)
+		{
+			if (relax_pixel(self, batch->messages + message, heuristic, straight_cost, weight))
+			{
+				self->error = ERRSEARCHMEMORY;
+			}
+		}
+
+		received += batch->count;
+		free(batch);
+		batch = next;
+	}
+
+	return received;
+}
+
+/**
+ * The search run by each thread. Specialised in the same way as
+ * 'a_star_kernel'.
+ */
+static inline __attribute__((always_inline))
+void hda_star_kernel(struct hda_thread *const self,
+                     const enum maze_connectivity connectivity,
+                     const enum maze_heuristic heuristic)
+{
+	struct hda_shared *const shared = self->shared;
+	struct a_star_search *const search = shared->search;
+	struct maze_grid *const grid = search->grid;
+
+	const unsigned neighbours = (connectivity == CONNECTIVITY_8) ? 8 : 4;
+	const unsigned straight_cost = (connectivity == CONNECTIVITY_8) ? A_STAR_STRAIGHT_COST_8 : A_STAR_STRAIGHT_COST_4;
+	const unsigned weight = search->weight*WEIGHT_ONE + 0.5;
+
+	while (!__atomic_load_n(&shared->done, __ATOMIC_ACQUIRE))
+	{
+		const unsigned long received = receive_pixels(self, heuristic, straight_cost, weight);
+
+		if (received)
+		{
+			__atomic_sub_fetch(&shared->work, received, __ATOMIC_SEQ_CST);
+		}
+
+		unsigned expansions = 0, generated = 0;
+
+		while (expansions < HDA_EXPANSIONS_PER_POLL && !min_heap_empty(&self->frontier))
+		{
+			struct heap_elem curr;
+			extract_min(&self->frontier, &curr);
+
+			const size_t curr_cell = grid_cell(grid, curr.row, curr.col);
+			const unsigned curr_dist = grid->dist[curr_cell];
+
+			if (curr.key - curr.heuristic != curr_dist)
+			{
+				continue;
+			}
+
+			// no pixel left in the frontier could lead to a cheaper path
+			if (curr.key >= __atomic_load_n(&shared->best_cost, __ATOMIC_RELAXED))
+			{
+				delete_min_heap(&self->frontier);
+				break;
+			}
+
+			expansions++;
+
+			bool clear[9];
+
+#pragma GCC unroll 8
+			for (unsigned dir = 1; dir <= neighbours; dir++)
+			{
+				size_t adj_cell;
+				unsigned cost;
+
+				if (!next_pixel(grid, &curr, dir, straight_cost, clear, &adj_cell, &cost) ||
+				    curr_dist+cost >= __atomic_load_n(grid->dist + adj_cell, __ATOMIC_RELAXED))
+				{
+					continue;
+				}
+
+				struct hda_message message;
+
+				message.row = curr.row + grid_dir_row[dir];
+				message.col = curr.col + grid_dir_col[dir];
+				message.dist = curr_dist+cost;
+				message.parent = GRID_DIR_OPPOSITE(dir);
+
+				const unsigned owner = pixel_owner(shared, message.row, message.col);
+
+				if ((owner == self->id) ? relax_pixel(self, &message, heuristic, straight_cost, weight)
+				                        : send_pixel(self, owner, &message))
+				{
+					self->error = ERRSEARCHMEMORY;
+				}
+
+				generated++;
+			}
+		}
+
+		self->nodes_expanded += expansions;
+		self->nodes_generated += generated;
+
+		if (expansions == HDA_EXPANSIONS_PER_POLL && self->error == 0)
+		{
+			continue;
+		}
+
+		// nothing more to expand; send what is left and wait for more
+		for (unsigned to = 0; to < shared->num_threads; to++)
+		{
+			flush_outgoing(self, to);
+		}
+
+		if (self->error)
+		{
+			// a memory error ends the search for all the threads
+			__atomic_store_n(&shared->done, 1, __ATOMIC_RELEASE);
+			break;
+		}
+
+		if (!min_heap_empty(&self->frontier) ||
+		    __atomic_load_n(&self->mailbox, __ATOMIC_ACQUIRE) != NULL)
+		{
+			continue;
+		}
+
+		__atomic_sub_fetch(&shared->work, 1, __ATOMIC_SEQ_CST);
+
+		while (1)
+		{
+			if (__atomic_load_n(&self->mailbox, __ATOMIC_ACQUIRE) != NULL)
+			{
+				__atomic_add_fetch(&shared->work, 1, __ATOMIC_SEQ_CST);
+				break;
+			}
+
+			if (__atomic_load_n(&shared->work, __ATOMIC_SEQ_CST) == 0 ||
+			    __atomic_load_n(&shared->done, __ATOMIC_ACQUIRE))
+			{
+				__atomic_store_n(&shared->done, 1, __ATOMIC_RELEASE);
+				break;
+			}
+
+			sched_yield();
+		}
+	}
+}
+
+#define HDA_STAR_KERNEL(connectivity, heuristic) \
+	static void hda_star_##connectivity##_##heuristic(struct hda_thread *const self) \
+	{ \
+		hda_star_kernel(self, connectivity, heuristic); \
+	}
+
+HDA_STAR_KERNEL(CONNECTIVITY_4, HEURISTIC_NONE)
+HDA_STAR_KERNEL(CONNECTIVITY_4, HEURISTIC_MANHATTAN)
+HDA_STAR_KERNEL(CONNECTIVITY_4, HEURISTIC_OCTILE)
+HDA_STAR_KERNEL(CONNECTIVITY_4, HEURISTIC_EUCLIDEAN)
+HDA_STAR_KERNEL(CONNECTIVITY_8, HEURISTIC_NONE)
+HDA_STAR_KERNEL(CONNECTIVITY_8, HEURISTIC_MANHATTAN)
+HDA_STAR_KERNEL(CONNECTIVITY_8, HEURISTIC_OCTILE)
+HDA_STAR_KERNEL(CONNECTIVITY_8, HEURISTIC_EUCLIDEAN)
+
+static void (*const hda_star_kernels[A_STAR_CONNECTIVITIES][A_STAR_HEURISTICS])(struct hda_thread *const) =
+	KERNEL_TABLE(hda_star);
+
+static void *hda_star_thread(void *const arg)
+{
+	struct hda_thread *const self = arg;
+	const struct a_star_search *const search = self->shared->search;
+
+	hda_star_kernels[search->connectivity][search->heuristic](self);
+	return NULL;
+}
+
+int hda_star_search(struct a_star_search *const search)
+{
+	struct maze_grid *const grid = search->grid;
+	const unsigned num_threads = search->threads;
+	int ret_val = ERRSEARCHMEMORY;
+
+	struct hda_shared shared;
+
+	shared.search = search;
+	shared.num_threads = num_threads;
+	shared.best_cost = GRID_UNVISITED;
+	shared.work = num_threads;
+	shared.done = 0;
+	shared.threads = calloc(num_threads, sizeof(struct hda_thread));
+
+	if (shared.threads == NULL)
+	{
+		return ERRSEARCHMEMORY;
+	}
+
+	unsigned initialised = 0;
+
+	for (; initialised < num_threads; initialised++)
+	{
+		struct hda_thread *const thread = shared.threads + initialised;
+
+		thread->shared = &shared;
+		thread->id = initialised;
+		thread->outgoing = calloc(num_threads, sizeof(struct hda_batch *));
+		initialise_min_heap(&thread->frontier);
+
+		if (thread->outgoing == NULL)
+		{
+			goto CLEANUP;
+		}
+	}
+
+	// the owner of the start pixel starts the search
+	const unsigned start_owner = pixel_owner(&shared, search->start_row, search->start_col);
+	struct hda_message start;
+
+	start.row = search->start_row;
+	start.col = search->start_col;
+	start.dist = 0;
+	start.parent = GRID_DIR_NONE;
+
+	if (relax_pixel(shared.threads + start_owner, &start, search->heuristic,
+	                (search->connectivity == CONNECTIVITY_8) ? A_STAR_STRAIGHT_COST_8 : A_STAR_STRAIGHT_COST_4,
+	                search->weight*WEIGHT_ONE + 0.5))
+	{
+		goto CLEANUP;
+	}
+
+	unsigned started = 0;
+
+	for (; started < num_threads; started++)
+	{
+		if (pthread_create(&shared.threads[started].thread, NULL, hda_star_thread, shared.threads + started))
+		{
+			break;
+		}
+	}
+
+	if (started < num_threads)
+	{
+		// the pixels owned by the threads that are missing would never be searched
+		__atomic_store_n(&shared.done, 1, __ATOMIC_RELEASE);
+	}
+
+	search->nodes_expanded = 0;
+	search->nodes_generated = 0;
+	search->frontier_peak = 0;
+	ret_val = (started < num_threads) ? ERRSEARCHMEMORY : 0;
+
+	for (unsigned thread = 0; thread < started; thread++)
+	{
+		pthread_join(shared.threads[thread].thread, NULL);
+
+		search->nodes_expanded += shared.threads[thread].nodes_expanded;
+		search->nodes_generated += shared.threads[thread].nodes_generated;
+		search->frontier_peak += shared.threads[thread].frontier.peak_size;
+
+		if (shared.threads[thread].error)
+		{
+			ret_val = shared.threads[thread].error;
+		}
+	}
+
+	if (ret_val == 0 && grid->dist[grid_cell(grid, search->goal_row, search->goal_col)] == GRID_UNVISITED)
+	{
+		ret_val = ERRNOPATH;
+	}
+
+#ifdef KS_A_STAR_DEBUG
+	printf("hda_star_search: threads: %u, expanded: %zu, cost: %u\n",
+	       num_threads, search->nodes_expanded, shared.best_cost);
+#endif
+
+CLEANUP:
+	for (unsigned thread = 0; thread < initialised; thread++)
+	{
+		struct hda_thread *const curr = shared.threads + thread;
+		struct hda_batch *batch = curr->mailbox;
+
+		// left behind only when the search was cut short
+		while (batch != NULL)
+		{
+			struct hda_batch *const next = batch->next;
+			free(batch);
+			batch = next;
+		}
+
+		for (unsigned to = 0; to < num_threads; to++)
+		{
+			free(curr->outgoing[to]);
+		}
+
+		free(curr->outgoing);
+		delete_min_heap(&curr->frontier);
+	}
+
+	free(shared.threads);
+	return ret_val;
+}
@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "batch.h"
+#include "maze_file.h"
+
+/**
+ * A maze that has been read and is waiting to be solved.
+ */
+struct batch_job
+{
+	const char *path;
+	struct maze_file file;
+	struct batch_job *next;
+};
+
+/**
+ * The state shared by the threads of a batch. Every field below 'lock'
+ * is protected by it.
+ */
+struct batch
+{
+	char **paths;
+	size_t num_paths;
+	const struct batch_options *options;
+
+	pthread_mutex_t lock;
+	pthread_cond_t slot_free;  // signalled when a maze is no longer in flight
+	pthread_cond_t job_ready;  // signalled when a maze has been read (or the readers are done)
+
+	size_t next_path;          // index of the next path to be read
+	unsigned in_flight;        // number of mazes read but not yet written
+	unsigned active_readers;   // number of readers that haven't finished yet
+	int done;                  // set when the batch is given up; the readers stop reading
+	struct batch_job *ready_first, *ready_last;
+
+	struct batch_stats stats;
+};
+
+static double elapsed_seconds(const struct timespec *const start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec)/1e9;
+}
+
+void initialise_batch_options(struct batch_options *const options)
+{
+	const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+	options->readers = 1;
+	options->workers = (processors > 0) ? processors : 1;
+	options->in_flight = 2*options->workers;
+	options->solver = NULL;
+}
+
+static int compare_paths(const void *const first, const void *const second)
+{
+	return strcmp(*(char *const *)first, *(char *const *)second);
+}
+
+/**
+ * Appends a copy of 'path' to the list of paths.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int add_path(struct batch *const batch, size_t *const capacity, const char *const path)
+{
+	if (batch->num_paths == *capacity)
+	{
+		const size_t new_capacity = (*capacity == 0) ? 64 : 2*(*capacity);
+		char **const temp = realloc(batch->paths, new_capacity*sizeof(char *));
+
+		if (temp == NULL)
+		{
+			return 1;
+		}
+
+		batch->paths = temp;
+		*capacity = new_capacity;
+	}
+
+	batch->paths[batch->num_paths] = strdup(path);
+
+	if (batch->paths[batch->num_paths] == NULL)
+	{
+		return 1;
+	}
+
+	batch->num_paths++;
+	return 0;
+}
+
+/**
+ * Collect the paths of the mazes found in the given directory or list file.
+ *
+ * Returns 0 on success and ERRBATCHSOURCE or ERRBATCHMEMORY on failure.
+ */
+static int collect_paths(struct batch *const batch, const char *const source)
+{
+	struct stat source_stat;
+	size_t capacity = 0;
+
+	if (stat(source, &source_stat))
+	{
+		return ERRBATCHSOURCE;
+	}
+
+	if (S_ISDIR(source_stat.st_mode))
+	{
+		DIR *const dir = opendir(source);
+		struct dirent *entry;
+
+		if (dir == NULL)
+		{
+			return ERRBATCHSOURCE;
+		}
+
+		while ((entry = readdir(dir)) != NULL)
+		{
+			const size_t name_len = strlen(entry->d_name);
+
+			if (name_len <= 4 || strcasecmp(entry->d_name + name_len - 4, ".bmp") != 0)
+			{
+				continue;
+			}
+
+			char *const path = malloc(strlen(source) + name_len + 2);
+
+			if (path == NULL)
+			{
+				closedir(dir);
+				return ERRBATCHMEMORY;
+			}
+
+			sprintf(path, "%s/%s", source, entry->d_name);
+
+			const int add_failed = add_path(batch, &capacity, path);
+			free(path);
+
+			if (add_failed)
+			{
+				closedir(dir);
+				return ERRBATCHMEMORY;
+			}
+		}
+
+		closedir(dir);
+
+		// process the mazes in a predictable order
+		qsort(batch->paths, batch->num_paths, sizeof(char *), compare_paths);
+	}
+	else
+	{
+		FILE *const list = fopen(source, "r");
+		char *line = NULL;
+		size_t line_capacity = 0;
+		ssize_t line_len;
+
+		if (list == NULL)
+		{
+			return ERRBATCHSOURCE;
+		}
+
+		while ((line_len = getline(&line, &line_capacity, list)) != -1)
+		{
+			// strip the line ending
+			while (line_len > 0 && (line[line_len-1] == '\n' || line[line_len-1] == '\r'))
+			{
+				line[--line_len] = '\0';
+			}
+
+			if (line_len == 0 || line[0] == '#')
+			{
+				continue;
+			}
+
+			if (add_path(batch, &capacity, line))
+			{
+				free(line);
+				fclose(list);
+				return ERRBATCHMEMORY;
+			}
+		}
+
+		free(line);
+		fclose(list);
+	}
+
+	return 0;
+}
+
+static void report_failure(const char *const path, const int error)
+{
+	fprintf(stderr, "%s: %s\n", path, maze_error_message(error));
+}
+
+/**
+ * Reads in the mazes one after the other as long as the number of mazes
+ * in flight is below the limit.
+ */
+static void *batch_reader(void *const arg)
+{
+	struct batch *const batch = arg;
+
+	while (1)
+	{
+		pthread_mutex_lock(&batch->lock);
+
+		while (batch->in_flight >= batch->options->in_flight &&
+		       batch->next_path < batch->num_paths && !batch->done)
+		{
+			pthread_cond_wait(&batch->slot_free, &batch->lock);
+		}
+
+		if (batch->next_path == batch->num_paths || batch->done)
+		{
+			// let the workers know when there are no more mazes to be read
+			if (--batch->active_readers == 0)
+			{
+				pthread_cond_broadcast(&batch->job_ready);
+			}
+
+			pthread_mutex_unlock(&batch->lock);
+			return NULL;
+		}
+
+		const char *const path = batch->paths[batch->next_path++];
+		batch->in_flight++;
+
+		pthread_mutex_unlock(&batch->lock);
+
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+
+		struct batch_job *const job = malloc(sizeof(struct batch_job));
+		int read_status = ERRFILEMEMORY;
+
+		if (job != NULL)
+		{
+			job->path = path;
+			job->next = NULL;
+			read_status = read_maze_file(path, &job->file);
+		}
+
+		const double read_seconds = elapsed_seconds(&start);
+
+		if (read_status)
+		{
+			report_failure(path, read_status);
+			free(job);
+		}
+
+		pthread_mutex_lock(&batch->lock);
+
+		batch->stats.read_seconds += read_seconds;
+
+		if (read_status)
+		{
+			batch->stats.failed++;
+			batch->in_flight--;
+			pthread_cond_signal(&batch->slot_free);
+		}
+		else
+		{
+			batch->stats.pixels += job->file.maze.pixels;
+			batch->stats.bytes += job->file.data_size;
+
+			if (batch->ready_last == NULL)
+			{
+				batch->ready_first = job;
+			}
+			else
+			{
+				batch->ready_last->next = job;
+			}
+			batch->ready_last = job;
+
+			pthread_cond_signal(&batch->job_ready);
+		}
+
+		pthread_mutex_unlock(&batch->lock);
+	}
+}
+
+/**
+ * Solves the mazes that have been read and writes the solutions.
+ */
+static void *batch_worker(void *const arg)
+{
+	struct batch *const batch = arg;
+
+	while (1)
+	{
+		pthread_mutex_lock(&batch->lock);
+
+		while (batch->ready_first == NULL && batch->active_readers > 0)
+		{
+			pthread_cond_wait(&batch->job_ready, &batch->lock);
+		}
+
+		struct batch_job *const job = batch->ready_first;
+
+		if (job == NULL)
+		{
+			pthread_mutex_unlock(&batch->lock);
+			return NULL;
+		}
+
+		batch->ready_first = job->next;
+		if (batch->ready_first == NULL)
+		{
+			batch->ready_last = NULL;
+		}
+
+		pthread_mutex_unlock(&batch->lock);
+
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+
+		int status = solve_maze(&job->file.maze, batch->options->solver);
+
+		const double solve_seconds = elapsed_seconds(&start);
+		double write_seconds = 0;
+
+		if (status == 0)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &start);
+
+			// the other workers keep the rest of the processors busy
+			status = write_maze_file(job->path, &job->file, 1);
+			write_seconds = elapsed_seconds(&start);
+		}
+
+		if (status)
+		{
+			report_failure(job->path, status);
+		}
+
+#ifdef KS_MAZE_SOLVER_BATCH_DEBUG
+		else
+		{
+			printf("batch_worker: solved %s\n", job->path);
+		}
+#endif
+
+		free_maze_file(&job->file);
+		free(job);
+
+		pthread_mutex_lock(&batch->lock);
+
+		batch->stats.solve_seconds += solve_seconds;
+		batch->stats.write_seconds += write_seconds;
+
+		if (status)
+		{
+			batch->stats.failed++;
+		}
+		else
+		{
+			batch->stats.solved++;
+		}
+
+		batch->in_flight--;
+		pthread_cond_signal(&batch->slot_free);
+
+		pthread_mutex_unlock(&batch->lock);
+	}
+}
+
+int solve_maze_batch(const char *const source, const struct batch_options *const options,
+                     struct batch_stats *const stats)
+{
+	struct batch batch;
+	struct timespec start;
+	int ret_val = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	memset(&batch, 0, sizeof(struct batch));
+	batch.options = options;
+
+	ret_val = collect_paths(&batch, source);
+
+	if (ret_val)
+	{
+		goto FREE_PATHS;
+	}
+
+	batch.stats.mazes = batch.num_paths;
+
+	if (options->readers == 0 || options->workers == 0 || options->in_flight == 0)
+	{
+		ret_val = ERRBATCHSOURCE;
+		goto FREE_PATHS;
+	}
+
+	pthread_t *const threads = malloc((options->readers + options->workers)*sizeof(pthread_t));
+
+	if (threads == NULL)
+	{
+		ret_val = ERRBATCHMEMORY;
+		goto FREE_PATHS;
+	}
+
+	pthread_mutex_init(&batch.lock, NULL);
+	pthread_cond_init(&batch.slot_free, NULL);
+	pthread_cond_init(&batch.job_ready, NULL);
+
+	unsigned started = 0;
+
+	batch.active_readers = options->readers;
+
+	for (unsigned reader = 0; reader < options->readers; reader++, started++)
+	{
+		if (pthread_create(threads + started, NULL, batch_reader, &batch))
+		{
+			break;
+		}
+	}
+
+	// account for the readers that couldn't be started
+	pthread_mutex_lock(&batch.lock);
+	batch.active_readers -= options->readers - started;
+	pthread_mutex_unlock(&batch.lock);
+
+	if (started == 0)
+	{
+		ret_val = ERRBATCHMEMORY;
+		goto DESTROY;
+	}
+
+	const unsigned readers_started = started;
+
+	for (unsigned worker = 0; worker < options->workers; worker++, started++)
+	{
+		if (pthread_create(threads + started, NULL, batch_worker, &batch))
+		{
+			break;
+		}
+	}
+
+	if (started == readers_started)
+	{
+		// without workers the readers would wait forever for a free slot
+		pthread_mutex_lock(&batch.lock);
+		batch.done = 1;
+		pthread_cond_broadcast(&batch.slot_free);
+		pthread_mutex_unlock(&batch.lock);
+
+		ret_val = ERRBATCHMEMORY;
+	}
+
+	for (unsigned thread = 0; thread < started; thread++)
+	{
+		pthread_join(threads[thread], NULL);
+	}
+
+	// the mazes read but never solved (when the batch was given up)
+	while (batch.ready_first != NULL)
+	{
+		struct batch_job *const job = batch.ready_first;
+
+		batch.ready_first = job->next;
+		free_maze_file(&job->file);
+		free(job);
+	}
+
+	if (ret_val == 0 && batch.stats.failed)
+	{
+		ret_val = ERRBATCHFAILED;
+	}
+
+DESTROY:
+	pthread_cond_destroy(&batch.job_ready);
+	pthread_cond_destroy(&batch.slot_free);
+	pthread_mutex_destroy(&batch.lock);
+	free(threads);
+
+FREE_PATHS:
+	for (size_t path = 0; path < batch.num_paths; path++)
+	{
+		free(batch.paths[path]);
+	}
+	free(batch.paths);
+
+	batch.stats.wall_seconds = elapsed_seconds(&start);
+	*stats = batch.stats;
+
+	return ret_val;
+}
+
+void print_batch_stats(const struct batch_stats *const stats)
+{
+	const double wall_seconds = (stats->wall_seconds > 0) ? stats->wall_seconds : 1e-9;
+
+	printf("Batch statistics:\n");
+	printf("  mazes: %u (solved: %u, failed: %u)\n", stats->mazes, stats->solved, stats->failed);
+	printf("  pixels: %llu, image data read: %llu bytes\n", stats->pixels, stats->bytes);
+	printf("  time spent (summed across threads): read: %.3fs, solve: %.3fs, write: %.3fs\n",
+	       stats->read_seconds, stats->solve_seconds, stats->write_seconds);
+	printf("  wall time: %.3fs\n", stats->wall_seconds);
+	printf("  throughput: %.2f mazes/s, %.2f Mpixels/s, %.2f MiB/s\n",
+	       stats->solved/wall_seconds,
+	       stats->pixels/wall_seconds/1e6,
+	       stats->bytes/wall_seconds/(1024.0*1024.0));
+}
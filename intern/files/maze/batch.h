@@ -0,0 +1,80 @@
+#ifndef KS_MAZE_SOLVER_BATCH
+#define KS_MAZE_SOLVER_BATCH
+
+#include "maze_solver.h"
+
+/**
+ * Batch mode: solve many mazes in a single process.
+ *
+ * The mazes are processed in a pipeline. Reader threads read in the next
+ * images while a pool of solver threads solve the ones already read and
+ * write the solutions back to their files. The number of mazes that have
+ * been read but not yet written (i.e., in flight) is bounded. So, the memory
+ * used is bounded by the size of the largest mazes times that number.
+ */
+
+// #define KS_MAZE_SOLVER_BATCH_DEBUG
+
+/**
+ * Error codes
+ */
+#define ERRBATCHSOURCE 1
+#define ERRBATCHMEMORY 2
+#define ERRBATCHFAILED 4
+
+struct batch_options
+{
+	unsigned readers;   // number of reader threads
+	unsigned workers;   // number of solver threads
+	unsigned in_flight; // maximum number of mazes held in memory at a time
+	const struct maze_solver_options *solver; // options used for every maze
+};
+
+/**
+ * Aggregate results of a batch.
+ *
+ * The times spent in each stage are summed across the threads.
+ */
+struct batch_stats
+{
+	unsigned mazes;             // number of mazes found in the batch
+	unsigned solved;            // number of mazes solved successfully
+	unsigned failed;            // number of mazes that could not be read, solved or written
+	unsigned long long pixels;  // number of pixels in the mazes that were read
+	unsigned long long bytes;   // number of bytes of image data read
+	double read_seconds;
+	double solve_seconds;
+	double write_seconds;
+	double wall_seconds;        // elapsed time for the whole batch
+};
+
+/**
+ * Initialise the given options to their defaults: one reader thread,
+ * a solver thread per online processor and two mazes in flight per
+ * solver thread.
+ */
+void initialise_batch_options(struct batch_options *const options);
+
+/**
+ * Solve the mazes found in 'source' which could be,
+ *
+ *   - a directory: every file in it whose name ends with ".bmp" is solved
+ *   - a list file: every non-empty line that doesn't start with '#' is
+ *                  the path of a maze to solve
+ *
+ * The result of each maze is reported as it is written. The statistics
+ * for the whole batch are filled into 'stats'.
+ *
+ * Returns 0 when every maze was solved successfully, ERRBATCHSOURCE when
+ * the source could not be read, ERRBATCHMEMORY when the batch could not be
+ * set up or ERRBATCHFAILED when some of the mazes could not be solved.
+ */
+int solve_maze_batch(const char *const source, const struct batch_options *const options,
+                     struct batch_stats *const stats);
+
+/**
+ * Print the given statistics to 'stdout'.
+ */
+void print_batch_stats(const struct batch_stats *const stats);
+
+#endif
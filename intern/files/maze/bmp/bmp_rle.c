@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include <string.h>
+#include "bmp_rle.h"
+
+/**
+ * The escapes that follow a zero count
+ */
+#define RLE_END_OF_LINE 0
+#define RLE_END_OF_BITMAP 1
+#define RLE_DELTA 2
+
+/**
+ * Returns the entry of the palette of the pixel 'pixel' of the given run
+ * whose bytes are 'value'.
+ */
+static inline
+unsigned run_entry(const unsigned compression, const int value, const unsigned pixel)
+{
+	if (compression == BMP_RLE8)
+	{
+		return value;
+	}
+
+	// two pixels a byte; the first in the high nibble
+	return (pixel%2 == 0) ? (unsigned)value >> 4 : (unsigned)value & 0x0F;
+}
+
+/**
+ * Read the 'count' pixels of an absolute run into 'run'. The run is padded
+ * to a 16-bit boundary in the image.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int read_absolute_run(FILE *const in, const unsigned compression, const unsigned char entry_byte[BMP_PALETTE_MAX],
+                             unsigned char *const run, const unsigned count)
+{
+	const unsigned pixels_per_byte = (compression == BMP_RLE8) ? 1 : 2;
+	const unsigned bytes = (count + pixels_per_byte - 1)/pixels_per_byte;
+	int value = 0;
+
+	for (unsigned pixel = 0; pixel < count; pixel++)
+	{
+		if (pixel%pixels_per_byte == 0 && (value = getc(in)) == EOF)
+		{
+			return 1;
+		}
+
+		run[pixel] = entry_byte[run_entry(compression, value, pixel)];
+	}
+
+	return bytes%2 != 0 && getc(in) == EOF;
+}
+
+int decode_bmp_rle(FILE *const in, const unsigned compression, const unsigned char entry_byte[BMP_PALETTE_MAX],
+                   unsigned char *const pixels, const unsigned width, const unsigned height)
+{
+	unsigned row = 0, col = 0;
+
+	while (1)
+	{
+		const int count = getc(in);
+
+		// the end of the bitmap is sometimes left out
+		if (count == EOF)
+		{
+			return ferror(in);
+		}
+
+		const int value = getc(in);
+
+		if (value == EOF)
+		{
+			return 1;
+		}
+
+		if (count != 0)
+		{
+			// an encoded run: 'count' pixels of the same entry (or pair of entries)
+			if (row >= height || (unsigned)count > width - col)
+			{
+				return 1;
+			}
+
+			unsigned char *const run = pixels + (size_t)row*width + col;
+
+			if (compression == BMP_RLE8 || run_entry(compression, value, 0) == run_entry(compression, value, 1))
+			{
+				memset(run, entry_byte[run_entry(compression, value, 0)], count);
+			}
+			else
+			{
+				for (unsigned pixel = 0; pixel < (unsigned)count; pixel++)
+				{
+					run[pixel] = entry_byte[run_entry(compression, value, pixel)];
+				}
+			}
+
+			col += count;
+		}
+		else if (value == RLE_END_OF_LINE)
+		{
+			row++;
+			col = 0;
+		}
+		else if (value == RLE_END_OF_BITMAP)
+		{
+			return 0;
+		}
+		else if (value == RLE_DELTA)
+		{
+			const int right = getc(in), up = getc(in);
+
+			if (up == EOF || (unsigned)right > width - col || (unsigned)up > height - row)
+			{
+				return 1;
+			}
+
+			col += right;
+			row += up;
+		}
+		else
+		{
+			// an absolute run of 'value' pixels
+			if (row >= height || (unsigned)value > width - col ||
+			    read_absolute_run(in, compression, entry_byte, pixels + (size_t)row*width + col, value))
+			{
+				return 1;
+			}
+
+			col += value;
+		}
+	}
+}
+
+long encode_bmp_rle8(FILE *const out, const unsigned char byte_entry[256],
+                     const unsigned char *const pixels, const unsigned width, const unsigned height)
+{
+	// at most a run for every pixel and the end of the line
+	unsigned char *const line = malloc(2*(size_t)width + 2);
+	long written = 0;
+
+	if (line == NULL)
+	{
+		return -1;
+	}
+
+	for (unsigned row = 0; row < height; row++)
+	{
+		const unsigned char *const row_pixels = pixels + (size_t)row*width;
+		size_t length = 0;
+
+		// only encoded runs; the walls and corridors of a maze are long runs
+		for (unsigned col = 0; col < width; )
+		{
+			const unsigned char pixel = row_pixels[col];
+			unsigned run = 1;
+
+			while (run < 255 && col + run < width && row_pixels[col + run] == pixel)
+			{
+				run++;
+			}
+
+			line[length++] = run;
+			line[length++] = byte_entry[pixel];
+			col += run;
+		}
+
+		line[length++] = 0;
+		line[length++] = (row + 1 < height) ? RLE_END_OF_LINE : RLE_END_OF_BITMAP;
+
+		if (fwrite(line, length, 1, out) == 0)
+		{
+			written = -1;
+			break;
+		}
+
+		written += length;
+	}
+
+	free(line);
+	return written;
+}
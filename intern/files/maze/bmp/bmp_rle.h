@@ -0,0 +1,44 @@
+#ifndef KS_BMP_RLE
+#define KS_BMP_RLE
+
+#include <stdio.h>
+
+/**
+ * The pixels of run-length encoded BMP images (BI_RLE8 and BI_RLE4).
+ *
+ * The pixels of such an image are the entries of its palette. The decoder
+ * reads the runs from a stream and writes a byte for every pixel (the byte
+ * given for its entry of the palette) as it goes, so the image is never
+ * held uncompressed. The encoder writes such bytes back as BI_RLE8 runs.
+ *
+ * The rows are in the order they are found in the image (bottom-up).
+ */
+
+#define BMP_RGB 0  // the compression of an uncompressed image
+#define BMP_RLE8 1
+#define BMP_RLE4 2
+
+#define BMP_PALETTE_MAX 256
+
+/**
+ * Decode the runs of an image whose compression is BMP_RLE8 or BMP_RLE4
+ * read from 'in' into 'pixels' ('width' x 'height' bytes). A pixel that
+ * is the entry 'i' of the palette is written as 'entry_byte[i]'. The
+ * pixels skipped by the runs are left as they are.
+ *
+ * Returns 0 on success and non-zero value if the runs couldn't be read or
+ * don't fit in the image.
+ */
+int decode_bmp_rle(FILE *const in, unsigned compression, const unsigned char entry_byte[BMP_PALETTE_MAX],
+                   unsigned char *const pixels, unsigned width, unsigned height);
+
+/**
+ * Encode the 'width' x 'height' bytes in 'pixels' as BI_RLE8 runs into
+ * 'out'. The byte 'b' is written as the entry 'byte_entry[b]' of the palette.
+ *
+ * Returns the number of bytes written on success and -1 on failure.
+ */
+long encode_bmp_rle8(FILE *const out, const unsigned char byte_entry[256],
+                     const unsigned char *const pixels, unsigned width, unsigned height);
+
+#endif
@@ -0,0 +1,513 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "solution_cache.h"
+#include "../grid/maze_grid.h"
+
+#define CACHE_FILE_SUFFIX ".path"
+#define CACHE_FILE_VERSION 2
+
+/**
+ * After the cache grows beyond its limit the least recently used solutions
+ * are removed until it is this fraction of the limit. So, the directory
+ * isn't scanned for every solution stored.
+ */
+#define CACHE_EVICT_TO 0.9
+
+/**
+ * The header of a solution file. It is followed by the directions
+ * ('enum grid_direction') of the 'moves' moves, two in a byte.
+ */
+struct cache_entry_header
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint64_t first_pixel;
+	uint64_t moves;
+};
+
+static const char cache_magic[4] = { 'K', 'S', 'M', 'P' };
+
+uint64_t solution_cache_hash(uint64_t hash, const void *const data, size_t size)
+{
+	static const uint64_t prime = UINT64_C(0x9E3779B97F4A7C15);
+	const unsigned char *bytes = data;
+	uint64_t word;
+
+	while (size >= sizeof(uint64_t))
+	{
+		memcpy(&word, bytes, sizeof(uint64_t));
+		hash = (hash ^ word)*prime;
+		hash ^= hash >> 29;
+
+		bytes += sizeof(uint64_t);
+		size -= sizeof(uint64_t);
+	}
+
+	word = (uint64_t)size << 56;
+	memcpy(&word, bytes, size);
+	hash = (hash ^ word)*prime;
+	hash ^= hash >> 29;
+
+	return hash;
+}
+
+/**
+ * The path of the file holding the solution with the given key. The
+ * caller is expected to free it.
+ *
+ * Returns NULL on failure.
+ */
+static char *entry_path(const struct solution_cache *const cache, const uint64_t key, const char *const suffix)
+{
+	const size_t size = strlen(cache->dir) + 1 + 16 + strlen(suffix) + 1;
+	char *const path = malloc(size);
+
+	if (path != NULL)
+	{
+		snprintf(path, size, "%s/%016" PRIx64 "%s", cache->dir, key, suffix);
+	}
+
+	return path;
+}
+
+static int is_entry(const char *const name)
+{
+	const size_t name_len = strlen(name),
+	             suffix_len = strlen(CACHE_FILE_SUFFIX);
+
+	return name_len > suffix_len && strcmp(name + name_len - suffix_len, CACHE_FILE_SUFFIX) == 0;
+}
+
+/**
+ * Find the size of the solutions in the cache.
+ */
+static unsigned long long cache_size(const struct solution_cache *const cache)
+{
+	DIR *const dir = opendir(cache->dir);
+	struct dirent *entry;
+	unsigned long long bytes = 0;
+
+	if (dir == NULL)
+	{
+		return 0;
+	}
+
+	const int dir_fd = dirfd(dir);
+
+	while ((entry = readdir(dir)) != NULL)
+	{
+		struct stat entry_stat;
+
+		if (is_entry(entry->d_name) && fstatat(dir_fd, entry->d_name, &entry_stat, 0) == 0)
+		{
+			bytes += entry_stat.st_size;
+		}
+	}
+
+	closedir(dir);
+	return bytes;
+}
+
+int open_solution_cache(struct solution_cache *const cache, const char *const dir,
+                        unsigned long long max_bytes)
+{
+	struct stat dir_stat;
+
+	if (mkdir(dir, 0777) && (stat(dir, &dir_stat) || !S_ISDIR(dir_stat.st_mode)))
+	{
+		return ERRCACHEDIR;
+	}
+
+	cache->dir = strdup(dir);
+
+	if (cache->dir == NULL)
+	{
+		return ERRCACHEMEMORY;
+	}
+
+	cache->max_bytes = max_bytes;
+	cache->bytes = cache_size(cache);
+	memset(&cache->stats, 0, sizeof(struct solution_cache_stats));
+	pthread_mutex_init(&cache->lock, NULL);
+
+#ifdef KS_MAZE_SOLVER_CACHE_DEBUG
+	printf("open_solution_cache: %s holds %llu bytes of solutions\n", cache->dir, cache->bytes);
+#endif
+
+	return 0;
+}
+
+void close_solution_cache(struct solution_cache *const cache)
+{
+	pthread_mutex_destroy(&cache->lock);
+	free(cache->dir);
+	cache->dir = NULL;
+}
+
+static void count(struct solution_cache *const cache, unsigned long *const counter)
+{
+	pthread_mutex_lock(&cache->lock);
+	(*counter)++;
+	pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * Free the elements of the queue.
+ */
+static void empty_queue(struct sp_queue_head *const sp)
+{
+	while (!sp_queue_empty(sp))
+	{
+		free(sp_remove_elem(sp));
+	}
+}
+
+/**
+ * Insert the given pixel at the end of the queue.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int insert_pixel(struct sp_queue_head *const sp, const size_t pixel)
+{
+	struct sp_queue_elem *const elem = malloc(sizeof(struct sp_queue_elem));
+
+	if (elem == NULL)
+	{
+		return 1;
+	}
+
+	elem->elem = pixel;
+	return sp_insert_elem(sp, elem);
+}
+
+/**
+ * Read the moves of the solution in 'entry' and insert the pixels they lead
+ * to into 'sp' after checking them against the maze.
+ *
+ * Returns 0 on success, ERRCACHEMISS if the solution isn't valid for the
+ * maze and ERRCACHEMEMORY on failure.
+ */
+static int read_entry(FILE *const entry, const struct maze_image *const maze, struct sp_queue_head *const sp)
+{
+	struct cache_entry_header header;
+
+	if (fread(&header, sizeof(struct cache_entry_header), 1, entry) != 1 ||
+	    memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+	    header.version != CACHE_FILE_VERSION ||
+	    header.width != maze->width || header.height != maze->height ||
+	    header.first_pixel >= maze->pixels || header.moves >= maze->pixels)
+	{
+		return ERRCACHEMISS;
+	}
+
+	const size_t packed_size = (header.moves+1)/2;
+	unsigned char *const packed = malloc(packed_size + 1);
+
+	if (packed == NULL)
+	{
+		return ERRCACHEMEMORY;
+	}
+
+	int ret_val = ERRCACHEMISS;
+
+	if (fread(packed, 1, packed_size, entry) != packed_size || fgetc(entry) != EOF)
+	{
+		goto FREE;
+	}
+
+	unsigned row = header.first_pixel/maze->width,
+	         col = header.first_pixel%maze->width;
+
+	for (uint64_t move = 0; move <= header.moves; move++)
+	{
+		if (move > 0)
+		{
+			const unsigned dir = (packed[(move-1)/2] >> (((move-1)%2)*4)) & 0xF;
+
+			if (dir == GRID_DIR_NONE || dir > GRID_DIR_DOWN_LEFT)
+			{
+				goto FREE;
+			}
+
+			// wraps around (and so fails the check below) when moving off the maze
+			row += grid_dir_row[dir];
+			col += grid_dir_col[dir];
+		}
+
+		if (row >= maze->height || col >= maze->width ||
+		    maze->data[(size_t)row*maze->width + col] != CLEAR_PIXEL)
+		{
+			goto FREE;
+		}
+
+		if (insert_pixel(sp, (size_t)row*maze->width + col))
+		{
+			ret_val = ERRCACHEMEMORY;
+			goto FREE;
+		}
+	}
+
+	ret_val = 0;
+
+FREE:
+	free(packed);
+	return ret_val;
+}
+
+int solution_cache_lookup(struct solution_cache *const cache, uint64_t key,
+                          const struct maze_image *const maze, struct sp_queue_head *const sp)
+{
+	char *const path = entry_path(cache, key, CACHE_FILE_SUFFIX);
+
+	if (path == NULL)
+	{
+		return ERRCACHEMEMORY;
+	}
+
+	FILE *const entry = fopen(path, "rb");
+	int ret_val = ERRCACHEMISS;
+
+	if (entry != NULL)
+	{
+		ret_val = read_entry(entry, maze, sp);
+		fclose(entry);
+	}
+
+	if (ret_val == 0)
+	{
+		// mark it as recently used
+		utime(path, NULL);
+		count(cache, &cache->stats.hits);
+	}
+	else
+	{
+		empty_queue(sp);
+		count(cache, &cache->stats.misses);
+	}
+
+#ifdef KS_MAZE_SOLVER_CACHE_DEBUG
+	printf("solution_cache_lookup: %s: %s\n", path, (ret_val == 0) ? "hit" : "miss");
+#endif
+
+	free(path);
+	return ret_val;
+}
+
+struct lru_entry
+{
+	char *name;
+	time_t used;
+	off_t size;
+};
+
+static int compare_lru_entries(const void *const first, const void *const second)
+{
+	const struct lru_entry *const a = first,
+	                       *const b = second;
+
+	return (a->used > b->used) - (a->used < b->used);
+}
+
+/**
+ * Remove the least recently used solutions until the cache is
+ * CACHE_EVICT_TO of its limit. Expects the lock to be held.
+ */
+static void evict(struct solution_cache *const cache)
+{
+	DIR *const dir = opendir(cache->dir);
+	struct dirent *dir_entry;
+	struct lru_entry *entries = NULL;
+	size_t num_entries = 0, capacity = 0;
+	unsigned long long bytes = 0;
+
+	if (dir == NULL)
+	{
+		return;
+	}
+
+	const int dir_fd = dirfd(dir);
+
+	while ((dir_entry = readdir(dir)) != NULL)
+	{
+		struct stat entry_stat;
+
+		if (!is_entry(dir_entry->d_name) || fstatat(dir_fd, dir_entry->d_name, &entry_stat, 0))
+		{
+			continue;
+		}
+
+		if (num_entries == capacity)
+		{
+			const size_t new_capacity = (capacity == 0) ? 256 : 2*capacity;
+			struct lru_entry *const temp = realloc(entries, new_capacity*sizeof(struct lru_entry));
+
+			if (temp == NULL)
+			{
+				break;
+			}
+
+			entries = temp;
+			capacity = new_capacity;
+		}
+
+		entries[num_entries].name = strdup(dir_entry->d_name);
+
+		if (entries[num_entries].name == NULL)
+		{
+			break;
+		}
+
+		entries[num_entries].used = entry_stat.st_mtime;
+		entries[num_entries].size = entry_stat.st_size;
+		bytes += entry_stat.st_size;
+		num_entries++;
+	}
+
+	qsort(entries, num_entries, sizeof(struct lru_entry), compare_lru_entries);
+
+	const unsigned long long target = cache->max_bytes*CACHE_EVICT_TO;
+
+	for (size_t entry = 0; entry < num_entries; entry++)
+	{
+		if (bytes > target && unlinkat(dir_fd, entries[entry].name, 0) == 0)
+		{
+			bytes -= entries[entry].size;
+			cache->stats.evictions++;
+		}
+
+		free(entries[entry].name);
+	}
+
+	free(entries);
+	closedir(dir);
+
+	cache->bytes = bytes;
+}
+
+int solution_cache_store(struct solution_cache *const cache, uint64_t key,
+                         const struct maze_image *const maze, const struct sp_queue_head *const sp)
+{
+	struct cache_entry_header header;
+	int ret_val = ERRCACHEMEMORY;
+
+	if (sp->first == NULL)
+	{
+		return ERRCACHEWRITE;
+	}
+
+	memcpy(header.magic, cache_magic, sizeof(cache_magic));
+	header.version = CACHE_FILE_VERSION;
+	header.width = maze->width;
+	header.height = maze->height;
+	header.first_pixel = sp->first->elem;
+	header.moves = 0;
+
+	for (const struct sp_queue_elem *elem = sp->first; elem->next != NULL; elem = elem->next)
+	{
+		header.moves++;
+	}
+
+	const size_t packed_size = (header.moves+1)/2;
+	unsigned char *const packed = calloc(packed_size + 1, sizeof(unsigned char));
+	char *const path = entry_path(cache, key, CACHE_FILE_SUFFIX);
+
+	// unique per thread and process so that writers don't clobber each other
+	char temp_suffix[64];
+	snprintf(temp_suffix, sizeof(temp_suffix), ".%ld.%lx.tmp", (long)getpid(), (unsigned long)pthread_self());
+	char *const temp_path = entry_path(cache, key, temp_suffix);
+
+	if (packed == NULL || path == NULL || temp_path == NULL)
+	{
+		goto FREE;
+	}
+
+	uint64_t move = 0;
+
+	for (const struct sp_queue_elem *elem = sp->first; elem->next != NULL; elem = elem->next, move++)
+	{
+		const int row_diff = (int)(elem->next->elem/maze->width) - (int)(elem->elem/maze->width),
+		          col_diff = (int)(elem->next->elem%maze->width) - (int)(elem->elem%maze->width);
+		unsigned dir = GRID_DIR_LEFT;
+
+		while (dir <= GRID_DIR_DOWN_LEFT &&
+		       (grid_dir_row[dir] != row_diff || grid_dir_col[dir] != col_diff))
+		{
+			dir++;
+		}
+
+		if (dir > GRID_DIR_DOWN_LEFT)
+		{
+			// not a path
+			ret_val = ERRCACHEWRITE;
+			goto FREE;
+		}
+
+		packed[move/2] |= dir << ((move%2)*4);
+	}
+
+	ret_val = ERRCACHEWRITE;
+
+	FILE *const entry = fopen(temp_path, "wb");
+
+	if (entry == NULL)
+	{
+		goto FREE;
+	}
+
+	const int write_failed = fwrite(&header, sizeof(struct cache_entry_header), 1, entry) != 1 ||
+	                         fwrite(packed, 1, packed_size, entry) != packed_size;
+
+	if (fclose(entry) || write_failed || rename(temp_path, path))
+	{
+		unlink(temp_path);
+		goto FREE;
+	}
+
+	ret_val = 0;
+
+	pthread_mutex_lock(&cache->lock);
+
+	cache->stats.stores++;
+	cache->bytes += sizeof(struct cache_entry_header) + packed_size;
+
+	if (cache->bytes > cache->max_bytes)
+	{
+		evict(cache);
+	}
+
+	pthread_mutex_unlock(&cache->lock);
+
+#ifdef KS_MAZE_SOLVER_CACHE_DEBUG
+	printf("solution_cache_store: %s: %" PRIu64 " moves\n", path, header.moves);
+#endif
+
+FREE:
+	free(temp_path);
+	free(path);
+	free(packed);
+	return ret_val;
+}
+
+void print_solution_cache_stats(struct solution_cache *const cache)
+{
+	pthread_mutex_lock(&cache->lock);
+
+	const unsigned long lookups = cache->stats.hits + cache->stats.misses;
+
+	printf("Solution cache statistics (%s):\n", cache->dir);
+	printf("  lookups: %lu (hits: %lu, misses: %lu, hit rate: %.1f%%)\n",
+	       lookups, cache->stats.hits, cache->stats.misses,
+	       (lookups > 0) ? 100.0*cache->stats.hits/lookups : 0.0);
+	printf("  stored: %lu, evicted: %lu, size: %llu of %llu bytes\n",
+	       cache->stats.stores, cache->stats.evictions, cache->bytes, cache->max_bytes);
+
+	pthread_mutex_unlock(&cache->lock);
+}
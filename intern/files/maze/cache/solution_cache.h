@@ -0,0 +1,112 @@
+#ifndef KS_MAZE_SOLVER_SOLUTION_CACHE
+#define KS_MAZE_SOLVER_SOLUTION_CACHE
+
+#include <stdint.h>
+#include <pthread.h>
+#include "../maze_solver.h"
+#include "../shortest_path/queue.h"
+
+/**
+ * A content addressed cache of the solutions of mazes kept in a directory.
+ *
+ * The key of a solution is the hash of the pixels of the maze (computed
+ * while the maze is read) mixed with the options used to solve it. Each
+ * solution is stored in a file named after its key in a compact form:
+ * the first pixel of the path followed by the direction of every move
+ * packed into 4 bits.
+ *
+ * The cache is bounded in size. When it grows beyond its limit the least
+ * recently used solutions are removed (the modification time of a file is
+ * updated whenever it is used).
+ *
+ * The cache could be shared by threads and by processes. A solution is
+ * written to a temporary file that is then renamed into place, so a reader
+ * never sees a partially written solution.
+ */
+
+// #define KS_MAZE_SOLVER_CACHE_DEBUG
+
+/**
+ * Error codes
+ */
+#define ERRCACHEMISS 1
+#define ERRCACHEDIR 2
+#define ERRCACHEMEMORY 4
+#define ERRCACHEWRITE 8
+
+/**
+ * The hash of an empty maze. Every hash is started from it.
+ */
+#define SOLUTION_CACHE_HASH_SEED UINT64_C(0xCBF29CE484222325)
+
+struct solution_cache_stats
+{
+	unsigned long hits;
+	unsigned long misses;
+	unsigned long stores;
+	unsigned long evictions;
+};
+
+struct solution_cache
+{
+	char *dir;
+	unsigned long long max_bytes; // limit on the size of the solutions
+	unsigned long long bytes;     // size of the solutions in the cache (approximate)
+
+	pthread_mutex_t lock;         // protects the fields below it and 'bytes'
+	struct solution_cache_stats stats;
+};
+
+/**
+ * Open the cache kept in the directory 'dir' which is created when it
+ * doesn't exist. The size of the solutions kept is limited to 'max_bytes'.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+int open_solution_cache(struct solution_cache *const cache, const char *const dir,
+                        unsigned long long max_bytes);
+
+/**
+ * Free the resources held by the cache. The solutions stay in the directory.
+ */
+void close_solution_cache(struct solution_cache *const cache);
+
+/**
+ * Mix 'size' bytes found at 'data' into 'hash'.
+ *
+ * This is a fast non-cryptographic hash. It is only used to find the
+ * solutions of mazes seen before; a solution read from the cache is
+ * checked against the maze before it is used.
+ */
+uint64_t solution_cache_hash(uint64_t hash, const void *const data, size_t size);
+
+/**
+ * Look up the solution with the given key for the given maze. A solution
+ * is used only if it is for a maze of the same dimensions and every pixel
+ * in it is clear in the maze.
+ *
+ * On a hit the pixels of the path (as pixel indices, from the source to
+ * the destination) are inserted into 'sp'.
+ *
+ * Returns 0 on a hit, ERRCACHEMISS when there's no valid solution and
+ * ERRCACHEMEMORY on failure.
+ */
+int solution_cache_lookup(struct solution_cache *const cache, uint64_t key,
+                          const struct maze_image *const maze, struct sp_queue_head *const sp);
+
+/**
+ * Store the path found in 'sp' (which is left untouched) as the solution
+ * with the given key. The least recently used solutions are removed if
+ * the cache grows beyond its limit.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+int solution_cache_store(struct solution_cache *const cache, uint64_t key,
+                         const struct maze_image *const maze, const struct sp_queue_head *const sp);
+
+/**
+ * Print the statistics of the cache to 'stdout'.
+ */
+void print_solution_cache_stats(struct solution_cache *const cache);
+
+#endif
@@ -1,22 +1,25 @@
 #ifndef KS_MAZE_SOLVER_COMMON
 #define KS_MAZE_SOLVER_COMMON
 
-/* low volume debug info */
-#define KS_MAZE_SOLVER_DEBUG
-#define KS_MAZE_SOLVER_DEBUG_PROGRESS
+/*
+ * low volume debug info (also enabled by building with 'make DEBUG=1')
+ *
+ * The statistics of a run are available without these; see
+ * "stats/solver_stats.h".
+ */
+// #define KS_MAZE_SOLVER_DEBUG
+// #define KS_MAZE_SOLVER_DEBUG_PROGRESS
 // #define KS_MAZE_SOLVER_DEBUG_PRINT_SHORTEST_PATH
 
 /* high volume debug info */
-// #define KS_MAZE_SOLVER_DEBUG_GET_NODE
 // #define KS_MAZE_SOLVER_DEBUG_CREATE_GRAPH
-// #define KS_MAZE_SOLVER_DEBUG_INITIALIZE_ADJACENCIES
-// #define KS_MAZE_SOLVER_DEBUG_FIND_SHORTEST_PATH
-// #define KS_MAZE_SOLVER_DEBUG_MANHATTAN_DISTANCE
+
+#include <stddef.h>
 
 struct openings
 {
-	unsigned start_gate_pixel,
-		 end_gate_pixel;
+	size_t start_gate_pixel,
+	       end_gate_pixel;
 };
 
 #endif
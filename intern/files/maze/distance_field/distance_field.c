@@ -0,0 +1,367 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "distance_field.h"
+
+#define FIELD_FILE_VERSION 2
+
+// pixels the queue of the search could hold initially
+#define FIELD_QUEUE_INITIAL_CAPACITY 4096
+
+/**
+ * The header of a field file. It is followed by the reached bitmap and
+ * the directions.
+ */
+struct field_file_header
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint64_t goal_pixel;
+	uint64_t maze_hash;
+};
+
+static const char field_file_magic[4] = { 'K', 'S', 'M', 'F' };
+
+static size_t reached_words(const struct distance_field *const field)
+{
+	return ((size_t)field->width*field->height + 63)/64;
+}
+
+static size_t next_bytes(const struct distance_field *const field)
+{
+	return ((size_t)field->width*field->height + 3)/4;
+}
+
+/**
+ * Allocate the bitmap and the directions of the field.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int allocate_field(struct distance_field *const field)
+{
+	field->reached = calloc(reached_words(field), sizeof(uint64_t));
+	field->next = calloc(next_bytes(field), sizeof(unsigned char));
+
+	if (field->reached == NULL || field->next == NULL)
+	{
+		free_distance_field(field);
+		return ERRFIELDMEMORY;
+	}
+
+	return 0;
+}
+
+static inline
+int is_reached(const struct distance_field *const field, const size_t pixel)
+{
+	return (field->reached[pixel >> 6] >> (pixel & 63)) & 1;
+}
+
+static inline
+enum field_direction next_direction(const struct distance_field *const field, const size_t pixel)
+{
+	return (field->next[pixel >> 2] >> ((pixel & 3)*2)) & 3;
+}
+
+/**
+ * Mark the pixel as reached with 'dir' being the direction of the next step.
+ */
+static inline
+void set_reached(struct distance_field *const field, const size_t pixel, const enum field_direction dir)
+{
+	field->reached[pixel >> 6] |= UINT64_C(1) << (pixel & 63);
+	field->next[pixel >> 2] |= dir << ((pixel & 3)*2);
+}
+
+/**
+ * The queue of the pixels to visit. It is a ring buffer that grows when
+ * full. It holds only the pixels on the frontier of the search which are
+ * far fewer than the pixels of the maze.
+ */
+struct pixel_queue
+{
+	size_t *pixels;
+	size_t capacity;  // a power of 2
+	size_t head;
+	size_t count;
+};
+
+/**
+ * Insert the pixel at the end of the queue.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int enqueue_pixel(struct pixel_queue *const queue, const size_t pixel)
+{
+	if (queue->count == queue->capacity)
+	{
+		size_t *const pixels = realloc(queue->pixels, 2*queue->capacity*sizeof(size_t));
+
+		if (pixels == NULL)
+		{
+			return 1;
+		}
+
+		// the pixels that wrapped around move to the new half
+		for (size_t pixel_index = 0; pixel_index < queue->head; pixel_index++)
+		{
+			pixels[queue->capacity + pixel_index] = pixels[pixel_index];
+		}
+
+		queue->pixels = pixels;
+		queue->capacity *= 2;
+	}
+
+	queue->pixels[(queue->head + queue->count) & (queue->capacity - 1)] = pixel;
+	queue->count++;
+	return 0;
+}
+
+/**
+ * Remove the pixel at the start of the (non-empty) queue.
+ */
+static size_t dequeue_pixel(struct pixel_queue *const queue)
+{
+	const size_t pixel = queue->pixels[queue->head];
+
+	queue->head = (queue->head + 1) & (queue->capacity - 1);
+	queue->count--;
+	return pixel;
+}
+
+int build_distance_field(const struct maze_image *const maze, size_t goal_pixel,
+                         struct distance_field *const field)
+{
+	field->width = maze->width;
+	field->height = maze->height;
+	field->goal_pixel = goal_pixel;
+	field->maze_hash = maze->hash;
+
+	if (goal_pixel >= maze->pixels || maze->data[goal_pixel] != CLEAR_PIXEL)
+	{
+		field->reached = NULL;
+		field->next = NULL;
+		return ERRFIELDUNREACHABLE;
+	}
+
+	if (allocate_field(field))
+	{
+		return ERRFIELDMEMORY;
+	}
+
+	struct pixel_queue queue = {
+		.pixels = malloc(FIELD_QUEUE_INITIAL_CAPACITY*sizeof(size_t)),
+		.capacity = FIELD_QUEUE_INITIAL_CAPACITY,
+		.head = 0,
+		.count = 0
+	};
+
+	if (queue.pixels == NULL)
+	{
+		free_distance_field(field);
+		return ERRFIELDMEMORY;
+	}
+
+	int ret_val = 0;
+
+#ifdef KS_MAZE_SOLVER_DISTANCE_FIELD_DEBUG
+	size_t reached_pixels = 1;
+#endif
+
+	// the direction stored for the goal pixel isn't used
+	set_reached(field, goal_pixel, FIELD_LEFT);
+	enqueue_pixel(&queue, goal_pixel);
+
+	while (queue.count > 0)
+	{
+		const size_t pixel = dequeue_pixel(&queue);
+		const unsigned row = pixel/maze->width,
+		               col = pixel%maze->width;
+
+		// the neighbour and the direction in which it has to move to reach 'pixel'
+		const struct
+		{
+			int valid;
+			size_t pixel;
+			enum field_direction dir;
+		} neighbours[] = {
+			{ col > 0,               pixel-1,           FIELD_RIGHT },
+			{ row > 0,               pixel-maze->width, FIELD_DOWN  },
+			{ col+1 < maze->width,   pixel+1,           FIELD_LEFT  },
+			{ row+1 < maze->height,  pixel+maze->width, FIELD_UP    }
+		};
+
+		for (unsigned neighbour = 0; neighbour < 4; neighbour++)
+		{
+			const size_t adj_pixel = neighbours[neighbour].pixel;
+
+			if (neighbours[neighbour].valid && maze->data[adj_pixel] == CLEAR_PIXEL &&
+			    !is_reached(field, adj_pixel))
+			{
+				set_reached(field, adj_pixel, neighbours[neighbour].dir);
+
+				if (enqueue_pixel(&queue, adj_pixel))
+				{
+					free_distance_field(field);
+					ret_val = ERRFIELDMEMORY;
+					goto FREE_QUEUE;
+				}
+
+#ifdef KS_MAZE_SOLVER_DISTANCE_FIELD_DEBUG
+				reached_pixels++;
+#endif
+			}
+		}
+	}
+
+#ifdef KS_MAZE_SOLVER_DISTANCE_FIELD_DEBUG
+	printf("build_distance_field: %zu pixels could reach the goal pixel %zu\n", reached_pixels, goal_pixel);
+#endif
+
+FREE_QUEUE:
+	free(queue.pixels);
+	return ret_val;
+}
+
+int distance_field_path(const struct distance_field *const field, size_t start_pixel,
+                        struct sp_queue_head *const sp, size_t *const length)
+{
+	const size_t pixels = (size_t)field->width*field->height;
+	const ptrdiff_t step[] = {
+		[FIELD_LEFT]  = -1,
+		[FIELD_UP]    = -(ptrdiff_t)field->width,
+		[FIELD_RIGHT] = 1,
+		[FIELD_DOWN]  = field->width
+	};
+
+	if (start_pixel >= pixels || !is_reached(field, start_pixel))
+	{
+		return ERRFIELDUNREACHABLE;
+	}
+
+	size_t pixel = start_pixel;
+	*length = 0;
+
+	while (1)
+	{
+		struct sp_queue_elem *const path_elem = malloc(sizeof(struct sp_queue_elem));
+
+		if (path_elem == NULL)
+		{
+			return ERRFIELDMEMORY;
+		}
+
+		path_elem->elem = pixel;
+		sp_insert_elem(sp, path_elem);
+
+		if (pixel == field->goal_pixel)
+		{
+			return 0;
+		}
+
+		pixel += step[next_direction(field, pixel)];
+		(*length)++;
+
+		// only a corrupt field could lead to a pixel that wasn't reached (or around in circles)
+		if (pixel >= pixels || !is_reached(field, pixel) || *length >= pixels)
+		{
+			return ERRFIELDFORMAT;
+		}
+	}
+}
+
+int write_distance_field(const char *const path, const struct distance_field *const field)
+{
+	struct field_file_header header;
+
+	memset(&header, 0, sizeof(struct field_file_header));
+	memcpy(header.magic, field_file_magic, sizeof(field_file_magic));
+	header.version = FIELD_FILE_VERSION;
+	header.width = field->width;
+	header.height = field->height;
+	header.goal_pixel = field->goal_pixel;
+	header.maze_hash = field->maze_hash;
+
+	FILE *const field_file = fopen(path, "wb");
+
+	if (field_file == NULL)
+	{
+		return ERRFIELDOPEN;
+	}
+
+	int ret_val = 0;
+
+	if (fwrite(&header, sizeof(struct field_file_header), 1, field_file) != 1 ||
+	    fwrite(field->reached, sizeof(uint64_t), reached_words(field), field_file) != reached_words(field) ||
+	    fwrite(field->next, 1, next_bytes(field), field_file) != next_bytes(field))
+	{
+		ret_val = ERRFIELDWRITE;
+	}
+
+	if (fclose(field_file))
+	{
+		ret_val = ERRFIELDWRITE;
+	}
+
+	return ret_val;
+}
+
+int read_distance_field(const char *const path, struct distance_field *const field)
+{
+	struct field_file_header header;
+
+	field->reached = NULL;
+	field->next = NULL;
+
+	FILE *const field_file = fopen(path, "rb");
+
+	if (field_file == NULL)
+	{
+		return ERRFIELDOPEN;
+	}
+
+	int ret_val = ERRFIELDFORMAT;
+
+	if (fread(&header, sizeof(struct field_file_header), 1, field_file) != 1 ||
+	    memcmp(header.magic, field_file_magic, sizeof(field_file_magic)) != 0 ||
+	    header.version != FIELD_FILE_VERSION ||
+	    header.width == 0 || header.height == 0 ||
+	    header.goal_pixel >= (uint64_t)header.width*header.height)
+	{
+		goto CLOSE;
+	}
+
+	field->width = header.width;
+	field->height = header.height;
+	field->goal_pixel = header.goal_pixel;
+	field->maze_hash = header.maze_hash;
+
+	if (allocate_field(field))
+	{
+		ret_val = ERRFIELDMEMORY;
+		goto CLOSE;
+	}
+
+	if (fread(field->reached, sizeof(uint64_t), reached_words(field), field_file) != reached_words(field) ||
+	    fread(field->next, 1, next_bytes(field), field_file) != next_bytes(field))
+	{
+		free_distance_field(field);
+		goto CLOSE;
+	}
+
+	ret_val = 0;
+
+CLOSE:
+	fclose(field_file);
+	return ret_val;
+}
+
+void free_distance_field(struct distance_field *const field)
+{
+	free(field->reached);
+	free(field->next);
+	field->reached = NULL;
+	field->next = NULL;
+}
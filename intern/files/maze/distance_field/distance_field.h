@@ -0,0 +1,94 @@
+#ifndef KS_MAZE_SOLVER_DISTANCE_FIELD
+#define KS_MAZE_SOLVER_DISTANCE_FIELD
+
+#include <stdint.h>
+#include "../maze_solver.h"
+#include "../shortest_path/queue.h"
+
+/**
+ * The goal distance field of a maze.
+ *
+ * A single breadth-first search is run backwards from the goal pixel over
+ * the whole maze. For every pixel reached, the direction of the next step
+ * towards the goal along a shortest path is stored in 2 bits (the moves
+ * are the ones of CONNECTIVITY_4). A bitmap marks the pixels that were
+ * reached.
+ *
+ * A shortest path from any pixel to the goal is then found by following
+ * the directions, in time proportional to the length of the path. The
+ * field could be written to a file and read back to answer the queries
+ * for the same maze later.
+ */
+
+// #define KS_MAZE_SOLVER_DISTANCE_FIELD_DEBUG
+
+/**
+ * Error codes
+ */
+#define ERRFIELDMEMORY 1
+#define ERRFIELDUNREACHABLE 2
+#define ERRFIELDOPEN 4
+#define ERRFIELDFORMAT 8
+#define ERRFIELDWRITE 16
+
+/**
+ * The direction of the next step stored for a pixel.
+ */
+enum field_direction
+{
+	FIELD_LEFT,
+	FIELD_UP,
+	FIELD_RIGHT,
+	FIELD_DOWN
+};
+
+struct distance_field
+{
+	unsigned width;
+	unsigned height;
+	size_t goal_pixel;
+	uint64_t maze_hash;   // hash of the pixels of the maze (0 if unknown)
+	uint64_t *reached;    // bitmap of the pixels from which the goal could be reached
+	unsigned char *next;  // 'enum field_direction' of every pixel, 4 in a byte
+};
+
+/**
+ * Build the field of the given maze towards the goal pixel.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ * On failure, no memory is held by 'field'.
+ */
+int build_distance_field(const struct maze_image *const maze, size_t goal_pixel,
+                         struct distance_field *const field);
+
+/**
+ * Insert the pixels of a shortest path from 'start_pixel' to the goal pixel
+ * (both included) into 'sp'.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ * The number of pixels the goal is away from the start is stored in 'length'.
+ */
+int distance_field_path(const struct distance_field *const field, size_t start_pixel,
+                        struct sp_queue_head *const sp, size_t *const length);
+
+/**
+ * Write the field into the file at 'path'.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+int write_distance_field(const char *const path, const struct distance_field *const field);
+
+/**
+ * Read the field written using 'write_distance_field' from the file at 'path'.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ * On failure, no memory is held by 'field'.
+ */
+int read_distance_field(const char *const path, struct distance_field *const field);
+
+/**
+ * Free the memory held by the field.
+ */
+void free_distance_field(struct distance_field *const field);
+
+#endif
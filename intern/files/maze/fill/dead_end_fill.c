@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "dead_end_fill.h"
+
+// pixels in the even and odd columns of a word
+#define EVEN_COLUMNS UINT64_C(0x5555555555555555)
+#define ODD_COLUMNS  UINT64_C(0xAAAAAAAAAAAAAAAA)
+
+/**
+ * The rows above, below and of the pixels being checked. A row outside
+ * the maze is all hurdles.
+ */
+struct row_window
+{
+	const uint64_t *up;
+	uint64_t *row;
+	const uint64_t *down;
+	size_t words;
+};
+
+/**
+ * The word of the pixels to the left of the ones in word 'w' of the row.
+ */
+static inline
+uint64_t west(const uint64_t *const row, const size_t w)
+{
+	return (row[w] << 1) | ((w > 0) ? row[w-1] >> 63 : 0);
+}
+
+/**
+ * The word of the pixels to the right of the ones in word 'w' of the row.
+ */
+static inline
+uint64_t east(const uint64_t *const row, const size_t w, const size_t words)
+{
+	return (row[w] >> 1) | ((w+1 < words) ? row[w+1] << 63 : 0);
+}
+
+/**
+ * The open pixels of word 'w' that have at most one open neighbour.
+ */
+static inline
+uint64_t dead_ends(const struct row_window *const window, const size_t w,
+                   const enum maze_connectivity connectivity)
+{
+	const uint64_t left = west(window->row, w),
+	               right = east(window->row, w, window->words),
+	               up = window->up[w],
+	               down = window->down[w];
+
+	if (connectivity == CONNECTIVITY_8)
+	{
+		const uint64_t neighbours[] = {
+			left, right, up, down,
+			west(window->up, w), east(window->up, w, window->words),
+			west(window->down, w), east(window->down, w, window->words)
+		};
+
+		// the pixels with at least one and at least two open neighbours
+		uint64_t one = 0, two = 0;
+
+		for (unsigned neighbour = 0; neighbour < 8; neighbour++)
+		{
+			two |= one & neighbours[neighbour];
+			one |= neighbours[neighbour];
+		}
+
+		return window->row[w] & ~two;
+	}
+
+	return window->row[w] & ~((left & right) | (up & down) | ((left | right) & (up | down)));
+}
+
+/**
+ * The open pixels of word 'w' that have no two opposite open neighbours and
+ * whose open neighbours at right angles have an open pixel between them.
+ * These include the dead ends.
+ */
+static inline
+uint64_t room_corners(const struct row_window *const window, const size_t w)
+{
+	const uint64_t left = west(window->row, w),
+	               right = east(window->row, w, window->words),
+	               up = window->up[w],
+	               down = window->down[w];
+
+	return window->row[w] & ~(left & right) & ~(up & down) &
+	       ~(left & up & ~west(window->up, w)) &
+	       ~(left & down & ~west(window->down, w)) &
+	       ~(right & up & ~east(window->up, w, window->words)) &
+	       ~(right & down & ~east(window->down, w, window->words));
+}
+
+/**
+ * The gates that lie in word 'w' of row 'row'.
+ */
+static inline
+uint64_t gate_bits(const struct open_pixels *const open, const struct openings *const gates,
+                   const unsigned row, const size_t w)
+{
+	const size_t gate_pixels[] = { gates->start_gate_pixel, gates->end_gate_pixel };
+	uint64_t bits = 0;
+
+	for (unsigned gate = 0; gate < 2; gate++)
+	{
+		const unsigned gate_row = gate_pixels[gate]/open->width,
+		               gate_col = gate_pixels[gate]%open->width;
+
+		if (gate_row == row && gate_col/64 == w)
+		{
+			bits |= UINT64_C(1) << (gate_col%64);
+		}
+	}
+
+	return bits;
+}
+
+/**
+ * Fill the pixels of the row (of the given columns) that could be filled.
+ *
+ * Returns non-zero value if any pixel was filled.
+ */
+static int fill_row(const struct open_pixels *const open, const struct openings *const gates,
+                    const unsigned row, const struct row_window *const window,
+                    const enum maze_connectivity connectivity, const enum maze_fill fill,
+                    const uint64_t columns, struct fill_stats *const stats)
+{
+	int filled = 0;
+
+	for (size_t w = 0; w < window->words; w++)
+	{
+		if (window->row[w] == 0)
+		{
+			continue;
+		}
+
+		uint64_t fillable = (fill == FILL_ROOMS) ? room_corners(window, w) & columns
+		                                         : dead_ends(window, w, connectivity);
+
+		fillable &= ~gate_bits(open, gates, row, w);
+
+		if (fillable)
+		{
+			if (fill == FILL_ROOMS)
+			{
+				stats->room_pixels += __builtin_popcountll(fillable & ~dead_ends(window, w, connectivity));
+			}
+
+			stats->filled_pixels += __builtin_popcountll(fillable);
+			window->row[w] &= ~fillable;
+			filled = 1;
+		}
+	}
+
+	return filled;
+}
+
+int fill_dead_ends(const struct maze_image *const maze, const struct openings *const gates,
+                   enum maze_connectivity connectivity, enum maze_fill fill,
+                   struct open_pixels *const open, struct fill_stats *const stats)
+{
+	open->width = maze->width;
+	open->height = maze->height;
+	open->row_words = (maze->width + 63)/64;
+	open->bits = calloc(open->row_words*maze->height, sizeof(uint64_t));
+
+	// the rows that have to be looked at (again) and a row of hurdles
+	unsigned char *const pending = malloc(maze->height);
+	uint64_t *const hurdles = calloc(open->row_words, sizeof(uint64_t));
+
+	if (open->bits == NULL || pending == NULL || hurdles == NULL)
+	{
+		free(pending);
+		free(hurdles);
+		free_open_pixels(open);
+		return ERRFILLMEMORY;
+	}
+
+	// rooms are shrunk only when moving straight
+	if (connectivity != CONNECTIVITY_4)
+	{
+		fill = FILL_DEAD_ENDS;
+	}
+
+	stats->clear_pixels = 0;
+	stats->filled_pixels = 0;
+	stats->room_pixels = 0;
+	stats->passes = 0;
+
+	for (unsigned row = 0; row < maze->height; row++)
+	{
+		uint64_t *const row_bits = open->bits + row*open->row_words;
+
+		for (unsigned col = 0; col < maze->width; col++)
+		{
+			if (maze->data[(size_t)row*maze->width + col] == CLEAR_PIXEL)
+			{
+				row_bits[col/64] |= UINT64_C(1) << (col%64);
+				stats->clear_pixels++;
+			}
+		}
+
+		pending[row] = 1;
+	}
+
+	unsigned pending_rows = maze->height;
+
+	// sweep down and up alternately so that a branch is filled in a few passes
+	// whichever way it runs
+	while (pending_rows > 0)
+	{
+		const int downwards = (stats->passes % 2 == 0);
+
+		for (unsigned step = 0; step < maze->height; step++)
+		{
+			const unsigned row = downwards ? step : maze->height - 1 - step;
+
+			if (!pending[row])
+			{
+				continue;
+			}
+
+			pending[row] = 0;
+			pending_rows--;
+
+			const struct row_window window = {
+				.up = (row > 0) ? open->bits + (row-1)*open->row_words : hurdles,
+				.row = open->bits + row*open->row_words,
+				.down = (row+1 < maze->height) ? open->bits + (row+1)*open->row_words : hurdles,
+				.words = open->row_words
+			};
+
+			int changed = 0, filled;
+
+			// the row is filled as far as it could be before moving on
+			do
+			{
+				if (fill == FILL_ROOMS)
+				{
+					filled = fill_row(open, gates, row, &window, connectivity, fill, EVEN_COLUMNS, stats);
+					filled |= fill_row(open, gates, row, &window, connectivity, fill, ODD_COLUMNS, stats);
+				}
+				else
+				{
+					filled = fill_row(open, gates, row, &window, connectivity, fill, ~UINT64_C(0), stats);
+				}
+
+				changed |= filled;
+			} while (filled);
+
+			if (changed)
+			{
+				const unsigned neighbour_rows[] = { row-1, row+1 };
+
+				for (unsigned neighbour = 0; neighbour < 2; neighbour++)
+				{
+					// row-1 wraps around for the first row
+					if (neighbour_rows[neighbour] < maze->height && !pending[neighbour_rows[neighbour]])
+					{
+						pending[neighbour_rows[neighbour]] = 1;
+						pending_rows++;
+					}
+				}
+			}
+		}
+
+		stats->passes++;
+	}
+
+#ifdef KS_MAZE_SOLVER_DEAD_END_FILL_DEBUG
+	printf("fill_dead_ends: %zu of %zu clear pixels filled (%zu in rooms) in %u passes\n",
+	       stats->filled_pixels, stats->clear_pixels, stats->room_pixels, stats->passes);
+#endif
+
+	free(pending);
+	free(hurdles);
+	return 0;
+}
+
+void free_open_pixels(struct open_pixels *const open)
+{
+	free(open->bits);
+	open->bits = NULL;
+}
@@ -0,0 +1,84 @@
+#ifndef KS_MAZE_SOLVER_DEAD_END_FILL
+#define KS_MAZE_SOLVER_DEAD_END_FILL
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../maze_solver.h"
+#include "../common.h"
+
+/**
+ * Dead-end filling of a maze before its graph is created.
+ *
+ * A clear pixel (other than a gate) that has at most one clear neighbour
+ * could never be on a path between the gates. It is filled and the
+ * neighbour is looked at again. Filling it repeatedly removes every dead-end
+ * branch of the maze while keeping all the paths between the gates (and
+ * so the length of the shortest one).
+ *
+ * With FILL_ROOMS, the open areas ("rooms") are shrunk as well (only for
+ * CONNECTIVITY_4). A clear pixel that has exactly two clear neighbours at
+ * right angles to each other is filled when the pixel diagonal to it between
+ * the two is clear; every path through the pixel could go through the
+ * diagonal pixel with the same number of steps. The pixels on the same row
+ * that are filled together are two columns apart, so filling one of them
+ * never invalidates the reason for filling another.
+ *
+ * The clear pixels are kept in a bitmap of 64-bit words. The pixels of a
+ * whole word are checked at once using bitwise operations on the words
+ * above, below and around it. Only the rows next to the ones that changed
+ * are looked at again.
+ */
+
+// #define KS_MAZE_SOLVER_DEAD_END_FILL_DEBUG
+
+/**
+ * Error codes
+ */
+#define ERRFILLMEMORY 1
+
+/**
+ * The clear pixels of the maze that remain after filling.
+ */
+struct open_pixels
+{
+	unsigned width;
+	unsigned height;
+	size_t row_words;  // words in a row of the bitmap
+	uint64_t *bits;    // bit (col % 64) of word (col / 64) of a row is set for an open pixel
+};
+
+struct fill_stats
+{
+	size_t clear_pixels;     // clear pixels before filling
+	size_t filled_pixels;    // clear pixels that have been filled
+	size_t room_pixels;      // filled pixels that were not at a dead end (FILL_ROOMS)
+	unsigned passes;         // sweeps over the rows of the maze
+};
+
+/**
+ * Fill the dead ends (and the rooms when 'fill' is FILL_ROOMS) of the maze
+ * for the given connectivity. The gates are never filled. The pixels that
+ * remain are stored in 'open'. The maze itself isn't changed.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ * On failure, no memory is held by 'open'.
+ */
+int fill_dead_ends(const struct maze_image *const maze, const struct openings *const gates,
+                   enum maze_connectivity connectivity, enum maze_fill fill,
+                   struct open_pixels *const open, struct fill_stats *const stats);
+
+/**
+ * Returns non-zero value if the pixel at (row, col) is open.
+ */
+static inline
+int is_open_pixel(const struct open_pixels *const open, unsigned row, unsigned col)
+{
+	return (open->bits[(size_t)row*open->row_words + col/64] >> (col%64)) & 1;
+}
+
+/**
+ * Free the memory held by 'open'.
+ */
+void free_open_pixels(struct open_pixels *const open);
+
+#endif
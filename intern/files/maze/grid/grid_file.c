@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "grid_file.h"
+
+/**
+ * The header of a grid file. Every field has a fixed width and the
+ * header is a multiple of 8 bytes in size (no padding).
+ */
+struct grid_file_header
+{
+	char magic[4];
+	uint32_t byte_order;  // GRID_FILE_BYTE_ORDER as written by the compiler
+	uint32_t version;
+	uint32_t layout;      // KS_MAZE_GRID_LAYOUT
+	uint32_t tile_shift;  // GRID_TILE_SHIFT
+	uint32_t width;
+	uint32_t height;
+	uint32_t reserved;
+	uint64_t start_pixel;
+	uint64_t end_pixel;
+	uint64_t maze_hash;
+	uint64_t cells;
+	uint64_t clear_offset;
+	uint64_t clear_words;
+};
+
+#define GRID_FILE_BYTE_ORDER 0x01020304u
+
+static const char grid_file_magic[4] = { 'K', 'S', 'M', 'G' };
+
+static uint64_t clear_offset(void)
+{
+	return ((sizeof(struct grid_file_header) + GRID_FILE_ALIGNMENT - 1)/GRID_FILE_ALIGNMENT)*GRID_FILE_ALIGNMENT;
+}
+
+int write_grid_file(const char *const path, const struct maze_grid *const grid,
+                    const struct grid_file_info *const info)
+{
+	struct grid_file_header header;
+
+	memset(&header, 0, sizeof(struct grid_file_header));
+	memcpy(header.magic, grid_file_magic, sizeof(grid_file_magic));
+	header.byte_order = GRID_FILE_BYTE_ORDER;
+	header.version = GRID_FILE_VERSION;
+	header.layout = KS_MAZE_GRID_LAYOUT;
+	header.tile_shift = GRID_TILE_SHIFT;
+	header.width = grid->width;
+	header.height = grid->height;
+	header.start_pixel = info->start_pixel;
+	header.end_pixel = info->end_pixel;
+	header.maze_hash = info->maze_hash;
+	header.cells = grid->cells;
+	header.clear_offset = clear_offset();
+	header.clear_words = (grid->cells + 63)/64;
+
+	FILE *const grid_file = fopen(path, "wb");
+
+	if (grid_file == NULL)
+	{
+		return ERRGRIDFILEOPEN;
+	}
+
+	int ret_val = 0;
+
+	if (fwrite(&header, sizeof(struct grid_file_header), 1, grid_file) != 1 ||
+	    fseek(grid_file, header.clear_offset, SEEK_SET) ||
+	    fwrite(grid->clear, sizeof(uint64_t), header.clear_words, grid_file) != header.clear_words)
+	{
+		ret_val = ERRGRIDFILEWRITE;
+	}
+
+	if (fclose(grid_file))
+	{
+		ret_val = ERRGRIDFILEWRITE;
+	}
+
+#ifdef KS_MAZE_SOLVER_GRID_FILE_DEBUG
+	printf("write_grid_file: %s: %u x %u pixels, %llu bitmap words\n",
+	       path, grid->width, grid->height, (unsigned long long)header.clear_words);
+#endif
+
+	return ret_val;
+}
+
+/**
+ * Returns non-zero value if the header describes a grid that could be
+ * used by this build of the solver and that fits in a file of the given size.
+ */
+static int valid_header(const struct grid_file_header *const header, const off_t file_size)
+{
+	if (memcmp(header->magic, grid_file_magic, sizeof(grid_file_magic)) != 0 ||
+	    header->byte_order != GRID_FILE_BYTE_ORDER ||
+	    header->version != GRID_FILE_VERSION ||
+	    header->layout != KS_MAZE_GRID_LAYOUT ||
+	    header->tile_shift != GRID_TILE_SHIFT)
+	{
+		return 0;
+	}
+
+	const uint64_t pixels = (uint64_t)header->width*header->height;
+
+	return header->width > 0 && header->height > 0 &&
+	       header->start_pixel < pixels && header->end_pixel < pixels &&
+	       header->cells == grid_cells(header->width, header->height) &&
+	       header->clear_words == (header->cells + 63)/64 &&
+	       header->clear_offset % GRID_FILE_ALIGNMENT == 0 &&
+	       header->clear_offset >= sizeof(struct grid_file_header) &&
+	       header->clear_offset + header->clear_words*sizeof(uint64_t) <= (uint64_t)file_size;
+}
+
+struct maze_grid *map_grid_file(const char *const path, struct grid_file_info *const info,
+                                int *const error)
+{
+	struct maze_grid *grid = NULL;
+	struct stat file_stat;
+
+	const int fd = open(path, O_RDONLY);
+
+	if (fd == -1)
+	{
+		*error = ERRGRIDFILEOPEN;
+		return NULL;
+	}
+
+	*error = ERRGRIDFILEFORMAT;
+
+	if (fstat(fd, &file_stat) || (size_t)file_stat.st_size < sizeof(struct grid_file_header))
+	{
+		goto CLOSE;
+	}
+
+	void *const mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if (mapping == MAP_FAILED)
+	{
+		*error = ERRGRIDFILEMEMORY;
+		goto CLOSE;
+	}
+
+	const struct grid_file_header *const header = mapping;
+
+	if (!valid_header(header, file_stat.st_size))
+	{
+		munmap(mapping, file_stat.st_size);
+		goto CLOSE;
+	}
+
+	grid = create_grid_with_clear(header->width, header->height,
+	                              (uint64_t *)((char *)mapping + header->clear_offset));
+
+	if (grid == NULL)
+	{
+		munmap(mapping, file_stat.st_size);
+		*error = ERRGRIDFILEMEMORY;
+		goto CLOSE;
+	}
+
+	grid->mapping = mapping;
+	grid->mapping_size = file_stat.st_size;
+
+	info->start_pixel = header->start_pixel;
+	info->end_pixel = header->end_pixel;
+	info->maze_hash = header->maze_hash;
+	*error = 0;
+
+#ifdef KS_MAZE_SOLVER_GRID_FILE_DEBUG
+	printf("map_grid_file: %s: %u x %u pixels\n", path, grid->width, grid->height);
+#endif
+
+CLOSE:
+	// the mapping stays valid after the file is closed
+	close(fd);
+	return grid;
+}
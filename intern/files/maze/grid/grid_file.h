@@ -0,0 +1,72 @@
+#ifndef KS_MAZE_SOLVER_GRID_FILE
+#define KS_MAZE_SOLVER_GRID_FILE
+
+#include "maze_grid.h"
+
+/**
+ * The compiled form of a maze: a file holding the clear bitmap of its grid
+ * (in the layout the solver was built with) along with the gates of the maze.
+ *
+ * The file is meant to be mapped into memory. The bitmap is used in place
+ * and only the distances and predecessors are allocated. So, a maze that
+ * has been compiled could be searched without reading in the image and
+ * creating the grid.
+ *
+ * The file holds only offsets (no pointers) and is versioned. The header
+ * records the layout, the tile size and the byte order. A file compiled
+ * by a solver built differently is refused instead of being misread.
+ *
+ * Layout of the file:
+ *
+ *   struct grid_file_header
+ *   padding up to 'clear_offset' (a multiple of GRID_FILE_ALIGNMENT)
+ *   the clear bitmap ('clear_words' 64-bit words)
+ */
+
+// #define KS_MAZE_SOLVER_GRID_FILE_DEBUG
+
+#define GRID_FILE_VERSION 2
+#define GRID_FILE_ALIGNMENT 4096
+
+/**
+ * Error codes
+ */
+#define ERRGRIDFILEOPEN 1
+#define ERRGRIDFILEFORMAT 2
+#define ERRGRIDFILEMEMORY 4
+#define ERRGRIDFILEWRITE 8
+
+/**
+ * The information about the maze stored along with the grid.
+ */
+struct grid_file_info
+{
+	size_t start_pixel;
+	size_t end_pixel;
+	uint64_t maze_hash; // hash of the pixels of the maze (0 if unknown)
+};
+
+/**
+ * Write the clear bitmap of the grid and the given information into the
+ * file at 'path'.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+int write_grid_file(const char *const path, const struct maze_grid *const grid,
+                    const struct grid_file_info *const info);
+
+/**
+ * Map the grid file at 'path' into memory and create a grid whose clear
+ * bitmap is the one in the file. The information stored in the file is
+ * filled into 'info'.
+ *
+ * The grid is freed using 'delete_grid' as usual. Its clear bitmap is read
+ * only.
+ *
+ * Returns a valid grid on success and NULL on failure with the error
+ * stored in 'error'.
+ */
+struct maze_grid *map_grid_file(const char *const path, struct grid_file_info *const info,
+                                int *const error);
+
+#endif
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "maze_grid.h"
+
+/**
+ * Fill in the dimensions of the grid.
+ */
+static void set_geometry(struct maze_grid *const grid, unsigned width, unsigned height)
+{
+	grid->width = width;
+	grid->height = height;
+
+	// account for the border on either side
+	const size_t rows = (size_t)height + 2,
+	             cols = (size_t)width + 2;
+
+#if KS_MAZE_GRID_LAYOUT == GRID_LAYOUT_ROW_MAJOR
+	grid->stride = cols;
+	grid->tiles_per_row = 0;
+	grid->cells = rows*cols;
+#else
+	// the per-pixel arrays hold whole tiles, so round up the dimensions
+	const size_t tile_rows = (rows + GRID_TILE_MASK) >> GRID_TILE_SHIFT;
+
+	grid->stride = 0;
+	grid->tiles_per_row = (cols + GRID_TILE_MASK) >> GRID_TILE_SHIFT;
+	grid->cells = (tile_rows*grid->tiles_per_row) << (2*GRID_TILE_SHIFT);
+#endif
+
+#ifdef KS_MAZE_SOLVER_GRID_DEBUG
+	printf("set_geometry: width: %u, height: %u, cells: %zu\n", width, height, grid->cells);
+#endif
+}
+
+size_t grid_cells(unsigned width, unsigned height)
+{
+	struct maze_grid grid;
+
+	set_geometry(&grid, width, height);
+	return grid.cells;
+}
+
+/**
+ * Map an unlinked temporary file of the given size into memory.
+ *
+ * Returns the mapping on success and MAP_FAILED on failure.
+ */
+static void *map_temporary_file(const size_t size)
+{
+	const char *directory = getenv("TMPDIR");
+	char path[4096];
+
+	if (directory == NULL || directory[0] == '\0')
+	{
+		directory = "/var/tmp";
+	}
+
+	if ((size_t)snprintf(path, sizeof(path), "%s/maze_grid.XXXXXX", directory) >= sizeof(path))
+	{
+		return MAP_FAILED;
+	}
+
+	const int fd = mkstemp(path);
+
+	if (fd == -1)
+	{
+		return MAP_FAILED;
+	}
+
+	// the file goes away along with the mapping
+	unlink(path);
+
+	void *const mapping = (ftruncate(fd, size) == 0) ?
+	                      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+	close(fd);
+	return mapping;
+}
+
+/**
+ * Allocate an array of 'size' bytes in the given storage. The array is
+ * zeroed when 'zero' is non-zero (the mappings always are).
+ *
+ * Returns the array on success and NULL on failure.
+ */
+static void *allocate_array(const size_t size, const enum grid_storage storage, const int zero)
+{
+	void *array;
+
+	switch (storage)
+	{
+		case GRID_STORAGE_HUGE_PAGES:
+			array = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+#ifdef MADV_HUGEPAGE
+			if (array != MAP_FAILED)
+			{
+				// only advice; the pages are still usable without it
+				madvise(array, size, MADV_HUGEPAGE);
+			}
+#endif
+
+			return (array != MAP_FAILED) ? array : NULL;
+
+		case GRID_STORAGE_FILE:
+			array = map_temporary_file(size);
+			return (array != MAP_FAILED) ? array : NULL;
+
+		default:
+			return zero ? calloc(size, 1) : malloc(size);
+	}
+}
+
+/**
+ * Free an array allocated using 'allocate_array'.
+ */
+static void free_array(void *const array, const size_t size, const enum grid_storage storage)
+{
+	if (array == NULL)
+	{
+		return;
+	}
+
+	if (storage == GRID_STORAGE_HEAP)
+	{
+		free(array);
+	}
+	else
+	{
+		munmap(array, size);
+	}
+}
+
+/**
+ * The storage of the clear bitmap of a grid whose other arrays are in
+ * 'storage'. The bitmap is looked up for every neighbour, so it is never
+ * kept in a file.
+ */
+static enum grid_storage clear_storage(const enum grid_storage storage)
+{
+	return (storage == GRID_STORAGE_FILE) ? GRID_STORAGE_HEAP : storage;
+}
+
+static size_t clear_bytes(const struct maze_grid *const grid)
+{
+	return ((grid->cells + 63)/64)*sizeof(uint64_t);
+}
+
+/**
+ * Allocate the grid along with its distances and predecessors in the given
+ * storage. The clear bitmap is allocated only when 'clear' is NULL.
+ */
+static struct maze_grid *allocate_grid(unsigned width, unsigned height, uint64_t *const clear,
+                                       const enum grid_storage storage)
+{
+	struct maze_grid *const grid = malloc(sizeof(struct maze_grid));
+
+	if (grid == NULL)
+	{
+		return NULL;
+	}
+
+	set_geometry(grid, width, height);
+
+	grid->storage = storage;
+	grid->mapping = NULL;
+	grid->mapping_size = 0;
+	grid->clear = (clear != NULL) ? clear : allocate_array(clear_bytes(grid), clear_storage(storage), 1);
+	grid->dist = allocate_array(grid->cells*sizeof(unsigned), storage, 0);
+	grid->parent = allocate_array(grid->cells*sizeof(unsigned char), storage, 1); // GRID_DIR_NONE
+
+	if (grid->clear == NULL || grid->dist == NULL || grid->parent == NULL)
+	{
+		if (clear != NULL)
+		{
+			// owned by the caller
+			grid->clear = NULL;
+		}
+
+		delete_grid(grid);
+		return NULL;
+	}
+
+	// GRID_UNVISITED has all its bytes set
+	memset(grid->dist, 0xFF, grid->cells*sizeof(unsigned));
+
+	return grid;
+}
+
+struct maze_grid *create_grid(unsigned width, unsigned height, enum grid_storage storage)
+{
+	return allocate_grid(width, height, NULL, storage);
+}
+
+struct maze_grid *create_grid_with_clear(unsigned width, unsigned height, uint64_t *const clear)
+{
+	return (clear != NULL) ? allocate_grid(width, height, clear, GRID_STORAGE_HEAP) : NULL;
+}
+
+size_t grid_clear_pixels(const struct maze_grid *const grid)
+{
+	size_t clear_pixels = 0;
+
+	for (size_t word = 0; word < (grid->cells + 63)/64; word++)
+	{
+		clear_pixels += __builtin_popcountll(grid->clear[word]);
+	}
+
+	return clear_pixels;
+}
+
+size_t grid_bytes(const struct maze_grid *const grid)
+{
+	return clear_bytes(grid) + grid->cells*(sizeof(unsigned) + sizeof(unsigned char));
+}
+
+void delete_grid(struct maze_grid *const grid)
+{
+	if (grid == NULL)
+	{
+		return;
+	}
+
+	if (grid->mapping != NULL)
+	{
+		munmap(grid->mapping, grid->mapping_size);
+	}
+	else
+	{
+		free_array(grid->clear, clear_bytes(grid), clear_storage(grid->storage));
+	}
+
+	free_array(grid->dist, grid->cells*sizeof(unsigned), grid->storage);
+	free_array(grid->parent, grid->cells*sizeof(unsigned char), grid->storage);
+	free(grid);
+}
@@ -0,0 +1,236 @@
+#ifndef KS_MAZE_SOLVER_GRID
+#define KS_MAZE_SOLVER_GRID
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+
+/**
+ * The grid that holds the per-pixel state of the maze used during the search:
+ *
+ *   - a bitmap of the clear pixels
+ *   - the distance of every pixel from the source
+ *   - the direction in which the predecessor of every pixel lies
+ *
+ * The grid is an implicit graph. The adjacencies of a pixel are found
+ * by looking up its neighbours in the clear bitmap instead of following
+ * pointers to heap allocated nodes.
+ *
+ * The per-pixel arrays could be stored in one of the following layouts:
+ *
+ *   GRID_LAYOUT_ROW_MAJOR - the usual row-major order of the image.
+ *
+ *   GRID_LAYOUT_TILED     - the image is split into square tiles of
+ *                           GRID_TILE_DIMENSION pixels. Tiles are stored in
+ *                           row-major order and so are the pixels within a tile.
+ *
+ *   GRID_LAYOUT_MORTON    - same as the tiled layout except that the pixels
+ *                           within a tile are stored in Z-order (Morton order).
+ *
+ * In the tiled layouts the "top" and "bottom" neighbours of a pixel are
+ * mostly found in the same tile (i.e., in the same few cache lines and page)
+ * instead of being a whole image row apart.
+ *
+ * The grid has a border of hurdle cells that is one pixel wide around the maze.
+ * So, the neighbours of every pixel in the maze (even the ones at its edges)
+ * could be looked up without any bounds checks. The pixels on the border are
+ * addressed using the row/column -1 (i.e., UINT_MAX) and width/height.
+ *
+ * The layout is chosen at compile time to keep the index translation in the
+ * accessors free of branches. It could be overridden during the build,
+ *
+ *     make GRID_LAYOUT=GRID_LAYOUT_MORTON
+ */
+
+#define GRID_LAYOUT_ROW_MAJOR 0
+#define GRID_LAYOUT_TILED 1
+#define GRID_LAYOUT_MORTON 2
+
+#ifndef KS_MAZE_GRID_LAYOUT
+#define KS_MAZE_GRID_LAYOUT GRID_LAYOUT_TILED
+#endif
+
+// #define KS_MAZE_SOLVER_GRID_DEBUG
+
+/**
+ * Tiles are (GRID_TILE_DIMENSION * GRID_TILE_DIMENSION) pixels in size.
+ * A tile of distances (4 bytes each) occupies exactly one 4KiB page.
+ */
+#define GRID_TILE_SHIFT 5
+#define GRID_TILE_DIMENSION (1u << GRID_TILE_SHIFT)
+#define GRID_TILE_MASK (GRID_TILE_DIMENSION - 1)
+
+/**
+ * Value of the distance of a pixel that hasn't been reached yet.
+ */
+#define GRID_UNVISITED UINT_MAX
+
+/**
+ * The direction in which the predecessor of a pixel lies.
+ *
+ * The straight directions come before the diagonal ones. The direction
+ * opposite to 'dir' is found using GRID_DIR_OPPOSITE(dir).
+ */
+enum grid_direction
+{
+	GRID_DIR_NONE,
+	GRID_DIR_LEFT,
+	GRID_DIR_UP,
+	GRID_DIR_RIGHT,
+	GRID_DIR_DOWN,
+	GRID_DIR_UP_LEFT,
+	GRID_DIR_UP_RIGHT,
+	GRID_DIR_DOWN_RIGHT,
+	GRID_DIR_DOWN_LEFT
+};
+
+#define GRID_DIR_OPPOSITE(dir) ((((dir)-1+2)&3) + 1 + (((dir)-1)&4))
+
+/**
+ * The offsets of the row and column of the pixel found in each direction.
+ */
+static const int grid_dir_row[] = { 0,  0, -1, 0, 1, -1, -1, 1,  1 };
+static const int grid_dir_col[] = { 0, -1,  0, 1, 0, -1,  1, 1, -1 };
+
+/**
+ * Where the per-pixel arrays of the grid are kept.
+ *
+ *   GRID_STORAGE_HEAP       - allocated from the heap
+ *
+ *   GRID_STORAGE_HUGE_PAGES - an anonymous mapping that the kernel is advised
+ *                             to back with transparent huge pages. It saves
+ *                             TLB misses for the large arrays.
+ *
+ *   GRID_STORAGE_FILE       - a shared mapping of an (unlinked) temporary
+ *                             file in $TMPDIR (or /var/tmp). The kernel pages
+ *                             the arrays in and out of the file, so a grid
+ *                             larger than the memory could be searched. The
+ *                             tiled layouts keep the pages touched together.
+ *                             The clear bitmap is still kept in memory.
+ */
+enum grid_storage
+{
+	GRID_STORAGE_HEAP,
+	GRID_STORAGE_HUGE_PAGES,
+	GRID_STORAGE_FILE
+};
+
+struct maze_grid
+{
+	unsigned width;         // width of the maze in pixels
+	unsigned height;        // height of the maze in pixels
+	unsigned stride;        // number of cells in a row (row-major layout only)
+	unsigned tiles_per_row; // number of tiles in a row of tiles (tiled layouts only)
+	size_t cells;           // number of cells in each of the per-pixel arrays
+	uint64_t *clear;        // bitmap of the clear pixels
+	unsigned *dist;         // distance of the pixel from the source
+	unsigned char *parent;  // the 'enum grid_direction' of the predecessor
+	enum grid_storage storage;
+
+	void *mapping;          // the mapped grid file holding 'clear' (if any)
+	size_t mapping_size;
+};
+
+/**
+ * Creates a grid for a maze of the given dimensions whose arrays are kept
+ * in the given storage. All the pixels are initially hurdles and unvisited.
+ *
+ * Returns a valid grid on success and NULL on failure.
+ */
+struct maze_grid *create_grid(unsigned width, unsigned height, enum grid_storage storage);
+
+/**
+ * Creates a grid for a maze of the given dimensions that uses the given
+ * clear bitmap (which is expected to have the size found by the grid's
+ * layout). Only the distances and the predecessors are allocated (from
+ * the heap).
+ *
+ * On success the bitmap belongs to the grid. It is freed by 'delete_grid'
+ * unless 'mapping' is set, in which case 'mapping' is unmapped instead.
+ *
+ * Returns a valid grid on success and NULL on failure.
+ */
+struct maze_grid *create_grid_with_clear(unsigned width, unsigned height, uint64_t *const clear);
+
+/**
+ * Returns the number of cells in the per-pixel arrays of a grid for a maze
+ * of the given dimensions.
+ */
+size_t grid_cells(unsigned width, unsigned height);
+
+/**
+ * Returns the number of clear pixels in the grid.
+ */
+size_t grid_clear_pixels(const struct maze_grid *const grid);
+
+/**
+ * Returns the bytes taken up by the arrays of the grid (wherever they are
+ * kept).
+ */
+size_t grid_bytes(const struct maze_grid *const grid);
+
+/**
+ * Free the memory taken up by the grid (and unmap its grid file, if any).
+ */
+void delete_grid(struct maze_grid *const grid);
+
+/**
+ * Spread the lower 16 bits of 'v' so that there is a 0 bit between
+ * every pair of adjacent bits.
+ */
+static inline
+uint32_t grid_spread_bits(uint32_t v)
+{
+	v &= 0x0000FFFF;
+	v = (v | (v << 8)) & 0x00FF00FF;
+	v = (v | (v << 4)) & 0x0F0F0F0F;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+	return v;
+}
+
+/**
+ * Translates the (row, col) of a pixel into the index of the pixel in the
+ * per-pixel arrays of the grid.
+ */
+static inline
+size_t grid_cell(const struct maze_grid *const grid, unsigned row, unsigned col)
+{
+	// skip the border (wraps the row/col -1 around to 0)
+	row++;
+	col++;
+
+#if KS_MAZE_GRID_LAYOUT == GRID_LAYOUT_ROW_MAJOR
+	return (size_t)row*grid->stride + col;
+#else
+	const size_t tile = (size_t)(row >> GRID_TILE_SHIFT)*grid->tiles_per_row + (col >> GRID_TILE_SHIFT);
+
+#if KS_MAZE_GRID_LAYOUT == GRID_LAYOUT_TILED
+	const size_t in_tile = ((row & GRID_TILE_MASK) << GRID_TILE_SHIFT) | (col & GRID_TILE_MASK);
+#else
+	const size_t in_tile = (grid_spread_bits(row & GRID_TILE_MASK) << 1) | grid_spread_bits(col & GRID_TILE_MASK);
+#endif
+
+	return (tile << (2*GRID_TILE_SHIFT)) | in_tile;
+#endif
+}
+
+/**
+ * Returns non-zero value if the pixel at the given cell is clear.
+ */
+static inline
+int grid_is_clear(const struct maze_grid *const grid, size_t cell)
+{
+	return (grid->clear[cell >> 6] >> (cell & 63)) & 1;
+}
+
+/**
+ * Mark the pixel at the given cell as clear.
+ */
+static inline
+void grid_set_clear(struct maze_grid *const grid, size_t cell)
+{
+	grid->clear[cell >> 6] |= UINT64_C(1) << (cell & 63);
+}
+
+#endif
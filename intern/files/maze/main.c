@@ -1,275 +1,671 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <stdbool.h>
 #include "maze_solver.h"
-#include "bmp/bmp_helpers.h"
+#include "maze_file.h"
+#include "batch.h"
+#include "cache/solution_cache.h"
+#include "plan/memory_plan.h"
+#include "stats/solver_stats.h"
 
-#define DEBUG
-// #define DEBUG_EXPAND_DATA
+/**
+ * The default limit on the size of the solution cache in MiB.
+ */
+#define DEFAULT_CACHE_SIZE 64
 
-#define ERRWRITE 128
+struct cache_options
+{
+	const char *dir;             // NULL when the cache isn't used
+	unsigned long long max_bytes;
+};
+
+struct stats_options
+{
+	const char *json_file;       // NULL when not wanted; "-" for the standard output
+	const char *trace_file;
+};
+
+static void print_usage(const char *const program)
+{
+	fprintf(stderr, "Usage: %s [options] <maze.bmp>\n", program);
+	fprintf(stderr, "       %s [options] --batch=<directory|list file>\n\n", program);
+	fprintf(stderr, "Options:\n");
+	fprintf(stderr, "  -c, --connectivity=<4|8>  pixels a pixel could move to (default: 4)\n");
+	fprintf(stderr, "  -H, --heuristic=<name>    none, manhattan, octile or euclidean\n");
+	fprintf(stderr, "                            (default: manhattan; octile with -c 8)\n");
+	fprintf(stderr, "  -w, --weight=<epsilon>    weight of the heuristic; the path found costs at\n");
+	fprintf(stderr, "                            most epsilon times the least cost (default: 1)\n");
+	fprintf(stderr, "  -a, --anytime             find a path using the weight and keep improving it\n");
+	fprintf(stderr, "  -t, --time-budget=<secs>  stop improving the path after the given time\n");
+	fprintf(stderr, "                            (default: until a shortest path is found)\n");
+	fprintf(stderr, "  -T, --threads=<n>         number of threads searching for the path in\n");
+	fprintf(stderr, "                            parallel (default: 1)\n");
+	fprintf(stderr, "  -d, --fill=<what>         fill dead-ends or rooms (dead ends and the corners\n");
+	fprintf(stderr, "                            of open areas) before searching (default: none)\n");
+	fprintf(stderr, "  -o, --compile=<file>      compile the graph of the maze into the file\n");
+	fprintf(stderr, "                            instead of solving it\n");
+	fprintf(stderr, "  -g, --graph=<file>        search the graph compiled into the file instead\n");
+	fprintf(stderr, "                            of creating it from the maze\n");
+	fprintf(stderr, "  -F, --field=<file>        find the path by following the goal distance field\n");
+	fprintf(stderr, "                            kept in the file (created when missing)\n");
+	fprintf(stderr, "  -s, --from=<row>,<col>    the pixel the path found using the field starts\n");
+	fprintf(stderr, "                            from (default: the start gate)\n");
+	fprintf(stderr, "  -m, --mem-limit=<MiB>     memory the solver could use; the representation\n");
+	fprintf(stderr, "                            of the maze is chosen to fit (default: the limit\n");
+	fprintf(stderr, "                            of the cgroup or the physical memory)\n");
+	fprintf(stderr, "  -P, --huge-pages          back the grid with transparent huge pages\n");
+	fprintf(stderr, "  -J, --stats=<file>        write the statistics of the run as JSON into the\n");
+	fprintf(stderr, "                            file ('-' for the standard output)\n");
+	fprintf(stderr, "  -R, --trace=<file>        write the phases of the run as Chrome trace events\n");
+	fprintf(stderr, "                            into the file ('-' for the standard output)\n");
+	fprintf(stderr, "  -C, --cache=<directory>   look up the solutions of the mazes in the given\n");
+	fprintf(stderr, "                            directory and keep the new ones in it\n");
+	fprintf(stderr, "  -S, --cache-size=<MiB>    limit on the size of the cache (default: %d)\n",
+	        DEFAULT_CACHE_SIZE);
+	fprintf(stderr, "\nBatch mode options:\n");
+	fprintf(stderr, "  -b, --batch=<source>      solve every .bmp file in the directory or every\n");
+	fprintf(stderr, "                            file listed (one per line) in the list file\n");
+	fprintf(stderr, "  -j, --jobs=<n>            number of solver threads (default: processors)\n");
+	fprintf(stderr, "  -r, --readers=<n>         number of reader threads (default: 1)\n");
+	fprintf(stderr, "  -f, --in-flight=<n>       maximum number of mazes in memory\n");
+	fprintf(stderr, "                            (default: 2 per solver thread)\n");
+}
 
 /**
- * Keeps only the first byte of every pixel and throws away the remaining bytes.
- * This shrinks the image size and simplifies the access to the pixel data.
+ * Parse a positive count given as an option argument.
+ *
+ * Returns 0 on success and non-zero value on failure.
  */
-void shrink_image(struct maze_image *maze)
+static int parse_count(const char *const arg, unsigned *const count)
 {
-	unsigned padding_adjustment = 0;
-	for (unsigned curr_row = 0; curr_row<maze->height; curr_row++)
+	char *end;
+	const unsigned long value = strtoul(arg, &end, 10);
+
+	if (*arg == '\0' || *end != '\0' || value == 0 || value > 4096)
 	{
-		for (unsigned curr_col = 0; curr_col<maze->width; curr_col++)
-		{
-			const unsigned curr_pixel = (curr_row*maze->width + curr_col);
-			*(maze->data + curr_pixel) = *(maze->data + bytes_per_pixel*curr_pixel + padding_adjustment);
-		}
-		padding_adjustment += maze->padding;
+		fprintf(stderr, "Invalid count: %s\n", arg);
+		return 1;
 	}
+
+	*count = value;
+	return 0;
 }
 
-void expand_data(struct maze_image *maze)
+/**
+ * Parse a real number in the range [min, max] given as an option argument.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int parse_real(const char *const arg, const double min, const double max, double *const real)
 {
-	unsigned expanded_offset = maze->pixels*bytes_per_pixel + maze->padding*maze->height - 1;
+	char *end;
+	const double value = strtod(arg, &end);
 
-	unsigned curr_row = maze->height;
-	do
+	if (*arg == '\0' || *end != '\0' || !(value >= min && value <= max))
 	{
-		curr_row--;
+		fprintf(stderr, "Invalid value: %s\n", arg);
+		return 1;
+	}
+
+	*real = value;
+	return 0;
+}
 
-		const unsigned char padding_byte = 0x00;
+/**
+ * Print the paths found by the search. The bound of the last one is kept in
+ * 'data' (a double).
+ */
+static void print_solution(const struct a_star_solution *const solution, void *const data)
+{
+	*(double *)data = solution->bound;
 
-		// fill in the padding
-		for (unsigned curr_padding_byte = 0; curr_padding_byte<maze->padding; curr_padding_byte++)
+	printf("Found a path of cost %u using weight %.2f in %.3fs (%zu pixels expanded),",
+	       solution->cost, solution->weight, solution->seconds, solution->nodes_expanded);
+
+	if (solution->bound > 0)
+	{
+		printf(" at most %.3f times the least cost.\n", solution->bound);
+	}
+	else
+	{
+		printf(" no bound on its cost (the heuristic overestimates it).\n");
+	}
+}
+
+/**
+ * Parse the command line options into 'options'.
+ *
+ * Returns the index of the first non-option argument on success and
+ * -1 on failure.
+ */
+static int parse_options(int argc, char *argv[], struct maze_solver_options *const options,
+                         struct batch_options *const batch, const char **const batch_source,
+                         struct cache_options *const cache, struct stats_options *const stats,
+                         const char **const compile_file)
+{
+	static const struct option long_options[] = {
+		{ "connectivity", required_argument, NULL, 'c' },
+		{ "heuristic",    required_argument, NULL, 'H' },
+		{ "weight",       required_argument, NULL, 'w' },
+		{ "anytime",      no_argument,       NULL, 'a' },
+		{ "time-budget",  required_argument, NULL, 't' },
+		{ "threads",      required_argument, NULL, 'T' },
+		{ "fill",         required_argument, NULL, 'd' },
+		{ "compile",      required_argument, NULL, 'o' },
+		{ "graph",        required_argument, NULL, 'g' },
+		{ "field",        required_argument, NULL, 'F' },
+		{ "from",         required_argument, NULL, 's' },
+		{ "mem-limit",    required_argument, NULL, 'm' },
+		{ "huge-pages",   no_argument,       NULL, 'P' },
+		{ "stats",        required_argument, NULL, 'J' },
+		{ "trace",        required_argument, NULL, 'R' },
+		{ "cache",        required_argument, NULL, 'C' },
+		{ "cache-size",   required_argument, NULL, 'S' },
+		{ "batch",        required_argument, NULL, 'b' },
+		{ "jobs",         required_argument, NULL, 'j' },
+		{ "readers",      required_argument, NULL, 'r' },
+		{ "in-flight",    required_argument, NULL, 'f' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	static const char *const heuristic_names[A_STAR_HEURISTICS] = {
+		[HEURISTIC_NONE]      = "none",
+		[HEURISTIC_MANHATTAN] = "manhattan",
+		[HEURISTIC_OCTILE]    = "octile",
+		[HEURISTIC_EUCLIDEAN] = "euclidean"
+	};
+
+	static const char *const fill_names[] = {
+		[FILL_NONE]      = "none",
+		[FILL_DEAD_ENDS] = "dead-ends",
+		[FILL_ROOMS]     = "rooms"
+	};
+
+	int opt;
+
+	bool in_flight_given = false;
+	bool heuristic_given = false;
+	bool from_given = false;
+	unsigned from_row, from_col;
+	char trailing;
+
+	initialise_solver_options(options);
+	initialise_batch_options(batch);
+	batch->solver = options;
+	*batch_source = NULL;
+	*compile_file = NULL;
+	cache->dir = NULL;
+	stats->json_file = NULL;
+	stats->trace_file = NULL;
+	cache->max_bytes = DEFAULT_CACHE_SIZE*1024ULL*1024ULL;
+
+	while ((opt = getopt_long(argc, argv, "c:H:w:at:T:d:o:g:F:s:m:PJ:R:C:S:b:j:r:f:", long_options, NULL)) != -1)
+	{
+		switch (opt)
 		{
+			case 'c':
+				if (strcmp(optarg, "4") == 0)
+				{
+					options->connectivity = CONNECTIVITY_4;
+				}
+				else if (strcmp(optarg, "8") == 0)
+				{
+					options->connectivity = CONNECTIVITY_8;
+				}
+				else
+				{
+					fprintf(stderr, "Invalid connectivity: %s\n", optarg);
+					return -1;
+				}
+				break;
 
-#ifdef DEBUG
-			if (expanded_offset > maze->pixels*bytes_per_pixel + maze->padding*maze->height)
+			case 'H':
 			{
-				fprintf(stderr, "expand_data: Assumption that 'expanded_offset' always has the correct offset failed!\n");
-				exit(EXIT_FAILURE);
+				unsigned heuristic = 0;
+
+				while (heuristic < A_STAR_HEURISTICS &&
+				       strcmp(optarg, heuristic_names[heuristic]) != 0)
+				{
+					heuristic++;
+				}
+
+				if (heuristic == A_STAR_HEURISTICS)
+				{
+					fprintf(stderr, "Invalid heuristic: %s\n", optarg);
+					return -1;
+				}
+
+				options->heuristic = heuristic;
+				heuristic_given = true;
+				break;
 			}
-#endif
 
-			*(maze->data + expanded_offset--) = padding_byte;
-		}
+			case 'w':
+				if (parse_real(optarg, 1.0, A_STAR_WEIGHT_MAX, &options->weight))
+				{
+					return -1;
+				}
+				break;
 
-		unsigned curr_col = maze->width;
-		do
-		{
-			curr_col--;
+			case 'a':
+				options->anytime = 1;
+				break;
 
-			const unsigned shrunk_pixel_offset = (curr_row*maze->width + curr_col);
+			case 't':
+				if (parse_real(optarg, 0.0, 1e6, &options->time_budget))
+				{
+					return -1;
+				}
+				break;
 
-#ifdef DEBUG_EXPAND_DATA
-			printf("expand_data: expanding data for pixel: %u; expanded_offset: %u;\n",
-			       shrunk_pixel_offset, expanded_offset);
-#endif
+			case 'T':
+				if (parse_count(optarg, &options->threads))
+				{
+					return -1;
+				}
+				break;
 
-			// expand the pixel bytes
-			for (unsigned pixel_byte = 0; pixel_byte<bytes_per_pixel; pixel_byte++)
+			case 'd':
 			{
+				unsigned fill = 0;
 
-#ifdef DEBUG
-				if (expanded_offset > maze->pixels*bytes_per_pixel + maze->padding*maze->height)
+				while (fill < sizeof(fill_names)/sizeof(fill_names[0]) &&
+				       strcmp(optarg, fill_names[fill]) != 0)
 				{
-					fprintf(stderr, "expand_data: Assumption that 'expanded_offset' always has the correct offset failed!\n");
-					exit(EXIT_FAILURE);
+					fill++;
 				}
-#endif
 
-				*(maze->data + expanded_offset--) = *(maze->data + shrunk_pixel_offset);
+				if (fill == sizeof(fill_names)/sizeof(fill_names[0]))
+				{
+					fprintf(stderr, "Invalid fill: %s\n", optarg);
+					return -1;
+				}
+
+				options->fill = fill;
+				break;
 			}
 
-		} while (curr_col != 0);
+			case 'o':
+				*compile_file = optarg;
+				break;
 
-	} while (curr_row != 0);
-}
+			case 'g':
+				options->graph_file = optarg;
+				break;
 
-int main(int argc, char *argv[])
-{
-	if (argc < 2)
+			case 'F':
+				options->distance_field = optarg;
+				break;
+
+			case 's':
+				if (sscanf(optarg, "%u,%u%c", &from_row, &from_col, &trailing) != 2)
+				{
+					fprintf(stderr, "Invalid pixel: %s\n", optarg);
+					return -1;
+				}
+				from_given = true;
+				break;
+
+			case 'C':
+				cache->dir = optarg;
+				break;
+
+			case 'm':
+			{
+				double mem_limit;
+
+				if (parse_real(optarg, 1.0, 1e6, &mem_limit))
+				{
+					return -1;
+				}
+
+				options->mem_limit = mem_limit*1024*1024;
+				break;
+			}
+
+			case 'P':
+				options->huge_pages = 1;
+				break;
+
+			case 'J':
+				stats->json_file = optarg;
+				break;
+
+			case 'R':
+				stats->trace_file = optarg;
+				break;
+
+			case 'S':
+			{
+				double cache_size;
+
+				if (parse_real(optarg, 0.0, 1e6, &cache_size))
+				{
+					return -1;
+				}
+
+				cache->max_bytes = cache_size*1024*1024;
+				break;
+			}
+
+			case 'b':
+				*batch_source = optarg;
+				break;
+
+			case 'j':
+				if (parse_count(optarg, &batch->workers))
+				{
+					return -1;
+				}
+				break;
+
+			case 'r':
+				if (parse_count(optarg, &batch->readers))
+				{
+					return -1;
+				}
+				break;
+
+			case 'f':
+				if (parse_count(optarg, &batch->in_flight))
+				{
+					return -1;
+				}
+				in_flight_given = true;
+				break;
+
+			default:
+				return -1;
+		}
+	}
+
+	// the Manhattan distance overestimates the cost of the diagonal moves
+	if (!heuristic_given && options->connectivity == CONNECTIVITY_8)
 	{
-		fprintf(stderr, "File name is required as first argument!\n");
-		return 1;
+		options->heuristic = HEURISTIC_OCTILE;
 	}
-	else if (argc > 2)
+
+	if (!in_flight_given)
 	{
-		fprintf(stderr, "Too many arguments.\n");
-		return 1;
+		batch->in_flight = 2*batch->workers;
 	}
 
-	FILE *image_file = fopen(argv[1], "r+");
-	unsigned char ret_val = 0;
+	if (*batch_source != NULL)
+	{
+		const size_t mem_limit = (options->mem_limit != 0) ? options->mem_limit : detect_memory_limit();
 
-	if (image_file == NULL)
+		// the mazes being solved at once share the memory
+		options->mem_limit = mem_limit/batch->workers;
+	}
+
+	if (from_given)
 	{
-		fprintf(stderr, "Could not open the file!\n");
-		return 1;
+		options->start_row = from_row;
+		options->start_col = from_col;
 	}
 
-	static const unsigned long width_offset = 18L,
-				   header_size = 54L;
+	return optind;
+}
+
+/**
+ * Write the statistics into 'path' ("-" for the standard output) using the
+ * given writer. Nothing is written when 'path' is NULL.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int write_stats(const char *const path, const struct solver_stats *const stats,
+                       int (*const writer)(const struct solver_stats *const, FILE *const))
+{
+	if (path == NULL)
+	{
+		return 0;
+	}
 
-	// create the maze object
-	struct maze_image *maze = malloc(sizeof(struct maze_image));
+	const bool to_stdout = strcmp(path, "-") == 0;
+	FILE *const out = to_stdout ? stdout : fopen(path, "w");
 
-	if (maze == NULL)
+	int status = (out != NULL) ? writer(stats, out) : 1;
+
+	if (out != NULL && !to_stdout && fclose(out))
 	{
-		fprintf(stderr, "Not enough memory to create maze object!\n");
-		ret_val = 1;
-		goto QUIT;
+		status = 1;
 	}
 
-	// get the image width and height
-	if (fseek(image_file, width_offset, SEEK_SET)) // go to the offset of the image width
+	if (status)
 	{
-		fprintf(stderr, "File format not as expected!\n");
-		ret_val = 1;
-		goto FREE_NODATA_QUIT;
+		fprintf(stderr, "Could not write the statistics into %s\n", path);
 	}
 
-	if (
-		fread(&(maze->width), 4L, 1, image_file) == 0 ||
-		fread(&(maze->height), 4L, 1, image_file) == 0
-	)
+	return status;
+}
+
+/**
+ * Solve the mazes found in the given batch source.
+ *
+ * Returns the exit status of the program.
+ */
+static int solve_batch(const char *const batch_source, const struct batch_options *const batch)
+{
+	struct batch_stats stats;
+	const int batch_status = solve_maze_batch(batch_source, batch, &stats);
+
+	if (batch_status == ERRBATCHSOURCE)
 	{
-		fprintf(stderr, "Reading image metadata failed!\n");
-		ret_val = 1;
-		goto FREE_NODATA_QUIT;
+		fprintf(stderr, "Could not read the mazes to solve from: %s\n", batch_source);
+		return 1;
 	}
+	else if (batch_status == ERRBATCHMEMORY)
+	{
+		fprintf(stderr, "Not enough memory to set up the batch!\n");
+		return 1;
+	}
+
+	print_batch_stats(&stats);
+	return batch_status;
+}
 
-	maze->pixels = maze->width*maze->height;
+/**
+ * The exit status for the given error code. Exit statuses are only 8 bits
+ * wide, so the codes that don't fit in them are reported as 1.
+ */
+static int exit_status(const int error)
+{
+	return (error > 255) ? 1 : error;
+}
 
-	// find the padding
-	maze->padding = find_padding(maze->width);
+/**
+ * Compile the graph of the maze in the given file into 'graph_file'.
+ *
+ * Returns the exit status of the program.
+ */
+static int compile_file_maze(const char *const path, const char *const graph_file)
+{
+	struct maze_file file;
+	int ret_val = read_maze_file(path, &file);
 
-#ifdef DEBUG
-	printf("Image dimensions (in pixels):\n");
-	printf("width: %u\t height: %u\n", maze->width, maze->height);
-#endif
+	if (ret_val)
+	{
+		fprintf(stderr, "%s\n", maze_error_message(ret_val));
+		return 1;
+	}
 
-	// find the image data size
-	fseek(image_file, 0, SEEK_END);
-	const long file_size = ftell(image_file);
-	long data_size = file_size-header_size;
+	ret_val = compile_maze(&file.maze, graph_file);
 
-	if (data_size < 0)
+	if (ret_val == 0)
 	{
-		fprintf(stderr, "File format not as expected!\n");
-		ret_val = 1;
-		goto FREE_NODATA_QUIT;
+		printf("The graph of the maze has been compiled into %s.\n", graph_file);
+	}
+	else
+	{
+		fprintf(stderr, "%s\n", maze_error_message(ret_val));
 	}
 
-#ifdef DEBUG
-	printf("Size of image data: %lu\n", data_size);
-#endif
+	free_maze_file(&file);
+	return ret_val;
+}
 
-	// allocate memory to read in the image
-	maze->data = malloc(data_size);
+/**
+ * Solve the maze in the given file.
+ *
+ * Returns the exit status of the program.
+ */
+static int solve_file(const char *const path, struct maze_solver_options *const options)
+{
+	// the bound of the path found (see 'struct a_star_solution'); updated by
+	// 'print_solution' when the paths are printed
+	double bound = (options->weight == 1.0 &&
+	                a_star_heuristic_admissible(options->connectivity, options->heuristic)) ? 1.0 : 0;
 
-	if (maze->data == NULL)
+	if (options->weight > 1.0 || options->anytime)
 	{
-		fprintf(stderr, "Not enough memory to read in image!\n");
-		ret_val = 1;
-		goto FREE_NODATA_QUIT;
+		options->on_solution = print_solution;
+		options->solution_data = &bound;
 	}
 
-	// skip past the header
-	if (fseek(image_file, 54L, SEEK_SET))
+	struct maze_file file;
+	int ret_val = read_maze_file(path, &file);
+
+	if (ret_val)
 	{
-		fprintf(stderr, "File format not as expected!\n");
-		ret_val = 1;
-		goto FREE_NODATA_QUIT;
+		fprintf(stderr, "%s\n", maze_error_message(ret_val));
+		return 1;
 	}
 
-	// read the image
-	if (fread(maze->data, data_size, 1, image_file) == 0)
+	ret_val = solve_maze(&file.maze, options);
+
+	if (ret_val)
 	{
-		fprintf(stderr, "Reading image failed!\n");
-		ret_val = 1;
-		goto FREE_QUIT;
+		fprintf(stderr, "%s\n", maze_error_message(ret_val));
+		goto FREE_FILE;
 	}
 
-	// throw away the unnecessary parts of the image
-	shrink_image(maze);
+	solver_phase_begin(options->stats, PHASE_WRITE);
+	ret_val = write_maze_file(path, &file, 0);
+	solver_phase_end(options->stats, PHASE_WRITE);
+
+	if (options->stats != NULL)
+	{
+		options->stats->seconds = solver_stats_seconds(options->stats);
+	}
 
-	// reduce the image size after shrinking
-	unsigned char *shrunk_data = realloc(maze->data, maze->pixels*sizeof(unsigned char));
-	if (shrunk_data == NULL)
+	if (ret_val == ERRFILEMEMORY)
 	{
-		// Fail in case we couldn't shrink the memro (!?) to avoid unnecessarry overhead of function
-		// calls to identify the offset of a pixel in the data.
-		//
-		// If that overhead is not an issue, we could pass a function pointer to 'solve_maze' indicating
-		// how to find the pixel offset and thus handling this failure graciously.
-		fprintf(stderr, "Shrinking image data failed!\n");
+		fprintf(stderr, "Expanding image failed!\n");
 		ret_val = 1;
-		goto FREE_QUIT;
+	}
+	else if (ret_val)
+	{
+		fprintf(stderr, "%s\n", maze_error_message(ret_val));
 	}
 	else
 	{
-		maze->data = shrunk_data;
-		shrunk_data = NULL;
+		if (bound > 0 && bound <= 1.0)
+		{
+			printf("Successfully found the shortest path between from the source to the destination.\n");
+		}
+		else
+		{
+			printf("Successfully found a path from the source to the destination.\n");
+		}
+
+		printf("The solution has been written to the file.\n");
 	}
 
-	ret_val = solve_maze(maze);
-	if (ret_val == ERRMEMORY)
+FREE_FILE:
+	free_maze_file(&file);
+	return ret_val;
+}
+
+int main(int argc, char *argv[])
+{
+	struct maze_solver_options options;
+	struct batch_options batch;
+	struct cache_options cache_options;
+	struct stats_options stats_options;
+	const char *batch_source, *compile_file;
+	const int file_arg = parse_options(argc, argv, &options, &batch, &batch_source,
+	                                   &cache_options, &stats_options, &compile_file);
+
+	if (file_arg == -1)
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+	else if (batch_source != NULL &&
+	         (compile_file != NULL || options.graph_file != NULL || options.distance_field != NULL))
 	{
-		fprintf(stderr, "Could not solve maze due to insufficient memory!\n");
-		goto FREE_QUIT;
+		fprintf(stderr, "A graph or a distance field could be used only for a single maze.\n");
+		return 1;
 	}
-	else if (ret_val == ERROPENINGS)
+	else if (batch_source != NULL && (stats_options.json_file != NULL || stats_options.trace_file != NULL))
 	{
-		fprintf(stderr, "Could not find openings (start and end pixels) for the given image!\n");
-		goto FREE_QUIT;
+		fprintf(stderr, "The statistics could be written only for a single maze.\n");
+		return 1;
 	}
-	else if (ret_val == ERRSHPATH)
+	else if (options.fill != FILL_NONE &&
+	         (compile_file != NULL || options.graph_file != NULL || options.distance_field != NULL))
 	{
-		fprintf(stderr, "Could not find shortest path from source to end in the given image!\n");
-		goto FREE_QUIT;
+		// the graph compiled and the field are created from every clear pixel
+		fprintf(stderr, "The pixels could be filled only when the graph is created from the maze.\n");
+		print_usage(argv[0]);
+		return 1;
+	}
+	else if (batch_source == NULL && file_arg >= argc)
+	{
+		fprintf(stderr, "File name is required as an argument!\n");
+		print_usage(argv[0]);
+		return 1;
+	}
+	else if (file_arg + (batch_source == NULL) < argc)
+	{
+		fprintf(stderr, "Too many arguments.\n");
+		return 1;
 	}
 
-	// seek to the start of image data
-	// This should succeed if the previous one did!
-	fseek(image_file, 54L, SEEK_SET);
-
-	// expand the memory to expand the data to BMP format
-	unsigned char *expanded_data = realloc(maze->data, data_size);
-	if (expanded_data == NULL)
+	if (compile_file != NULL)
 	{
-		// we have to fail because we are allowed to use fwrite only once
-		// So, the fallback technique of directly expanding in file is not possible.
-		fprintf(stderr, "Expanding image failed!\n");
-		ret_val = 1;
-		goto FREE_QUIT;
+		return exit_status(compile_file_maze(argv[file_arg], compile_file));
 	}
-	else
+
+	struct solution_cache cache;
+
+	if (cache_options.dir != NULL)
 	{
-		maze->data = expanded_data;
-		expanded_data = NULL;
+		if (open_solution_cache(&cache, cache_options.dir, cache_options.max_bytes))
+		{
+			fprintf(stderr, "Could not open the solution cache: %s\n", cache_options.dir);
+			return 1;
+		}
+
+		options.cache = &cache;
 	}
 
-	expand_data(maze);
+	struct solver_stats stats;
 
-	// write the solution
-	if (fwrite(maze->data, data_size, 1, image_file) == 0)
+	if (stats_options.json_file != NULL || stats_options.trace_file != NULL)
 	{
-		fprintf(stderr, "Could not write the solved maze successfully to the file!\n");
-		ret_val = ERRWRITE;
-		goto FREE_QUIT;
+		// cleared again by the solver; only left as it is when the maze couldn't be read
+		reset_solver_stats(&stats);
+		options.stats = &stats;
 	}
 
-	printf("Successfully found the shortest path between from the source to the destination.\n");
-	printf("The solution has been written to the file.\n");
+	int ret_val = (batch_source != NULL) ? solve_batch(batch_source, &batch)
+	                                     : solve_file(argv[file_arg], &options);
 
-FREE_QUIT:
-	// free the memory
-	free(maze->data);
+	if (options.stats != NULL &&
+	    (write_stats(stats_options.json_file, &stats, write_solver_stats_json) ||
+	     write_stats(stats_options.trace_file, &stats, write_solver_stats_trace)))
+	{
+		ret_val = (ret_val == 0) ? 1 : ret_val;
+	}
 
-FREE_NODATA_QUIT:
-	free(maze);
+	if (options.cache != NULL)
+	{
+		print_solution_cache_stats(&cache);
+		close_solution_cache(&cache);
+	}
 
-QUIT:
-	// close the file
-	fclose(image_file);
-	return ret_val;
+	return exit_status(ret_val);
 }
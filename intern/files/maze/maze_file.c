@@ -0,0 +1,690 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "maze_file.h"
+#include "bmp/bmp_helpers.h"
+#include "bmp/bmp_rle.h"
+#include "cache/solution_cache.h"
+#include "common.h"
+
+#ifdef KS_MAZE_SOLVER_DEBUG
+#define DEBUG
+#endif
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+/**
+ * The largest info header (BITMAPV5HEADER) and the file header before it
+ */
+#define BMP_HEADER_MAX (14 + 124)
+
+/**
+ * The parts of an RLE compressed image needed to write it back.
+ */
+struct maze_file_rle
+{
+	unsigned char header[BMP_HEADER_MAX];       // the file and the info headers
+	unsigned header_size;
+	unsigned colours;                           // entries in the palette
+	unsigned char palette[BMP_PALETTE_MAX][4];  // blue, green, red and a reserved byte
+};
+
+/**
+ * Returns the hash of the dimensions of the maze that the hash of its rows
+ * starts from.
+ */
+static uint64_t hash_dimensions(const struct maze_image *const maze)
+{
+	const uint32_t dimensions[] = { maze->width, maze->height };
+
+	return solution_cache_hash(SOLUTION_CACHE_HASH_SEED, dimensions, sizeof(dimensions));
+}
+
+/**
+ * Keeps only the first byte of every pixel and throws away the remaining bytes.
+ * This shrinks the image size and simplifies the access to the pixel data.
+ * The hash of the pixels kept (used by the solution cache) is found on the way.
+ */
+static void shrink_image(struct maze_image *maze)
+{
+	uint64_t hash = hash_dimensions(maze);
+
+	size_t padding_adjustment = 0;
+	for (unsigned curr_row = 0; curr_row<maze->height; curr_row++)
+	{
+		for (unsigned curr_col = 0; curr_col<maze->width; curr_col++)
+		{
+			const size_t curr_pixel = ((size_t)curr_row*maze->width + curr_col);
+			*(maze->data + curr_pixel) = *(maze->data + bytes_per_pixel*curr_pixel + padding_adjustment);
+		}
+		padding_adjustment += maze->padding;
+
+		// hash the row while it is still in the cache
+		hash = solution_cache_hash(hash, maze->data + (size_t)curr_row*maze->width, maze->width);
+	}
+
+	maze->hash = (hash != 0) ? hash : 1;
+}
+
+/**
+ * Rows of at least this many bytes are expanded by a thread of its own.
+ */
+#define EXPAND_BAND_MIN_BYTES (1UL << 20)
+
+/**
+ * Copy the byte kept for each of the 'width' pixels of a row in 'shrunk'
+ * into every byte of the pixel in 'expanded'. The rows must not overlap.
+ */
+static void expand_row(unsigned char *restrict expanded, const unsigned char *restrict shrunk, const unsigned width)
+{
+	unsigned col = 0;
+
+#ifdef __SSSE3__
+	// 16 pixels into 48 bytes using three shuffles
+	const __m128i first = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5),
+	              second = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10),
+	              third = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+
+	for (; col + 16 <= width; col += 16)
+	{
+		const __m128i pixels = _mm_loadu_si128((const __m128i *)(shrunk + col));
+		__m128i *const out = (__m128i *)(expanded + (size_t)col*bytes_per_pixel);
+
+		_mm_storeu_si128(out, _mm_shuffle_epi8(pixels, first));
+		_mm_storeu_si128(out + 1, _mm_shuffle_epi8(pixels, second));
+		_mm_storeu_si128(out + 2, _mm_shuffle_epi8(pixels, third));
+	}
+#endif
+
+	// a pixel a store; the spare byte is overwritten by the next pixel
+	for (; col + 1 < width; col++)
+	{
+		const uint32_t pixel = shrunk[col]*0x01010101U;
+		memcpy(expanded + (size_t)col*bytes_per_pixel, &pixel, sizeof(pixel));
+	}
+
+	// the last pixel must not touch the padding or the next row
+	for (; col < width; col++)
+	{
+		memset(expanded + (size_t)col*bytes_per_pixel, shrunk[col], bytes_per_pixel);
+	}
+}
+
+/**
+ * A band of rows expanded by a thread.
+ */
+struct expand_band
+{
+	struct maze_image *maze;
+	unsigned first_row, last_row;  // the rows [first_row, last_row)
+	pthread_t thread;
+};
+
+static void *expand_rows(void *const data)
+{
+	const struct expand_band *const band = data;
+	struct maze_image *const maze = band->maze;
+	const size_t row_bytes = (size_t)maze->width*bytes_per_pixel + maze->padding;
+
+	for (unsigned curr_row = band->first_row; curr_row < band->last_row; curr_row++)
+	{
+		unsigned char *const expanded = maze->data + curr_row*row_bytes;
+
+		expand_row(expanded, maze->data + (size_t)curr_row*maze->width, maze->width);
+		memset(expanded + row_bytes - maze->padding, 0x00, maze->padding);
+	}
+
+	return NULL;
+}
+
+/**
+ * Expand the rows [first_row, last_row) splitting them into bands among
+ * at most 'threads' threads. The expanded rows must not overlap the shrunk
+ * pixels of any of the rows.
+ */
+static void expand_bands(struct maze_image *const maze, const unsigned first_row, const unsigned last_row,
+                         unsigned threads)
+{
+	const size_t row_bytes = (size_t)maze->width*bytes_per_pixel + maze->padding;
+	const size_t rows_per_thread = (EXPAND_BAND_MIN_BYTES + row_bytes - 1)/row_bytes;
+	const unsigned rows = last_row - first_row;
+
+	if (threads > (rows + rows_per_thread - 1)/rows_per_thread)
+	{
+		threads = (rows + rows_per_thread - 1)/rows_per_thread;
+	}
+
+	if (threads <= 1)
+	{
+		struct expand_band band = { maze, first_row, last_row, 0 };
+		expand_rows(&band);
+		return;
+	}
+
+	struct expand_band bands[threads];
+	int started[threads];
+
+	for (unsigned thread = 0; thread < threads; thread++)
+	{
+		bands[thread].maze = maze;
+		bands[thread].first_row = first_row + (size_t)rows*thread/threads;
+		bands[thread].last_row = first_row + (size_t)rows*(thread + 1)/threads;
+
+		// the last band (or one whose thread couldn't be started) is expanded by this thread
+		started[thread] = thread + 1 < threads &&
+		                  pthread_create(&bands[thread].thread, NULL, expand_rows, bands + thread) == 0;
+
+		if (!started[thread])
+		{
+			expand_rows(bands + thread);
+		}
+	}
+
+	for (unsigned thread = 0; thread < threads; thread++)
+	{
+		if (started[thread])
+		{
+			pthread_join(bands[thread].thread, NULL);
+		}
+	}
+}
+
+/**
+ * Expand the shrunk image (a byte per pixel) back to the BMP format in place.
+ *
+ * The expanded rows are longer than the shrunk rows, so the expanded row
+ * 'r' overwrites the shrunk rows after it (from about '3r' on). The rows are
+ * hence expanded from the end in waves: the rows of a wave are expanded
+ * only into bytes that lie beyond the shrunk pixels of all the rows not yet
+ * expanded, so the rows of a wave could be expanded in parallel. Every wave
+ * is about a third of the one before it. The first row overlaps its own
+ * shrunk pixels and is expanded a byte at a time from its end.
+ */
+static void expand_data(struct maze_image *const maze, const unsigned threads)
+{
+	const size_t row_bytes = (size_t)maze->width*bytes_per_pixel + maze->padding;
+	unsigned last_row = maze->height;
+
+	while (last_row > 1)
+	{
+		// the first row whose expanded bytes start after the shrunk pixels of the rows before 'last_row'
+		const unsigned first_row = ((size_t)last_row*maze->width + row_bytes - 1)/row_bytes;
+
+		expand_bands(maze, first_row, last_row, threads);
+		last_row = first_row;
+	}
+
+	memset(maze->data + row_bytes - maze->padding, 0x00, maze->padding);
+
+	unsigned curr_col = maze->width;
+	do
+	{
+		curr_col--;
+
+		for (unsigned pixel_byte = 0; pixel_byte<bytes_per_pixel; pixel_byte++)
+		{
+			*(maze->data + (size_t)curr_col*bytes_per_pixel + pixel_byte) = *(maze->data + curr_col);
+		}
+
+	} while (curr_col != 0);
+}
+
+/**
+ * Read the pixels of the RLE compressed image in 'image_file' (whose
+ * dimensions are found in 'maze') straight into a byte a pixel. The byte of
+ * a pixel is the first byte of its entry in the palette, just like the byte
+ * kept for a pixel of an uncompressed image.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+static int read_rle_maze(FILE *const image_file, const unsigned compression, const unsigned bits,
+                         struct maze_file *const file)
+{
+	struct maze_image *const maze = &file->maze;
+	uint32_t data_offset, info_size, colours;
+
+	if (fseek(image_file, 10L, SEEK_SET) ||
+	    fread(&data_offset, 4L, 1, image_file) == 0 ||
+	    fread(&info_size, 4L, 1, image_file) == 0 ||
+	    fseek(image_file, 46L, SEEK_SET) ||
+	    fread(&colours, 4L, 1, image_file) == 0)
+	{
+		return ERRFILEREAD;
+	}
+
+	// no colours used means all the colours
+	colours = (colours != 0) ? colours : 1U << bits;
+
+	if (info_size < 40 || 14 + info_size > BMP_HEADER_MAX || colours > (1U << bits))
+	{
+		return ERRFILEFORMAT;
+	}
+
+	struct maze_file_rle *const rle = malloc(sizeof(struct maze_file_rle));
+
+	if (rle == NULL)
+	{
+		return ERRFILEMEMORY;
+	}
+
+	rle->header_size = 14 + info_size;
+	rle->colours = colours;
+
+	// the palette follows the headers
+	if (fseek(image_file, 0, SEEK_SET) ||
+	    fread(rle->header, rle->header_size, 1, image_file) == 0 ||
+	    fread(rle->palette, 4*colours, 1, image_file) == 0)
+	{
+		free(rle);
+		return ERRFILEREAD;
+	}
+
+	unsigned char entry_byte[BMP_PALETTE_MAX] = { HURDLE_PIXEL };
+
+	for (unsigned entry = 0; entry < colours; entry++)
+	{
+		entry_byte[entry] = rle->palette[entry][0];
+	}
+
+	maze->data = malloc(maze->pixels*sizeof(unsigned char));
+
+	if (maze->data == NULL)
+	{
+		free(rle);
+		return ERRFILEMEMORY;
+	}
+
+	// the pixels skipped by the runs are of the first colour
+	memset(maze->data, entry_byte[0], maze->pixels);
+
+	if (fseek(image_file, data_offset, SEEK_SET) ||
+	    decode_bmp_rle(image_file, compression, entry_byte, maze->data, maze->width, maze->height))
+	{
+		free(rle);
+		free(maze->data);
+		maze->data = NULL;
+		return ERRFILEFORMAT;
+	}
+
+	file->data_size = ftell(image_file) - data_offset;
+	file->rle = rle;
+
+	uint64_t hash = hash_dimensions(maze);
+
+	for (unsigned curr_row = 0; curr_row<maze->height; curr_row++)
+	{
+		hash = solution_cache_hash(hash, maze->data + (size_t)curr_row*maze->width, maze->width);
+	}
+
+	maze->hash = (hash != 0) ? hash : 1;
+	return 0;
+}
+
+/**
+ * Write the (solved) maze in 'file' back into 'image_file' as an RLE8
+ * compressed image. The bytes that aren't the first byte of an entry of
+ * the palette (such as the colour of the path) are added to the palette
+ * as shades of grey, which is what they are written as in an uncompressed
+ * image. Once the palette is full they take the place of the entries that
+ * no pixel is written as: those whose first byte isn't used and those that
+ * repeat the first byte of an earlier entry.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+static int write_rle_maze(FILE *const image_file, struct maze_file *const file)
+{
+	const struct maze_image *const maze = &file->maze;
+	struct maze_file_rle *const rle = file->rle;
+	unsigned char byte_entry[256], used[256] = { 0 }, written[BMP_PALETTE_MAX] = { 0 };
+	int found[256] = { 0 };
+
+	for (size_t pixel = 0; pixel < maze->pixels; pixel++)
+	{
+		used[maze->data[pixel]] = 1;
+	}
+
+	for (unsigned entry = 0; entry < rle->colours; entry++)
+	{
+		const unsigned char byte = rle->palette[entry][0];
+
+		if (!found[byte])
+		{
+			byte_entry[byte] = entry;
+			found[byte] = 1;
+		}
+	}
+
+	for (unsigned byte = 0; byte < 256; byte++)
+	{
+		if (used[byte] && found[byte])
+		{
+			written[byte_entry[byte]] = 1;
+		}
+	}
+
+	// An entry is always left for every byte missing from the palette: the
+	// entries written as have distinct first bytes, none of which is missing.
+	unsigned spare = 0;
+
+	for (unsigned byte = 0; byte < 256; byte++)
+	{
+		if (used[byte] && !found[byte])
+		{
+			unsigned entry;
+
+			if (rle->colours < BMP_PALETTE_MAX)
+			{
+				entry = rle->colours++;
+			}
+			else
+			{
+				while (written[spare])
+				{
+					spare++;
+				}
+
+				entry = spare;
+			}
+
+			memset(rle->palette[entry], byte, 3);
+			rle->palette[entry][3] = 0;
+			byte_entry[byte] = entry;
+			written[entry] = 1;
+		}
+	}
+
+	const uint16_t bits = 8;
+	const uint32_t compression = BMP_RLE8,
+	               data_offset = rle->header_size + 4*rle->colours,
+	               colours = rle->colours,
+	               important_colours = 0;
+
+	memcpy(rle->header + 10, &data_offset, 4);
+	memcpy(rle->header + 28, &bits, 2);
+	memcpy(rle->header + 30, &compression, 4);
+	memcpy(rle->header + 46, &colours, 4);
+	memcpy(rle->header + 50, &important_colours, 4);
+
+	if (fseek(image_file, data_offset, SEEK_SET))
+	{
+		return ERRWRITE;
+	}
+
+	const long data_size = encode_bmp_rle8(image_file, byte_entry, maze->data, maze->width, maze->height);
+
+	if (data_size < 0)
+	{
+		return ERRWRITE;
+	}
+
+	const uint32_t image_size = data_size,
+	               file_size = data_offset + image_size;
+
+	memcpy(rle->header + 2, &file_size, 4);
+	memcpy(rle->header + 34, &image_size, 4);
+
+	// the headers and the palette once the size of the runs is known
+	if (fseek(image_file, 0, SEEK_SET) ||
+	    fwrite(rle->header, rle->header_size, 1, image_file) == 0 ||
+	    fwrite(rle->palette, 4*rle->colours, 1, image_file) == 0 ||
+	    fflush(image_file) ||
+	    ftruncate(fileno(image_file), file_size))
+	{
+		return ERRWRITE;
+	}
+
+	return 0;
+}
+
+int read_maze_file(const char *const path, struct maze_file *const file)
+{
+	struct maze_image *const maze = &file->maze;
+	FILE *image_file = fopen(path, "r+");
+	int ret_val = 0;
+
+	maze->data = NULL;
+	file->rle = NULL;
+
+	if (image_file == NULL)
+	{
+		return ERRFILEOPEN;
+	}
+
+	static const unsigned long width_offset = 18L,
+				   header_size = 54L;
+
+	// get the image width and height
+	if (fseek(image_file, width_offset, SEEK_SET)) // go to the offset of the image width
+	{
+		ret_val = ERRFILEFORMAT;
+		goto QUIT;
+	}
+
+	// both are signed in the header; a negative height is a top-down image
+	int32_t width, height;
+	uint16_t planes, bits;
+	uint32_t compression;
+
+	if (
+		fread(&width, 4L, 1, image_file) == 0 ||
+		fread(&height, 4L, 1, image_file) == 0 ||
+		fread(&planes, 2L, 1, image_file) == 0 ||
+		fread(&bits, 2L, 1, image_file) == 0 ||
+		fread(&compression, 4L, 1, image_file) == 0
+	)
+	{
+		ret_val = ERRFILEREAD;
+		goto QUIT;
+	}
+
+	if (width <= 0 || height <= 0)
+	{
+		ret_val = ERRFILEFORMAT;
+		goto QUIT;
+	}
+
+	maze->width = width;
+	maze->height = height;
+
+	// at most (2^31)^2 pixels, which needs 64 bits
+	maze->pixels = (size_t)maze->width*maze->height;
+
+	// find the padding
+	maze->padding = find_padding(maze->width);
+
+#ifdef DEBUG
+	printf("Image dimensions (in pixels):\n");
+	printf("width: %u\t height: %u\n", maze->width, maze->height);
+#endif
+
+	if ((compression == BMP_RLE8 && bits == 8) || (compression == BMP_RLE4 && bits == 4))
+	{
+		ret_val = read_rle_maze(image_file, compression, bits, file);
+		goto QUIT;
+	}
+	else if (compression != BMP_RGB || bits != bytes_per_pixel*8)
+	{
+		ret_val = ERRFILEFORMAT;
+		goto QUIT;
+	}
+
+	// find the image data size
+	fseek(image_file, 0, SEEK_END);
+	const long file_size = ftell(image_file);
+	file->data_size = file_size-header_size;
+
+	// the image must hold every pixel (and the padding of every row)
+	if (file->data_size < 0 ||
+	    (size_t)file->data_size < maze->pixels*bytes_per_pixel + (size_t)maze->padding*maze->height)
+	{
+		ret_val = ERRFILEFORMAT;
+		goto QUIT;
+	}
+
+#ifdef DEBUG
+	printf("Size of image data: %lu\n", file->data_size);
+#endif
+
+	// allocate memory to read in the image
+	maze->data = malloc(file->data_size);
+
+	if (maze->data == NULL)
+	{
+		ret_val = ERRFILEMEMORY;
+		goto QUIT;
+	}
+
+	// skip past the header
+	if (fseek(image_file, header_size, SEEK_SET))
+	{
+		ret_val = ERRFILEFORMAT;
+		goto FREE_QUIT;
+	}
+
+	// read the image
+	if (fread(maze->data, file->data_size, 1, image_file) == 0)
+	{
+		ret_val = ERRFILEREAD;
+		goto FREE_QUIT;
+	}
+
+	// throw away the unnecessary parts of the image
+	shrink_image(maze);
+
+	// reduce the image size after shrinking
+	unsigned char *shrunk_data = realloc(maze->data, maze->pixels*sizeof(unsigned char));
+	if (shrunk_data == NULL)
+	{
+		// Fail in case we couldn't shrink the memro (!?) to avoid unnecessarry overhead of function
+		// calls to identify the offset of a pixel in the data.
+		//
+		// If that overhead is not an issue, we could pass a function pointer to 'solve_maze' indicating
+		// how to find the pixel offset and thus handling this failure graciously.
+		ret_val = ERRFILEMEMORY;
+		goto FREE_QUIT;
+	}
+
+	maze->data = shrunk_data;
+	goto QUIT;
+
+FREE_QUIT:
+	free(maze->data);
+	maze->data = NULL;
+
+QUIT:
+	fclose(image_file);
+	return ret_val;
+}
+
+int write_maze_file(const char *const path, struct maze_file *const file, unsigned threads)
+{
+	struct maze_image *const maze = &file->maze;
+	static const long header_size = 54L;
+
+	if (file->rle != NULL)
+	{
+		FILE *const image_file = fopen(path, "r+");
+
+		if (image_file == NULL)
+		{
+			return ERRWRITE;
+		}
+
+		int ret_val = write_rle_maze(image_file, file);
+
+		if (fclose(image_file))
+		{
+			ret_val = ERRWRITE;
+		}
+
+		return ret_val;
+	}
+
+	// expand the memory to expand the data to BMP format
+	unsigned char *expanded_data = realloc(maze->data, file->data_size);
+	if (expanded_data == NULL)
+	{
+		// we have to fail because we are allowed to use fwrite only once
+		// So, the fallback technique of directly expanding in file is not possible.
+		return ERRFILEMEMORY;
+	}
+
+	maze->data = expanded_data;
+
+	if (threads == 0)
+	{
+		const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (processors > 0) ? processors : 1;
+	}
+
+	expand_data(maze, threads);
+
+	FILE *image_file = fopen(path, "r+");
+
+	if (image_file == NULL)
+	{
+		return ERRWRITE;
+	}
+
+	int ret_val = 0;
+
+	// seek to the start of image data and write the solution
+	if (fseek(image_file, header_size, SEEK_SET) ||
+	    fwrite(maze->data, file->data_size, 1, image_file) == 0)
+	{
+		ret_val = ERRWRITE;
+	}
+
+	if (fclose(image_file))
+	{
+		ret_val = ERRWRITE;
+	}
+
+	return ret_val;
+}
+
+void free_maze_file(struct maze_file *const file)
+{
+	free(file->maze.data);
+	free(file->rle);
+	file->maze.data = NULL;
+	file->rle = NULL;
+}
+
+const char *maze_error_message(int error)
+{
+	switch (error)
+	{
+		case 0:
+			return "Success";
+		case ERROPENINGS:
+			return "Could not find openings (start and end pixels) for the given image!";
+		case ERRMEMORY:
+			return "Could not solve maze due to insufficient memory!";
+		case ERRSHPATH:
+			return "Could not find shortest path from source to end in the given image!";
+		case ERRFILEOPEN:
+			return "Could not open the file!";
+		case ERRFILEFORMAT:
+			return "File format not as expected!";
+		case ERRFILEREAD:
+			return "Reading image failed!";
+		case ERRFILEMEMORY:
+			return "Not enough memory to read in or expand the image!";
+		case ERRWRITE:
+			return "Could not write the solved maze successfully to the file!";
+		case ERRGRAPHFILE:
+			return "Could not read or write the compiled graph of the maze (or it is of another maze)!";
+		case ERRFIELDFILE:
+			return "Could not write the distance field of the maze to the file!";
+		case ERRMAZESIZE:
+			return "The maze is too large for the costs of its paths using the given connectivity and weight!";
+		default:
+			return "Unknown error!";
+	}
+}
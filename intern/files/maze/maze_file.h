@@ -0,0 +1,68 @@
+#ifndef KS_MAZE_SOLVER_MAZE_FILE
+#define KS_MAZE_SOLVER_MAZE_FILE
+
+#include "maze_solver.h"
+
+/**
+ * Error codes
+ *
+ * These are distinct from the ones returned by 'solve_maze'.
+ */
+#define ERRFILEOPEN 8
+#define ERRFILEFORMAT 16
+#define ERRFILEREAD 32
+#define ERRFILEMEMORY 64
+#define ERRWRITE 128
+
+struct maze_file_rle;
+
+/**
+ * A maze read from a BMP file.
+ *
+ * maze      - the maze extracted from the image. Only the first byte of every
+ *             pixel is kept (see 'read_maze_file').
+ * data_size - the size of the image data (pixels and padding) in the file
+ *             (the size of the runs for an RLE compressed image)
+ * rle       - the headers and the palette of an RLE compressed image (NULL
+ *             for an uncompressed image)
+ */
+struct maze_file
+{
+	struct maze_image maze;
+	long data_size;
+	struct maze_file_rle *rle;
+};
+
+/**
+ * Read the maze in the BMP image found at 'path' into 'file'. The image
+ * data is shrunk to a byte per pixel after reading. The image is either
+ * uncompressed with 24 bits a pixel or RLE compressed (BI_RLE8 or BI_RLE4),
+ * whose runs are decoded straight into a byte per pixel as they are read.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ * On failure, no memory is held by 'file'.
+ */
+int read_maze_file(const char *const path, struct maze_file *const file);
+
+/**
+ * Expand the (solved) maze in 'file' back to the BMP format and write
+ * it into the image data of the BMP image found at 'path'. The image is
+ * expanded by at most 'threads' threads (0 for one a processor). An RLE
+ * compressed image is written back as an RLE8 compressed image instead.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+int write_maze_file(const char *const path, struct maze_file *const file, unsigned threads);
+
+/**
+ * Free the memory held by 'file'.
+ */
+void free_maze_file(struct maze_file *const file);
+
+/**
+ * Returns a message describing the given error code which could be
+ * one returned by 'solve_maze' or the functions above.
+ */
+const char *maze_error_message(int error);
+
+#endif
@@ -4,6 +4,12 @@
 #include "common.h"
 #include "maze_solver.h"
 #include "maze_solver_helpers.h"
+#include "cache/solution_cache.h"
+#include "grid/grid_file.h"
+#include "distance_field/distance_field.h"
+#include "fill/dead_end_fill.h"
+#include "plan/memory_plan.h"
+#include "stats/solver_stats.h"
 
 /**
  * Free the nodes (if any) in the shortest path queue when the shortest
@@ -17,9 +23,262 @@ static void free_sp_queue(struct sp_queue_head *sp)
 	}
 }
 
-int solve_maze(struct maze_image *const maze)
+void initialise_solver_options(struct maze_solver_options *const options)
+{
+	options->connectivity = CONNECTIVITY_4;
+	options->heuristic = HEURISTIC_MANHATTAN;
+	options->weight = 1.0;
+	options->anytime = 0;
+	options->time_budget = 0;
+	options->threads = 1;
+	options->fill = FILL_NONE;
+	options->mem_limit = 0;
+	options->huge_pages = 0;
+	options->on_solution = NULL;
+	options->solution_data = NULL;
+	options->cache = NULL;
+	options->graph_file = NULL;
+	options->distance_field = NULL;
+	options->start_row = -1;
+	options->start_col = -1;
+	options->stats = NULL;
+}
+
+/**
+ * The key of the solution of the maze found using the given options.
+ */
+static uint64_t solution_key(const struct maze_image *const maze,
+                             const struct maze_solver_options *const options)
+{
+	const uint32_t solver_options[] = {
+		options->connectivity,
+		options->heuristic,
+		(uint32_t)(options->weight*1000 + 0.5)
+	};
+
+	return solution_cache_hash(maze->hash, solver_options, sizeof(solver_options));
+}
+
+/**
+ * Map the compiled graph of the maze found in 'graph_file' and find the
+ * gates stored in it. The graph must have been compiled from a maze of the
+ * same dimensions (and the same pixels, when their hashes are known).
+ *
+ * Returns the grid on success and NULL on failure.
+ */
+static struct maze_grid *load_graph(const struct maze_image *const maze, const char *const graph_file,
+                                    struct openings **const gates)
+{
+	struct grid_file_info info;
+	int error;
+
+	struct maze_grid *const grid = map_grid_file(graph_file, &info, &error);
+
+	if (grid == NULL)
+	{
+		return NULL;
+	}
+
+	if (grid->width != maze->width || grid->height != maze->height ||
+	    (info.maze_hash != 0 && maze->hash != 0 && info.maze_hash != maze->hash) ||
+	    (*gates = malloc(sizeof(struct openings))) == NULL)
+	{
+		delete_graph(grid);
+		return NULL;
+	}
+
+	(*gates)->start_gate_pixel = info.start_pixel;
+	(*gates)->end_gate_pixel = info.end_pixel;
+
+#ifdef KS_MAZE_SOLVER_DEBUG
+	printf("load_graph: Mapped the graph compiled into %s\n", graph_file);
+#endif
+
+	return grid;
+}
+
+/**
+ * Find the path from the start pixel to the end gate by following the goal
+ * distance field kept in 'options->distance_field'. The field is built (and
+ * kept in the file) if the file doesn't hold the one for this maze. Without
+ * a file, the field is built and used only in memory.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+static int solve_using_field(struct maze_image *const maze, const struct openings *const gates,
+                             const struct maze_solver_options *const options)
+{
+	struct solver_stats *const stats = options->stats;
+	struct distance_field field;
+	int ret_val = 0;
+
+	solver_phase_begin(stats, PHASE_FIELD);
+
+	int status = (options->distance_field != NULL) ? read_distance_field(options->distance_field, &field)
+	                                               : ERRFIELDOPEN;
+
+	if (status == 0 &&
+	    (field.width != maze->width || field.height != maze->height ||
+	     field.goal_pixel != gates->end_gate_pixel ||
+	     (field.maze_hash != 0 && maze->hash != 0 && field.maze_hash != maze->hash)))
+	{
+		// the field of another maze
+		free_distance_field(&field);
+		status = ERRFIELDFORMAT;
+	}
+
+	if (status)
+	{
+
+#ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
+	printf("solve_using_field: Progress: Building the distance field of the maze ..\n");
+#endif
+
+		status = build_distance_field(maze, gates->end_gate_pixel, &field);
+
+		if (status)
+		{
+			solver_phase_end(stats, PHASE_FIELD);
+			return (status == ERRFIELDMEMORY) ? ERRMEMORY : ERRSHPATH;
+		}
+
+		if (options->distance_field != NULL && write_distance_field(options->distance_field, &field))
+		{
+			ret_val = ERRFIELDFILE;
+			goto FREE_FIELD;
+		}
+	}
+
+	struct sp_queue_head sp;
+	size_t length;
+
+	initialise_sp_queue(&sp);
+
+	size_t start_pixel = gates->start_gate_pixel;
+
+	if (options->start_row >= 0 && options->start_col >= 0)
+	{
+		// a pixel outside the maze is never reached
+		start_pixel = (options->start_row < maze->height && options->start_col < maze->width) ?
+		              (size_t)options->start_row*maze->width + options->start_col : maze->pixels;
+	}
+
+	status = distance_field_path(&field, start_pixel, &sp, &length);
+	solver_phase_end(stats, PHASE_FIELD);
+
+	if (status)
+	{
+		free_sp_queue(&sp);
+		ret_val = (status == ERRFIELDMEMORY) ? ERRMEMORY : ERRSHPATH;
+		goto FREE_FIELD;
+	}
+
+#ifdef KS_MAZE_SOLVER_DEBUG
+	printf("solve_using_field: Destination is %zu pixels away from the pixel %zu.\n", length, start_pixel);
+#endif
+
+	if (stats != NULL)
+	{
+		stats->path_length = length;
+		stats->cost = length;
+		stats->bytes_allocated += (maze->pixels + 63)/64*sizeof(uint64_t) + (maze->pixels + 3)/4 +
+		                          (length+1)*sizeof(struct sp_queue_elem);
+	}
+
+	solver_phase_begin(stats, PHASE_COLOUR);
+	colour_path(maze, &sp);
+	solver_phase_end(stats, PHASE_COLOUR);
+
+FREE_FIELD:
+	free_distance_field(&field);
+	return ret_val;
+}
+
+int compile_maze(struct maze_image *const maze, const char *const graph_file)
+{
+	int ret_val = 0;
+
+	maze->padding = find_padding(maze->width);
+
+	struct openings *const gates = find_openings(maze);
+
+	if (gates == NULL)
+	{
+		return ERROPENINGS;
+	}
+
+	struct maze_grid *const grid = create_graph(maze, NULL, GRID_STORAGE_HEAP);
+
+	if (grid == NULL)
+	{
+		ret_val = ERRMEMORY;
+		goto CLEANUP_GATES;
+	}
+
+	struct grid_file_info info;
+
+	info.start_pixel = gates->start_gate_pixel;
+	info.end_pixel = gates->end_gate_pixel;
+	info.maze_hash = maze->hash;
+
+	if (write_grid_file(graph_file, grid, &info))
+	{
+		ret_val = ERRGRAPHFILE;
+	}
+
+	delete_graph(grid);
+
+CLEANUP_GATES:
+	free(gates);
+	return ret_val;
+}
+
+/**
+ * Returns the number of pixels the end of the path in 'sp' is away from
+ * its start.
+ */
+static size_t path_length(const struct sp_queue_head *const sp)
+{
+	size_t pixels = 0;
+
+	for (const struct sp_queue_elem *elem = sp->first; elem != NULL; elem = elem->next)
+	{
+		pixels++;
+	}
+
+	return (pixels > 0) ? pixels-1 : 0;
+}
+
+/**
+ * Returns non-zero if the costs of the paths in the maze, along with the
+ * weighted estimates added to them, fit in the 32-bit distances of the grid
+ * (see 'a_star_costs_fit'). The clear pixels are counted only when the maze
+ * is too large for every pixel being clear.
+ */
+static int maze_costs_fit(const struct maze_image *const maze, const struct maze_solver_options *const options)
+{
+	if (a_star_costs_fit(maze->pixels, maze->width, maze->height, options->connectivity, options->weight))
+	{
+		return 1;
+	}
+
+	size_t clear_pixels = 0;
+
+	for (size_t pixel = 0; pixel < maze->pixels; pixel++)
+	{
+		clear_pixels += (maze->data[pixel] == CLEAR_PIXEL);
+	}
+
+	return a_star_costs_fit(clear_pixels, maze->width, maze->height, options->connectivity, options->weight);
+}
+
+/**
+ * Solve the maze using the given options (see 'solve_maze').
+ */
+static int solve(struct maze_image *const maze, const struct maze_solver_options *const options)
 {
 	int ret_val = 0;
+	struct solver_stats *const stats = options->stats;
 
 	// find the padding
 	maze->padding = find_padding(maze->width);
@@ -29,58 +288,208 @@ int solve_maze(struct maze_image *const maze)
 	printf("solve_maze: padding: %u bytes\n", maze->padding);
 
 	// find the image data size
-	const unsigned long image_data_size = (maze->height*maze->width*bytes_per_pixel) +
-					      (maze->padding*maze->height); // a way to find data size without file size
+	const size_t image_data_size = ((size_t)maze->height*maze->width*bytes_per_pixel) +
+	                               ((size_t)maze->padding*maze->height); // a way to find data size without file size
 
-	printf("solve_maze: Size of image data: %lu\n", image_data_size);
+	printf("solve_maze: Size of image data: %zu\n", image_data_size);
 #endif
 
-	struct openings *const gates = find_openings(maze);
+	struct maze_grid *grid = NULL;
+	struct openings *gates;
 
-	if (gates == NULL)
+	if (options->graph_file != NULL)
 	{
-		return ERROPENINGS;
+		if (!maze_costs_fit(maze, options))
+		{
+			return ERRMAZESIZE;
+		}
+
+		// the maze has been compiled; the grid and the gates are found in the file
+		solver_phase_begin(stats, PHASE_GRAPH);
+		grid = load_graph(maze, options->graph_file, &gates);
+		solver_phase_end(stats, PHASE_GRAPH);
+
+		if (grid == NULL)
+		{
+			return ERRGRAPHFILE;
+		}
+	}
+	else
+	{
+		solver_phase_begin(stats, PHASE_GATES);
+		gates = find_openings(maze);
+		solver_phase_end(stats, PHASE_GATES);
+
+		if (gates == NULL)
+		{
+			return ERROPENINGS;
+		}
+
+		if (options->distance_field != NULL)
+		{
+			ret_val = solve_using_field(maze, gates, options);
+			goto CLEANUP_GATES;
+		}
 	}
 
 #ifdef KS_MAZE_SOLVER_DEBUG
-	printf("solve_maze: Start gate pixel: %u\t End gate pixel: %u\n",
+	printf("solve_maze: Start gate pixel: %zu\t End gate pixel: %zu\n",
 		gates->start_gate_pixel, gates->end_gate_pixel);
 #endif
 
-#ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
-	printf("solve_maze: Progress: Graph creation for the maze ...\n");
-#endif
+	// the queue that holds the shortest path
+	struct sp_queue_head *const sp = malloc(sizeof(struct sp_queue_head));
 
-	if (create_graph(maze, gates))
+	if (sp == NULL)
 	{
 		ret_val = ERRMEMORY;
-		goto CLEANUP_GRAPH;
+		goto CLEANUP_GATES;
 	}
 
+	initialise_sp_queue(sp);
+
+	struct solution_cache *const cache = (options->anytime || maze->hash == 0) ? NULL : options->cache;
+	const uint64_t key = (cache != NULL) ? solution_key(maze, options) : 0;
+
+	int cache_status = ERRCACHEMISS;
+
+	if (cache != NULL)
+	{
+		solver_phase_begin(stats, PHASE_CACHE);
+		cache_status = solution_cache_lookup(cache, key, maze, sp);
+		solver_phase_end(stats, PHASE_CACHE);
+	}
+
+	if (cache_status == 0)
+	{
+
 #ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
-	printf("solve_maze: Progress: Graph generated successfully for the maze.\n");
+	printf("solve_maze: Progress: Found the shortest path in the solution cache.\n");
 #endif
 
-	// find the shortest path to the end node from the source node
-	// for the constructed graph
-	struct sp_queue_head *const sp = malloc(sizeof(struct sp_queue_head));
+		if (stats != NULL)
+		{
+			stats->cached = 1;
+			stats->path_length = path_length(sp);
+		}
 
-	if (sp == NULL)
+		solver_phase_begin(stats, PHASE_COLOUR);
+		colour_path(maze, sp);
+		solver_phase_end(stats, PHASE_COLOUR);
+		goto CLEANUP;
+	}
+
+	if (grid == NULL)
 	{
-		ret_val = ERRMEMORY;
-		goto CLEANUP_GRAPH;
+		// checked before the grid is created; the pixels filled are still counted
+		if (!maze_costs_fit(maze, options))
+		{
+			ret_val = ERRMAZESIZE;
+			goto CLEANUP;
+		}
+
+		struct memory_plan plan;
+		const size_t detected_limit = (options->mem_limit == 0) ? detect_memory_limit() : 0;
+
+		solver_phase_begin(stats, PHASE_PLAN);
+		plan_memory(maze, options, (options->mem_limit != 0) ? options->mem_limit :
+		                           (detected_limit != 0) ? detected_limit : SIZE_MAX, &plan);
+		solver_phase_end(stats, PHASE_PLAN);
+
+#ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
+	if (plan.representation != PLAN_NONE)
+	{
+		printf("solve_maze: Progress: Using the %s (%zu of %zu MiB).\n",
+		       plan_representation_name(plan.representation),
+		       plan.estimates[plan.representation] >> 20, plan.limit >> 20);
 	}
+#endif
 
-	initialise_sp_queue(sp);
+		if (plan.representation == PLAN_NONE)
+		{
+#ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
+	printf("solve_maze: No representation of the maze fits in %zu MiB.\n", plan.limit >> 20);
+#endif
+			ret_val = ERRMEMORY;
+			goto CLEANUP;
+		}
+		else if (plan.representation == PLAN_FIELD)
+		{
+			ret_val = solve_using_field(maze, gates, options);
+			goto CLEANUP;
+		}
+
+		const enum grid_storage storage = (plan.representation == PLAN_GRID_FILE) ? GRID_STORAGE_FILE :
+		                                  options->huge_pages ? GRID_STORAGE_HUGE_PAGES : GRID_STORAGE_HEAP;
+
+#ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
+	printf("solve_maze: Progress: Graph creation for the maze ...\n");
+#endif
+
+		if (options->fill != FILL_NONE)
+		{
+			struct open_pixels open;
+			struct fill_stats filled;
+
+			solver_phase_begin(stats, PHASE_FILL);
+			const int fill_status = fill_dead_ends(maze, gates, options->connectivity, options->fill,
+			                                       &open, &filled);
+			solver_phase_end(stats, PHASE_FILL);
+
+			if (fill_status)
+			{
+				ret_val = ERRMEMORY;
+				goto CLEANUP;
+			}
+
+#ifdef KS_MAZE_SOLVER_DEBUG
+	printf("solve_maze: Filled %zu of %zu clear pixels (%zu in rooms) in %u passes.\n",
+	       filled.filled_pixels, filled.clear_pixels, filled.room_pixels, filled.passes);
+#endif
+
+			solver_stats_allocated(stats, open.row_words*open.height*sizeof(uint64_t));
+
+			solver_phase_begin(stats, PHASE_GRAPH);
+			grid = create_graph(maze, &open, storage);
+			solver_phase_end(stats, PHASE_GRAPH);
+			free_open_pixels(&open);
+		}
+		else
+		{
+			solver_phase_begin(stats, PHASE_GRAPH);
+			grid = create_graph(maze, NULL, storage);
+			solver_phase_end(stats, PHASE_GRAPH);
+		}
+
+		if (grid == NULL)
+		{
+			ret_val = ERRMEMORY;
+			goto CLEANUP;
+		}
+
+		solver_stats_allocated(stats, grid_bytes(grid));
+
+#ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
+	printf("solve_maze: Progress: Graph generated successfully for the maze.\n");
+#endif
 
+	}
+
+	// find the shortest path to the end node from the source node
+	// for the constructed graph
 #ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
 	printf("solve_maze: Progress: Shortest path to destination using the graph ..\n");
 #endif
 
-	unsigned dest_distance = find_shortest_path(gates, sp);
+	size_t dest_distance = find_shortest_path(grid, gates, options, sp);
 
 	if (dest_distance != 0)
 	{
+		if (cache != NULL)
+		{
+			// a failure only means that the maze would be solved again the next time
+			solution_cache_store(cache, key, maze, sp);
+		}
 
 #ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
 	printf("solve_maze: Progress: Shortest path generated successfully.\n");
@@ -88,7 +497,7 @@ int solve_maze(struct maze_image *const maze)
 
 #ifdef KS_MAZE_SOLVER_DEBUG_PRINT_SHORTEST_PATH
 		// Warning: This removes the items from the queue!
-		printf("Shortest path from %u to %u:\n", gates->start_gate_pixel, gates->end_gate_pixel);
+		printf("Shortest path from %zu to %zu:\n", gates->start_gate_pixel, gates->end_gate_pixel);
 
 		while (!sp_queue_empty(sp))
 		{
@@ -100,7 +509,7 @@ int solve_maze(struct maze_image *const maze)
 				exit(EXIT_FAILURE);
 			}
 
-			printf("%u\t", curr_elem->elem);
+			printf("%zu\t", curr_elem->elem);
 			fflush(stdout);
 			free(curr_elem);
 		}
@@ -112,7 +521,9 @@ int solve_maze(struct maze_image *const maze)
 	printf("solve_maze: Progress: Colour the shortest path ..\n");
 #endif
 
+		solver_phase_begin(stats, PHASE_COLOUR);
 		colour_path(maze, sp);
+		solver_phase_end(stats, PHASE_COLOUR);
 
 #ifdef KS_MAZE_SOLVER_DEBUG_PROGRESS
 	printf("solve_maze: Progress: Colouring of shortest path completed.\n");
@@ -132,8 +543,33 @@ CLEANUP:
 	// free the queue head
 	free(sp);
 
-CLEANUP_GRAPH:
-	delete_graph();
+CLEANUP_GATES:
+	delete_graph(grid);
 	free(gates);
 	return ret_val;
 }
+
+int solve_maze(struct maze_image *const maze, const struct maze_solver_options *options)
+{
+	struct maze_solver_options default_options;
+
+	if (options == NULL)
+	{
+		initialise_solver_options(&default_options);
+		options = &default_options;
+	}
+
+	if (options->stats != NULL)
+	{
+		reset_solver_stats(options->stats);
+	}
+
+	const int ret_val = solve(maze, options);
+
+	if (options->stats != NULL)
+	{
+		options->stats->seconds = solver_stats_seconds(options->stats);
+	}
+
+	return ret_val;
+}
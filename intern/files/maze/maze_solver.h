@@ -8,19 +8,117 @@
 #define ERROPENINGS 1
 #define ERRMEMORY 2
 #define ERRSHPATH 4
+#define ERRGRAPHFILE 256 // above the codes used for the image files (see maze_file.h)
+#define ERRFIELDFILE 512
+#define ERRMAZESIZE 1024
+
+#include <stddef.h>
+#include <stdint.h>
+#include "a_star/a_star.h"
+
+struct solution_cache;
+struct solver_stats;
+
+/**
+ * The pixels filled before the graph of the maze is created
+ * (see "fill/dead_end_fill.h").
+ */
+enum maze_fill
+{
+	FILL_NONE,
+	FILL_DEAD_ENDS,
+	FILL_ROOMS  // dead ends and the corners of open areas
+};
 
 // Type of each byte in the maze
 typedef unsigned char maze_type;
 
+/**
+ * The pixels of a maze are indexed in row-major order (row*width + col).
+ * The index (and the number of pixels) needs 64 bits for a maze with more
+ * than 4G pixels, so it is a 'size_t'. The rows and columns themselves fit
+ * in an 'unsigned'.
+ */
 struct maze_image
 {
 	maze_type *data;
-	unsigned pixels;
+	size_t pixels;
 	unsigned width;
 	unsigned height;
 	unsigned char padding:2;
+	uint64_t hash; // hash of the pixels used by the solution cache (0 if unknown)
+};
+
+/**
+ * The options that control how the maze is solved.
+ *
+ * connectivity - the pixels a pixel could move to (default: CONNECTIVITY_4)
+ * heuristic    - the heuristic used by the A-star search (default: HEURISTIC_MANHATTAN).
+ *                HEURISTIC_MANHATTAN overestimates the cost with CONNECTIVITY_8,
+ *                so HEURISTIC_OCTILE should be used with it for a shortest path.
+ * weight       - the weight of the heuristic (default: 1, i.e., a shortest path)
+ * anytime      - non-zero to find a path quickly using the weight and then keep
+ *                improving it (default: 0)
+ * time_budget  - seconds the anytime search could spend improving the path
+ *                (default: 0, i.e., until a shortest path is found)
+ * threads      - number of threads that search for the path in parallel
+ *                (default: 1)
+ * fill         - the pixels that are filled before creating the graph to
+ *                reduce the pixels searched. The length of the shortest path
+ *                doesn't change (default: FILL_NONE). Nothing is filled when
+ *                the graph or the distance field is found in a file.
+ * mem_limit    - bytes of memory the solver could use. The representation of
+ *                the maze searched is chosen to fit in it (see
+ *                "plan/memory_plan.h"). 0 to use the limit of the cgroup or
+ *                the physical memory (default: 0).
+ * huge_pages   - non-zero to advise the kernel to use transparent huge pages
+ *                for the arrays of the grid (default: 0)
+ * on_solution  - called with every path found along with 'solution_data'
+ *                (default: NULL)
+ * cache        - the cache of solutions to look up (using the hash of the
+ *                maze) before searching and to store the path found in
+ *                (default: NULL). It isn't used by the anytime search whose
+ *                result depends on the time it could spend.
+ * graph_file   - the graph of the maze compiled using 'compile_maze'. It is
+ *                mapped into memory instead of creating the graph (default: NULL).
+ * distance_field - the file holding the goal distance field of the maze (see
+ *                "distance_field/distance_field.h"). The path is found by
+ *                following the field instead of searching. The field is
+ *                created and written to the file when the file doesn't hold
+ *                the field of the maze (default: NULL).
+ * (start_row, start_col) - the pixel the path found using the distance field
+ *                starts from (default: (-1, -1), i.e., the start gate)
+ * stats        - filled in with the statistics of the run (see
+ *                "stats/solver_stats.h") when not NULL. It must not be shared
+ *                by mazes solved at the same time (default: NULL).
+ *
+ * See "a_star/a_star.h" for the details of the weighted and anytime searches.
+ */
+struct maze_solver_options
+{
+	enum maze_connectivity connectivity;
+	enum maze_heuristic heuristic;
+	double weight;
+	int anytime;
+	double time_budget;
+	unsigned threads;
+	enum maze_fill fill;
+	size_t mem_limit;
+	int huge_pages;
+	void (*on_solution)(const struct a_star_solution *const solution, void *const solution_data);
+	void *solution_data;
+	struct solution_cache *cache;
+	const char *graph_file;
+	const char *distance_field;
+	long start_row, start_col;
+	struct solver_stats *stats;
 };
 
+/**
+ * Initialise the given options to their defaults.
+ */
+void initialise_solver_options(struct maze_solver_options *const options);
+
 /**
  * Solve the given maze by finding the shortest path from the start gate to the end gate.
  *
@@ -37,9 +135,24 @@ struct maze_image
  *
  * (width, height) - dimension of the BMP image
  *
+ * options - the options to use for solving the maze. The defaults are used
+ *           when it is NULL.
+ *
  * Returns 0 on success and a non-zero value indicating the error on failure.
  * Returns the solved maze in the input itself. Setting the path in a distinct color.
  */
-int solve_maze(struct maze_image *const maze);
+int solve_maze(struct maze_image *const maze, const struct maze_solver_options *options);
+
+/**
+ * Compile the given maze: find its gates, create its graph and write them
+ * into 'graph_file' in a form that could be mapped into memory and searched
+ * right away (see "grid/grid_file.h" and the 'graph_file' option).
+ *
+ * The graph depends on the layout of the grid that the solver was built
+ * with. So, it could be used only by a solver built with the same layout.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+int compile_maze(struct maze_image *const maze, const char *const graph_file);
 
 #endif
@@ -3,16 +3,12 @@
 #include "common.h"
 #include "bmp/bmp_helpers.h"
 #include "maze_solver_helpers.h"
-#include "maze_graph_bridge.h"
+#include "a_star/a_star.h"
 #include "a_star/frontier/pqueue.h"
-#include "../../my_math/math.h"
-
-#if defined KS_MAZE_SOLVER_DEBUG || defined KS_MAZE_SOLVER_DEBUG_FIND_SHORTEST_PATH
-#include <stdio.h>
-#endif
+#include "stats/solver_stats.h"
 
 #ifdef KS_MAZE_SOLVER_DEBUG
-#include <limits.h>
+#include <stdio.h>
 #endif
 
 #ifdef KS_MAZE_SOLVER_DEBUG
@@ -21,13 +17,13 @@
  * Else returns 0.
  */
 inline static
-int is_hurdle_pixel(struct maze_image *const maze, unsigned pixel)
+int is_hurdle_pixel(struct maze_image *const maze, size_t pixel)
 {
 
 #ifdef KS_MAZE_SOLVER_DEBUG
 	if (pixel >= maze->pixels)
 	{
-		fprintf(stderr, "is_hurdle_pixel: Invalid pixel %u\n", pixel);
+		fprintf(stderr, "is_hurdle_pixel: Invalid pixel %zu\n", pixel);
 		exit(EXIT_FAILURE);
 	}
 #endif
@@ -47,7 +43,7 @@ int is_hurdle_pixel(struct maze_image *const maze, unsigned pixel)
  *       (This is done to simplify adjacency initialization logic)
  */
 inline static
-int is_clear_pixel(struct maze_image *const maze, unsigned pixel)
+int is_clear_pixel(struct maze_image *const maze, size_t pixel)
 {
 
 	if (pixel >= maze->pixels)
@@ -68,7 +64,7 @@ int is_clear_pixel(struct maze_image *const maze, unsigned pixel)
  * If one is not found returns -1;
  */
 static
-long find_gate(struct maze_image *const maze, unsigned start_pixel, unsigned end_pixel)
+long find_gate(struct maze_image *const maze, size_t start_pixel, size_t end_pixel)
 {
 	long gate = -1;
 
@@ -77,7 +73,7 @@ long find_gate(struct maze_image *const maze, unsigned start_pixel, unsigned end
 #endif
 
 	// find the pixel of the start gate
-	for (unsigned pixel = start_pixel; pixel<=end_pixel; pixel++)
+	for (size_t pixel = start_pixel; pixel<=end_pixel; pixel++)
 	{
 		unsigned char *const pixel_ptr = maze->data + pixel;
 
@@ -117,7 +113,7 @@ struct openings *find_openings(struct maze_image *const maze)
 	}
 
 	long start_gate_pixel = find_gate(maze, 0, maze->width-1),
-	     end_gate_pixel = find_gate(maze, (maze->width)*(maze->height-1), maze->pixels-1);
+	     end_gate_pixel = find_gate(maze, (size_t)maze->width*(maze->height-1), maze->pixels-1);
 
 	if (start_gate_pixel == -1 || end_gate_pixel == -1)
 	{
@@ -132,7 +128,7 @@ struct openings *find_openings(struct maze_image *const maze)
 #ifdef KS_MAZE_SOLVER_DEBUG
 void print_ascii_maze(struct maze_image *const maze)
 {
-	for (unsigned pixel=0; pixel<maze->pixels; pixel++)
+	for (size_t pixel=0; pixel<maze->pixels; pixel++)
 	{
 		if (pixel%maze->width == 0)
 		{
@@ -158,160 +154,44 @@ void print_ascii_maze(struct maze_image *const maze)
 }
 #endif
 
-/**
- * Manhattan distance heuristic for A-star.
- */
-static inline
-unsigned m_dist(const int x1, const int y1,
-                const int x2, const int y2)
-{
-
-#ifdef KS_MAZE_SOLVER_DEBUG_MANHATTAN_DISTANCE
-	printf("m_dist: x1: %d, y1: %d; x2: %d, y2: %d\n", x1, y1, x2, y2);
-#endif
-
-	return math_abs(x2-x1)+math_abs(y2-y1);
-}
-
-int create_graph(struct maze_image *const maze, struct openings *gates)
+struct maze_grid *create_graph(struct maze_image *const maze, const struct open_pixels *const open,
+                               enum grid_storage storage)
 {
 
 	if (maze == NULL)
 	{
-		return 1;
+		return NULL;
 	}
 
-	const unsigned goal_row = gates->end_gate_pixel/maze->width,
-	               goal_col = gates->end_gate_pixel%maze->width;
+	struct maze_grid *const grid = create_grid(maze->width, maze->height, storage);
 
+	if (grid == NULL)
+	{
+		return NULL;
+	}
 
 #ifdef KS_MAZE_SOLVER_DEBUG
-	printf("create_graph: sizeof(struct node): %zu\n", sizeof(struct node));
-	printf("create_graph: sizeof(struct adj_list): %zu\n", sizeof(struct adj_list));
-	printf("create_graph: sizeof(struct node_list): %zu\n", sizeof(struct node_list));
+	printf("create_graph: sizeof(struct maze_grid): %zu\n", sizeof(struct maze_grid));
+	printf("create_graph: cells in the grid: %zu\n", grid->cells);
 
-	unsigned clear_pixels=0;
+	size_t clear_pixels=0;
 #endif
 
 	for (unsigned curr_row = 0; curr_row < maze->height; curr_row++)
 	{
 		for (unsigned curr_col = 0; curr_col < maze->width; curr_col++)
 		{
-			const unsigned curr_pixel = (curr_row * maze->width) + curr_col;
+			const size_t curr_pixel = ((size_t)curr_row * maze->width) + curr_col;
 
-			if (is_clear_pixel(maze, curr_pixel))
+			if (is_clear_pixel(maze, curr_pixel) &&
+			    (open == NULL || is_open_pixel(open, curr_row, curr_col)))
 			{
-				/* Create the node */
-				struct node *const n = calloc(1, sizeof(struct node));
 
-				if (n == NULL)
-				{
 #ifdef KS_MAZE_SOLVER_DEBUG_CREATE_GRAPH
-					fprintf(stderr, "create_graph: 'create_node' failed for pixel: %u\n", curr_pixel);
-#endif
-
-				return 1;
-				}
-
-				n->pixel = curr_pixel;
-				n->adjlist.adjs = NULL; // possibly not necessary as calloc is used, just in case
-				n->pi = NULL;
-
-				// insert the node into the 'np_list'
-				if (insert_node(n))
-				{
-
-#ifdef KS_MAZE_SOLVER_DEBUG_CREATE_GRAPH
-					fprintf(stderr, "create_graph: 'insert_node' failed for pixel: %u\n", curr_pixel);
-#endif
-
-					return 1;
-				}
-
-#ifdef KS_MAZE_SOLVER_DEBUG_CREATE_GRAPH
-				printf("create_graph: node value: %u\n", n->pixel);
-#endif
-
-				/* Initialise adjacencies */
-
-				// This is not an issue for the start pixel which is in the first row as the
-				// is_clear_pixel() funtion would return 0 for out-of-bound values.
-				const unsigned left = curr_pixel - 1,
-				               top  = curr_pixel - maze->width;
-
-				if (is_clear_pixel(maze, left))
-				{
-
-#ifdef KS_MAZE_SOLVER_DEBUG_INITIALIZE_ADJACENCIES
-					printf("initialize_adjacencies: Found adjacencies %u and %u\n",
-					       curr_pixel, left);
+				printf("create_graph: clear pixel: %zu\n", curr_pixel);
 #endif
 
-					// optimize this using a node_list "cache"
-					struct node *const left_node = get_node(left);
-
-#ifdef KS_MAZE_SOLVER_DEBUG
-					if (left_node == NULL)
-					{
-						fprintf(stderr, "initialize_adjacencies: Invalid left node: %u for current clear pixel: %u\n",
-						        left, curr_pixel);
-						exit(EXIT_FAILURE);
-					}
-#endif
-
-					if (add_adjacency(n, left_node))
-					{
-						return 1;
-					}
-				}
-
-				if (is_clear_pixel(maze, top))
-				{
-
-#ifdef KS_MAZE_SOLVER_DEBUG_INITIALIZE_ADJACENCIES
-					printf("initialize_adjacencies: Found adjacencies %u and %u\n",
-					       curr_pixel, top);
-#endif
-
-					struct node *const top_node = get_node(top);
-
-#ifdef KS_MAZE_SOLVER_DEBUG
-					if (top_node == NULL)
-					{
-						fprintf(stderr, "initialize_adjacencies: Invalid top node: %u for current clear pixel: %u\n",
-						        top, curr_pixel);
-						exit(EXIT_FAILURE);
-					}
-#endif
-
-					if (add_adjacency(n, top_node))
-					{
-						return 1;
-					}
-				}
-
-				/*
-				 * Initialize nodes with manhattan distance to destination as heuristic value
-				 * for A-star algorithm.
-				 */
-
-#ifdef KS_MAZE_SOLVER_DEBUG
-				if (curr_row > INT_MAX ||
-				    curr_col > INT_MAX ||
-				    goal_row > INT_MAX ||
-				    goal_col > INT_MAX)
-				{
-					fprintf(stderr, "initialize_nodes: integer overflow\n");
-					fprintf(stderr, "initialize_nodes: co-ordinates don't fit into an 'int'\n");
-					exit(EXIT_FAILURE);
-				}
-#endif
-
-#ifdef KS_MAZE_SOLVER_DEBUG_MANHATTAN_DISTANCE
-				printf("initialize_nodes: finding manhattan distance for pixel: %u\n", curr_pixel);
-#endif
-
-				n->heuristic = m_dist(curr_row, curr_col, goal_row, goal_col);
+				grid_set_clear(grid, grid_cell(grid, curr_row, curr_col));
 
 #ifdef KS_MAZE_SOLVER_DEBUG
 				clear_pixels++;
@@ -321,37 +201,29 @@ int create_graph(struct maze_image *const maze, struct openings *gates)
 	}
 
 #ifdef KS_MAZE_SOLVER_DEBUG
-	printf("create_graph: Totally found %u clear pixels\n", clear_pixels);
+	printf("create_graph: Totally found %zu clear pixels\n", clear_pixels);
 #endif
 
-	return 0;
+	return grid;
 }
 
 /**
- * Construct the shortest path from the values of the predecessor of each node
- * starting from the end node.
+ * Construct the shortest path from the values of the predecessor of each pixel
+ * starting from the end pixel.
  *
- * Returns the distance of the end node from the start node on success and 0 in case
- * of an error.
+ * Returns the number of pixels the end pixel is away from the start pixel on
+ * success and 0 in case of an error.
  */
 static
-int construct_shortest_path(struct openings *const gates, struct sp_queue_head *const sp)
+size_t construct_shortest_path(struct maze_grid *const grid, struct openings *const gates,
+                               struct sp_queue_head *const sp)
 {
-	struct node *path_node = get_node(gates->end_gate_pixel);
+	unsigned path_row = gates->end_gate_pixel/grid->width,
+	         path_col = gates->end_gate_pixel%grid->width;
+	size_t path_pixels = 0;
 
-#ifdef KS_MAZE_SOLVER_DEBUG
-	if (path_node == NULL)
-	{
-		fprintf(stderr, "construct_shortest_path: Invalid pixel node.\n");
-		exit(EXIT_FAILURE);
-	}
-#endif
-
-	const unsigned dest_dist = path_node->src_dist;
 #ifdef KS_MAZE_SOLVER_DEBUG
 	printf("construct_shortest_path: sizeof(struct sp_queue_elem): %zu\n", sizeof(struct sp_queue_elem));
-
-	printf("construct_shortest_path: Destination is %u pixels away from the source.\n", dest_dist);
 #endif
 
 	// sanity check
@@ -360,9 +232,12 @@ int construct_shortest_path(struct openings *const gates, struct sp_queue_head *
 		return 0;
 	}
 
-	while (path_node->pi != NULL)
+	// the source pixel is the only one without a predecessor
+	enum grid_direction parent_dir = GRID_DIR_NONE;
+
+	do
 	{
-		// insert the current path node
+		// insert the current path pixel
 		struct sp_queue_elem *const path_elem = malloc(sizeof(struct sp_queue_elem));
 
 		if (path_elem == NULL)
@@ -370,217 +245,110 @@ int construct_shortest_path(struct openings *const gates, struct sp_queue_head *
 			return 0;
 		}
 
-		path_elem->elem = path_node->pixel;
+		path_elem->elem = (size_t)path_row*grid->width + path_col;
 
 #ifdef KS_MAZE_SOLVER_DEBUG
 		if (sp_insert_elem(sp, path_elem))
 		{
-			fprintf(stderr, "construct_shortest_path: Inserting %u into shortest path queue failed!", path_elem->elem);
+			fprintf(stderr, "construct_shortest_path: Inserting %zu into shortest path queue failed!", path_elem->elem);
 			exit(EXIT_FAILURE);
 		}
 #else
 		sp_insert_elem(sp, path_elem);
 #endif
 
-		path_node = path_node->pi;
-	}
-
-	// insert the source node
-	struct sp_queue_elem *const source_elem = malloc(sizeof(struct sp_queue_elem));
-
-	if (source_elem == NULL)
-	{
-		return 0;
-	}
-
-	source_elem->elem = path_node->pixel;
+		parent_dir = grid->parent[grid_cell(grid, path_row, path_col)];
+		path_row += grid_dir_row[parent_dir];
+		path_col += grid_dir_col[parent_dir];
+		path_pixels++;
+	} while (parent_dir != GRID_DIR_NONE);
 
 #ifdef KS_MAZE_SOLVER_DEBUG
-	if (sp_insert_elem(sp, source_elem))
-	{
-		fprintf(stderr, "construct_shortest_path: Inserting into shortest path queue failed!");
-		exit(EXIT_FAILURE);
-	}
-#else
-	sp_insert_elem(sp, source_elem);
+	printf("construct_shortest_path: Destination is %zu pixels away from the source.\n", path_pixels-1);
 #endif
 
-	return dest_dist;
+	return path_pixels-1;
 }
 
-unsigned find_shortest_path(struct openings *const gates, struct sp_queue_head *sp)
+size_t find_shortest_path(struct maze_grid *const grid, struct openings *const gates,
+                          const struct maze_solver_options *const options,
+                          struct sp_queue_head *sp)
 {
-	struct node *const start_node = get_node(gates->start_gate_pixel);
-
-#ifdef KS_MAZE_SOLVER_DEBUG
-	if (start_node == NULL)
-	{
-		fprintf(stderr, "construct_shortest_path: Invalid pixel node.\n");
-		exit(EXIT_FAILURE);
-	}
-
-	unsigned nodes_expanded = 0;
-#endif
-
-	bool found_dest = false, out_of_mem = false;
-
-	// initial setup
-	start_node->colour = IN_FRONTIER;
-
-	// create the frotier queue head
-	struct min_heap *const frontier = malloc(sizeof(struct min_heap));
+	struct a_star_search search;
+
+	initialise_a_star_search(&search);
+	search.grid = grid;
+	search.start_row = gates->start_gate_pixel/grid->width;
+	search.start_col = gates->start_gate_pixel%grid->width;
+	search.goal_row = gates->end_gate_pixel/grid->width;
+	search.goal_col = gates->end_gate_pixel%grid->width;
+	search.connectivity = options->connectivity;
+	search.heuristic = options->heuristic;
+	search.weight = options->weight;
+	search.anytime = options->anytime;
+	search.time_budget = options->time_budget;
+	search.threads = options->threads;
+	search.on_solution = options->on_solution;
+	search.solution_data = options->solution_data;
 
 #ifdef KS_MAZE_SOLVER_DEBUG
 	printf("find_shortest_path: sizeof(struct min_heap): %zu\n", sizeof(struct min_heap));
 	printf("find_shortest_path: sizeof(struct heap_elem): %zu\n", sizeof(struct heap_elem));
 #endif
 
-	if (frontier == NULL)
-	{
-		return 0;
-	}
-
-	initialise_min_heap(frontier);
+	struct solver_stats *const stats = options->stats;
 
-	// insert the start node into the frontier
-	struct heap_elem *const first = malloc(sizeof(struct heap_elem));
+	solver_phase_begin(stats, PHASE_SEARCH);
+	const int search_status = a_star_search(&search);
+	solver_phase_end(stats, PHASE_SEARCH);
 
-	if (first == NULL)
+	if (stats != NULL)
 	{
-		out_of_mem = true;
-		goto CLEANUP;
+		stats->nodes_expanded = search.nodes_expanded;
+		stats->nodes_generated = search.nodes_generated;
+		stats->frontier_peak = search.frontier_peak;
+		stats->bytes_allocated += search.frontier_peak*sizeof(struct heap_elem);
 	}
 
-	first->val = start_node;
-	first->key = start_node->heuristic;
-
 #ifdef KS_MAZE_SOLVER_DEBUG
-	if (min_heap_insert(frontier, first))
-	{
-		fprintf(stderr, "find_shortest_path: Inserting into the queue failed!\n");
-		exit(EXIT_FAILURE);
-	}
-#else
-	min_heap_insert(frontier, first);
+	printf("find_shortest_path: Totally expanded %zu nodes.\n", search.nodes_expanded);
 #endif
 
-	while (!min_heap_empty(frontier))
+	if (search_status)
 	{
-		struct heap_elem *const curr_elem = extract_min(frontier);
-
-#ifdef KS_MAZE_SOLVER_DEBUG
-		if (curr_elem == NULL)
-		{
-			fprintf(stderr, "find_shortest_path: Removing from the queue failed!\n");
-			exit(EXIT_FAILURE);
-		}
-#endif
-
-		// stop expanding and just free obtained memory when,
-		//
-		//   i) destination has been found (or)
-		//  ii) memory issue occurs
-		//
-		if (!(found_dest | out_of_mem)) {
-
-			struct node *const curr = curr_elem->val;
-
-			for (unsigned adj=0; adj<curr->adjlist.num; adj++)
-			{
-				struct node *curr_adj = *(curr->adjlist.adjs + adj);
-
-				if (curr_adj->colour == NOT_VISITED)
-				{
-					// set the attributes
-					curr_adj->colour = IN_FRONTIER;
-					curr_adj->src_dist = curr->src_dist+1;
-					curr_adj->pi = curr;
-
-					// insert the element into the frontier
-					struct heap_elem *const adj_elem = malloc(sizeof(struct heap_elem));
-
-					if (adj_elem == NULL)
-					{
-						out_of_mem = true;
-						break;
-					}
-
-					adj_elem->val = curr_adj;
-					adj_elem->key = curr_adj->src_dist + curr_adj->heuristic;
-
-#ifdef KS_MAZE_SOLVER_DEBUG_FIND_SHORTEST_PATH
-					printf("find_shortest_path: heuristic (tie breaker): %u key: %u for pixel: %u\n",
-						curr_adj->heuristic, adj_elem->key, curr_adj->pixel);
-#endif
-
-#ifdef KS_MAZE_SOLVER_DEBUG
-					if (min_heap_insert(frontier, adj_elem))
-					{
-						fprintf(stderr, "find_shortest_path: Inserting into the BFS queue failed!");
-						exit(EXIT_FAILURE);
-					}
-#else
-					min_heap_insert(frontier, adj_elem);
-#endif
-
-					if (curr_adj->pixel == gates->end_gate_pixel)
-					{
-						found_dest = true;
-						break;
-					}
-				}
-			}
-
-			curr->colour = VISITIED;
-
-#ifdef KS_MAZE_SOLVER_DEBUG
-			nodes_expanded++;
-#endif
-		}
-
-		free(curr_elem);
+		return 0;
 	}
 
 #ifdef KS_MAZE_SOLVER_DEBUG
-	printf("find_shortest_path: Totally expanded %u nodes.\n", nodes_expanded);
+	printf("find_shortest_path: Cost of the path: %u\n",
+	       grid->dist[grid_cell(grid, search.goal_row, search.goal_col)]);
 #endif
 
-CLEANUP:
-	// free the queue head
-	free(frontier);
+	// construct the shortest path from the values of the predecessors
+	solver_phase_begin(stats, PHASE_PATH);
+	const size_t path_length = construct_shortest_path(grid, gates, sp);
+	solver_phase_end(stats, PHASE_PATH);
 
-	if (out_of_mem)
+	if (stats != NULL && path_length != 0)
 	{
-		return 0;
+		stats->path_length = path_length;
+		stats->cost = search.solution.cost;
+		stats->bytes_allocated += (path_length+1)*sizeof(struct sp_queue_elem);
 	}
 
-	// construct the shortest path from the values of the predecessors
-	return construct_shortest_path(gates, sp);
+	return path_length;
 }
 
-void delete_graph(void)
+void delete_graph(struct maze_grid *const grid)
 {
-	if (np_list == NULL)
-	{
-		return;
-	}
-
-	// initially free the individual nodes
-	for (unsigned clear_pixel=0; clear_pixel<np_list_vals; clear_pixel++)
-	{
-		struct node *const curr_pixel_node = (*(np_list+clear_pixel))->pixel_node;
-		free(curr_pixel_node);
-	}
-
-	// now delete the np_list itself
-	delete_np_list();
+	delete_grid(grid);
 }
 
 /**
  * Colour the given pixel in the maze.
  */
 inline static
-void colour_pixel(struct maze_image *const maze, unsigned pixel)
+void colour_pixel(struct maze_image *const maze, size_t pixel)
 {
 	unsigned char *const pixel_byte = maze->data + pixel;
 
@@ -3,6 +3,8 @@
 
 #include "maze_solver.h"
 #include "shortest_path/queue.h"
+#include "grid/maze_grid.h"
+#include "fill/dead_end_fill.h"
 
 /**
  * For the given maze find the start and end gates.
@@ -19,43 +21,44 @@ struct openings *find_openings(struct maze_image *const maze);
 void print_ascii_maze(struct maze_image *const maze);
 #endif
 
-//
-// FIXME: Think about moving these to maze_graph_bridge.
-//
-
 /**
- * Create the graph nodes for each clear pixel in the maze image and initialise
- * the adjacency list and heuristic values for the node.
+ * Create the grid that holds the search state for the maze by marking
+ * each clear pixel of the maze image in the clear bitmap of the grid.
+ * The grid is the (implicit) graph that is searched for the shortest path.
+ *
+ * When 'open' is not NULL only the clear pixels that are open in it
+ * (i.e., weren't filled by 'fill_dead_ends') are marked. The arrays of the
+ * grid are kept in the given storage.
  *
- * Returns 0 on success and non-zero value on error (mostly memory error).
+ * Returns a valid grid on success and NULL on error (mostly memory error).
  */
-int create_graph(struct maze_image *const maze, struct openings *const gates);
+struct maze_grid *create_graph(struct maze_image *const maze, const struct open_pixels *const open,
+                               enum grid_storage storage);
 
 /**
- * Find the shortest path from the start gate node to the end gate node
- * in the graph using the heuritic value which estimates the approxiamate
- * cost to the destination from any clear pixel in the maze.
+ * Find the shortest path from the start gate pixel to the end gate pixel
+ * in the grid using the heuritic value which estimates the approxiamate
+ * cost to the destination from any clear pixel in the maze. The movement
+ * and the heuristic used are specified in the given options.
  *
  * Stores the shortest path in the given queue. The queue is expected to be
  * a pointer to a valid queue head which has been initialized.
  *
- * Returns the non-negative distance of the destination from the source on
+ * Returns the number of pixels the destination is away from the source on
  * success or 0 in case of failure.
  *
  * Note: In case of failure the queue might be partially filled. Freeing
  * the elements in the queue (and of course the queue head) is the
  * responsibility of the caller.
  */
-unsigned find_shortest_path(struct openings *const gates, struct sp_queue_head *const sp);
+size_t find_shortest_path(struct maze_grid *const grid, struct openings *const gates,
+                          const struct maze_solver_options *const options,
+                          struct sp_queue_head *const sp);
 
 /**
- * Free up the memory taken up by the graph and its related structure.
+ * Free up the memory taken up by the grid.
  */
-void delete_graph(void);
-
-//
-// END FIXME
-//
+void delete_graph(struct maze_grid *const grid);
 
 /**
  * Colour the pixels corresponding to the shortest path with a colour other
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "memory_plan.h"
+#include "../grid/maze_grid.h"
+#include "../a_star/frontier/pqueue.h"
+
+/**
+ * Read the limit in the cgroup file at 'path' into 'limit'.
+ *
+ * Returns 0 on success and non-zero value if there's no limit.
+ */
+static int read_cgroup_limit(const char *const path, size_t *const limit)
+{
+	FILE *const limit_file = fopen(path, "r");
+	unsigned long long value;
+
+	if (limit_file == NULL)
+	{
+		return 1;
+	}
+
+	// "max" (v2) doesn't parse; v1 reports a huge value instead
+	const int parsed = fscanf(limit_file, "%llu", &value) == 1;
+
+	fclose(limit_file);
+
+	if (!parsed || value >= (unsigned long long)SIZE_MAX/2)
+	{
+		return 1;
+	}
+
+	*limit = value;
+	return 0;
+}
+
+size_t detect_memory_limit(void)
+{
+	static const char *const cgroup_limits[] = {
+		"/sys/fs/cgroup/memory.max",                     // v2
+		"/sys/fs/cgroup/memory/memory.limit_in_bytes"    // v1
+	};
+
+	size_t limit = 0;
+
+	const long pages = sysconf(_SC_PHYS_PAGES),
+	           page_size = sysconf(_SC_PAGESIZE);
+
+	if (pages > 0 && page_size > 0)
+	{
+		limit = (size_t)pages*page_size;
+	}
+
+	for (unsigned cgroup = 0; cgroup < sizeof(cgroup_limits)/sizeof(cgroup_limits[0]); cgroup++)
+	{
+		size_t cgroup_limit;
+
+		if (read_cgroup_limit(cgroup_limits[cgroup], &cgroup_limit) == 0 &&
+		    (limit == 0 || cgroup_limit < limit))
+		{
+			limit = cgroup_limit;
+		}
+	}
+
+#ifdef KS_MAZE_SOLVER_MEMORY_PLAN_DEBUG
+	printf("detect_memory_limit: %zu bytes\n", limit);
+#endif
+
+	return limit;
+}
+
+/**
+ * Returns the fraction of the clear pixels among (at most) PLAN_SAMPLE_PIXELS
+ * pixels spread evenly over the maze.
+ */
+static double sample_clear_fraction(const struct maze_image *const maze)
+{
+	const size_t stride = (maze->pixels > PLAN_SAMPLE_PIXELS) ? maze->pixels/PLAN_SAMPLE_PIXELS : 1;
+	size_t sampled = 0, clear = 0;
+
+	for (size_t pixel = 0; pixel < maze->pixels; pixel += stride)
+	{
+		clear += (maze->data[pixel] == CLEAR_PIXEL);
+		sampled++;
+	}
+
+	return (sampled > 0) ? (double)clear/sampled : 0;
+}
+
+void plan_memory(const struct maze_image *const maze, const struct maze_solver_options *const options,
+                 size_t limit, struct memory_plan *const plan)
+{
+	const size_t cells = grid_cells(maze->width, maze->height),
+	             clear_bitmap = (cells + 63)/64*sizeof(uint64_t);
+
+	plan->limit = limit;
+	plan->clear_fraction = sample_clear_fraction(maze);
+
+	const size_t frontier = plan->clear_fraction*maze->pixels*PLAN_FRONTIER_FRACTION*sizeof(struct heap_elem),
+	             // the maze, the frontier and the bitmap of the open pixels while filling
+	             common = maze->pixels + frontier + ((options->fill != FILL_NONE) ? maze->pixels/8 : 0),
+	             // the flags of the anytime search
+	             anytime = options->anytime ? cells : 0;
+
+	plan->estimates[PLAN_GRID] = common + clear_bitmap + cells*(sizeof(unsigned) + sizeof(unsigned char)) + anytime;
+
+	// the reached bitmap and the 2-bit directions (the queue is small)
+	plan->estimates[PLAN_FIELD] = (options->connectivity == CONNECTIVITY_4 && options->weight <= 1.0 &&
+	                               !options->anytime) ? maze->pixels + maze->pixels/8 + maze->pixels/4 : 0;
+
+	plan->estimates[PLAN_GRID_FILE] = common + clear_bitmap + anytime;
+
+	plan->representation = PLAN_GRID;
+
+	while (plan->representation < PLAN_NONE &&
+	       (plan->estimates[plan->representation] == 0 || plan->estimates[plan->representation] > limit))
+	{
+		plan->representation++;
+	}
+
+#ifdef KS_MAZE_SOLVER_MEMORY_PLAN_DEBUG
+	printf("plan_memory: clear: %.1f%%, grid: %zu, field: %zu, grid file: %zu bytes, limit: %zu bytes\n",
+	       100*plan->clear_fraction, plan->estimates[PLAN_GRID], plan->estimates[PLAN_FIELD],
+	       plan->estimates[PLAN_GRID_FILE], limit);
+#endif
+}
+
+const char *plan_representation_name(enum plan_representation representation)
+{
+	static const char *const names[] = {
+		[PLAN_GRID]      = "grid in memory",
+		[PLAN_FIELD]     = "distance field in memory",
+		[PLAN_GRID_FILE] = "grid in a temporary file",
+		[PLAN_NONE]      = "none"
+	};
+
+	return names[representation];
+}
@@ -0,0 +1,83 @@
+#ifndef KS_MAZE_SOLVER_MEMORY_PLAN
+#define KS_MAZE_SOLVER_MEMORY_PLAN
+
+#include <stddef.h>
+#include "../maze_solver.h"
+
+/**
+ * Choosing how to represent a maze for the search within a memory limit.
+ *
+ * The memory needed by each representation is estimated from the
+ * dimensions of the maze and the fraction of clear pixels found in a
+ * sample of its pixels. The representations are tried from the fastest to
+ * the slowest and the first one that fits within the limit is chosen:
+ *
+ *   PLAN_GRID      - the grid held in memory (see "grid/maze_grid.h"),
+ *                    searched using the options given. About 5 bytes a
+ *                    pixel.
+ *
+ *   PLAN_FIELD     - the goal distance field built in memory (see
+ *                    "distance_field/distance_field.h"). Under half a byte
+ *                    a pixel. It finds a shortest path for CONNECTIVITY_4
+ *                    only, so it isn't used for the other options or when
+ *                    the path need not be the shortest.
+ *
+ *   PLAN_GRID_FILE - the grid with its distances and predecessors kept in a
+ *                    temporary file (GRID_STORAGE_FILE). Only the clear
+ *                    bitmap and the frontier have to fit in memory, but the
+ *                    search waits for the pages of the file.
+ *
+ * The maze itself (a byte a pixel) is counted as it is already in memory.
+ */
+
+// #define KS_MAZE_SOLVER_MEMORY_PLAN_DEBUG
+
+/**
+ * Pixels of the maze looked at to find the fraction of the clear pixels.
+ */
+#define PLAN_SAMPLE_PIXELS 65536
+
+/**
+ * The frontier of the searches in the test inputs never held more than a
+ * tenth of a percent of the clear pixels. The estimate leaves a wide margin.
+ */
+#define PLAN_FRONTIER_FRACTION (1.0/64)
+
+enum plan_representation
+{
+	PLAN_GRID,
+	PLAN_FIELD,
+	PLAN_GRID_FILE,
+	PLAN_NONE  // nothing fits
+};
+
+#define PLAN_REPRESENTATIONS PLAN_NONE
+
+struct memory_plan
+{
+	enum plan_representation representation;
+	size_t limit;                                // bytes the solver could use
+	size_t estimates[PLAN_REPRESENTATIONS];      // bytes needed by each representation (0 if unusable)
+	double clear_fraction;                       // fraction of the clear pixels in the sample
+};
+
+/**
+ * Returns the memory (in bytes) the process could use: the least of the
+ * limit of its cgroup (v2 or v1) and the physical memory. Returns 0 if
+ * none of them could be found.
+ */
+size_t detect_memory_limit(void);
+
+/**
+ * Choose the representation of the maze to be solved using the given
+ * options within 'limit' bytes.
+ */
+void plan_memory(const struct maze_image *const maze, const struct maze_solver_options *const options,
+                 size_t limit, struct memory_plan *const plan);
+
+/**
+ * Returns the name of the given representation.
+ */
+const char *plan_representation_name(enum plan_representation representation);
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef KS_MAZE_SOLVER_SP_QUEUE
 #define KS_MAZE_SOLVER_SP_QUEUE
 
+#include <stddef.h>
+
 /**
  * A simple queue implementation that stores the pixel indices that
  * lead to a shortest path from a source to the destination.
@@ -24,7 +26,7 @@
 #pragma pack(push, 4)
 struct sp_queue_elem
 {
-	unsigned elem;
+	size_t elem;
 	struct sp_queue_elem *next;
 };
 #pragma pack(pop)
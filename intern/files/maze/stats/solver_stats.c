@@ -0,0 +1,108 @@
+#include <string.h>
+#include "solver_stats.h"
+
+void reset_solver_stats(struct solver_stats *const stats)
+{
+	memset(stats, 0, sizeof(struct solver_stats));
+
+	for (unsigned phase = 0; phase < SOLVER_PHASES; phase++)
+	{
+		stats->phase_start[phase] = -1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &stats->origin);
+}
+
+double solver_stats_seconds(const struct solver_stats *const stats)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - stats->origin.tv_sec) + (now.tv_nsec - stats->origin.tv_nsec)/1e9;
+}
+
+const char *solver_phase_name(enum solver_phase phase)
+{
+	static const char *const names[SOLVER_PHASES] = {
+		[PHASE_GATES]  = "gates",
+		[PHASE_CACHE]  = "cache",
+		[PHASE_PLAN]   = "plan",
+		[PHASE_FILL]   = "fill",
+		[PHASE_GRAPH]  = "graph",
+		[PHASE_FIELD]  = "field",
+		[PHASE_SEARCH] = "search",
+		[PHASE_PATH]   = "path",
+		[PHASE_COLOUR] = "colour",
+		[PHASE_WRITE]  = "write"
+	};
+
+	return names[phase];
+}
+
+/**
+ * Write the counters as the members of a JSON object (without the braces).
+ */
+static void write_counters(const struct solver_stats *const stats, FILE *const out, const char *const indent)
+{
+	fprintf(out, "%s\"nodes_expanded\": %zu,\n", indent, stats->nodes_expanded);
+	fprintf(out, "%s\"nodes_generated\": %zu,\n", indent, stats->nodes_generated);
+	fprintf(out, "%s\"frontier_peak\": %zu,\n", indent, stats->frontier_peak);
+	fprintf(out, "%s\"bytes_allocated\": %zu,\n", indent, stats->bytes_allocated);
+	fprintf(out, "%s\"path_length\": %zu,\n", indent, stats->path_length);
+	fprintf(out, "%s\"cost\": %u,\n", indent, stats->cost);
+	fprintf(out, "%s\"cached\": %s\n", indent, stats->cached ? "true" : "false");
+}
+
+int write_solver_stats_json(const struct solver_stats *const stats, FILE *const out)
+{
+	fprintf(out, "{\n");
+	fprintf(out, "  \"seconds\": %.6f,\n", stats->seconds);
+	fprintf(out, "  \"phases\": {");
+
+	const char *separator = "\n";
+
+	for (unsigned phase = 0; phase < SOLVER_PHASES; phase++)
+	{
+		if (stats->phase_start[phase] < 0)
+		{
+			continue;
+		}
+
+		fprintf(out, "%s    \"%s\": { \"start\": %.6f, \"seconds\": %.6f }", separator,
+		        solver_phase_name(phase), stats->phase_start[phase], stats->phase_seconds[phase]);
+		separator = ",\n";
+	}
+
+	fprintf(out, "\n  },\n");
+	write_counters(stats, out, "  ");
+	fprintf(out, "}\n");
+
+	return ferror(out);
+}
+
+int write_solver_stats_trace(const struct solver_stats *const stats, FILE *const out)
+{
+	// the timestamps of the events are in microseconds
+	fprintf(out, "{\n  \"traceEvents\": [\n");
+	fprintf(out, "    { \"name\": \"solve_maze\", \"cat\": \"maze_solver\", \"ph\": \"X\", "
+	             "\"ts\": 0, \"dur\": %.3f, \"pid\": 1, \"tid\": 1,\n      \"args\": {\n",
+	        stats->seconds*1e6);
+	write_counters(stats, out, "        ");
+	fprintf(out, "      } }");
+
+	for (unsigned phase = 0; phase < SOLVER_PHASES; phase++)
+	{
+		if (stats->phase_start[phase] < 0)
+		{
+			continue;
+		}
+
+		fprintf(out, ",\n    { \"name\": \"%s\", \"cat\": \"maze_solver\", \"ph\": \"X\", "
+		             "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": 1 }",
+		        solver_phase_name(phase), stats->phase_start[phase]*1e6, stats->phase_seconds[phase]*1e6);
+	}
+
+	fprintf(out, "\n  ],\n  \"displayTimeUnit\": \"ms\"\n}\n");
+
+	return ferror(out);
+}
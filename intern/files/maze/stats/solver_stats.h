@@ -0,0 +1,120 @@
+#ifndef KS_MAZE_SOLVER_STATS
+#define KS_MAZE_SOLVER_STATS
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+
+/**
+ * The statistics of a single run of the solver.
+ *
+ * They are always compiled in. The solver collects them only when it is
+ * given a 'struct solver_stats' (see the 'stats' option in "maze_solver.h").
+ * Otherwise, every hook below is a single check of a NULL pointer and the
+ * search kernels only keep their counters in local variables, so leaving
+ * the statistics off costs next to nothing.
+ *
+ * The time spent in each phase of the solver is measured along with when
+ * the phase started. They could be written out as JSON or as the events of
+ * the Chrome trace format, which could be loaded into chrome://tracing or
+ * Perfetto to view the phases as a flame graph.
+ */
+
+enum solver_phase
+{
+	PHASE_GATES,    // finding the gates of the maze
+	PHASE_CACHE,    // looking up the solution cache
+	PHASE_PLAN,     // choosing the representation of the maze
+	PHASE_FILL,     // filling the dead ends
+	PHASE_GRAPH,    // creating (or mapping) the graph
+	PHASE_FIELD,    // building (or reading) the distance field and following it
+	PHASE_SEARCH,   // the A-star search
+	PHASE_PATH,     // constructing the path from the predecessors
+	PHASE_COLOUR,   // colouring the path in the maze
+	PHASE_WRITE     // expanding the solved maze and writing it (timed by the caller)
+};
+
+#define SOLVER_PHASES 10
+
+struct solver_stats
+{
+	struct timespec origin;               // when the stats were reset
+	double seconds;                       // total time the solver took
+	double phase_start[SOLVER_PHASES];    // seconds since the origin (negative if the phase didn't run)
+	double phase_seconds[SOLVER_PHASES];  // time spent in the phase
+
+	size_t nodes_expanded;    // pixels expanded by the search
+	size_t nodes_generated;   // pixels put into the frontier (or sent to another thread)
+	size_t frontier_peak;     // most pixels in the frontier at once (summed across threads)
+	size_t bytes_allocated;   // memory taken by the maze's graph, field, bitmaps, frontier and path
+	size_t path_length;       // pixels the end gate is away from the start (0 if no path was found)
+	unsigned cost;            // cost of the path found by the search
+	int cached;               // non-zero if the path was found in the solution cache
+};
+
+/**
+ * Clear the statistics and start measuring time from now.
+ */
+void reset_solver_stats(struct solver_stats *const stats);
+
+/**
+ * Returns the seconds elapsed since the statistics were reset.
+ */
+double solver_stats_seconds(const struct solver_stats *const stats);
+
+/**
+ * Mark the start and the end of the given phase. A phase that is entered
+ * more than once is timed from its first start to its last end.
+ */
+static inline
+void solver_phase_begin(struct solver_stats *const stats, const enum solver_phase phase)
+{
+	if (stats != NULL && stats->phase_start[phase] < 0)
+	{
+		stats->phase_start[phase] = solver_stats_seconds(stats);
+	}
+}
+
+static inline
+void solver_phase_end(struct solver_stats *const stats, const enum solver_phase phase)
+{
+	if (stats != NULL)
+	{
+		stats->phase_seconds[phase] = solver_stats_seconds(stats) - stats->phase_start[phase];
+	}
+}
+
+/**
+ * Count 'bytes' as allocated by the solver.
+ */
+static inline
+void solver_stats_allocated(struct solver_stats *const stats, const size_t bytes)
+{
+	if (stats != NULL)
+	{
+		stats->bytes_allocated += bytes;
+	}
+}
+
+/**
+ * Returns the name of the given phase.
+ */
+const char *solver_phase_name(enum solver_phase phase);
+
+/**
+ * Write the statistics as a JSON object into 'out'.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+int write_solver_stats_json(const struct solver_stats *const stats, FILE *const out);
+
+/**
+ * Write the phases as the complete ("X") events of the Chrome trace format
+ * into 'out'. The counters are attached as the arguments of an event that
+ * covers the whole run.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+int write_solver_stats_trace(const struct solver_stats *const stats, FILE *const out);
+
+#endif
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Generates a synthetic maze of any size as a 24-bit BMP image, for
+ * stress testing the maze solver with mazes larger than the test inputs.
+ *
+ * The maze is a lattice of corridors: every pixel in an odd row or an odd
+ * column is clear, except on the outer wall. The start gate is at (0, 1)
+ * and the end gate is at (height-1, width-2). So, the shortest path between
+ * them is known without solving the maze: the end gate is
+ * (height-1) + (width-3) pixels away from the start gate.
+ *
+ * The image is written one row at a time, so an image much larger than the
+ * memory could be generated.
+ *
+ * Usage: maze_generator.out <width> <height> <maze.bmp>
+ *
+ * The width and height must be odd and at least 3. The number of pixels
+ * the end gate is away from the start gate is printed.
+ */
+
+#define HEADER_SIZE 54
+#define BYTES_PER_PIXEL 3
+#define CLEAR_BYTE 0xFF
+#define HURDLE_BYTE 0x00
+
+static void put_le(unsigned char *const bytes, uint32_t value, const unsigned size)
+{
+	for (unsigned byte = 0; byte < size; byte++, value >>= 8)
+	{
+		bytes[byte] = value & 0xFF;
+	}
+}
+
+/**
+ * Fill in the header of a 24-bit BMP image of the given dimensions.
+ */
+static void fill_header(unsigned char *const header, const uint32_t width, const uint32_t height,
+                        const uint64_t file_size)
+{
+	memset(header, 0, HEADER_SIZE);
+
+	header[0] = 'B';
+	header[1] = 'M';
+
+	// the size doesn't fit in the header for images beyond 4GiB; readers
+	// use the size of the file instead
+	put_le(header + 2, (file_size <= UINT32_MAX) ? file_size : 0, 4);
+	put_le(header + 10, HEADER_SIZE, 4);     // offset of the pixels
+	put_le(header + 14, 40, 4);              // size of the info header
+	put_le(header + 18, width, 4);
+	put_le(header + 22, height, 4);
+	put_le(header + 26, 1, 2);               // planes
+	put_le(header + 28, 8*BYTES_PER_PIXEL, 2);
+}
+
+/**
+ * Returns non-zero value if the pixel at (row, col) is clear.
+ */
+static int is_clear(const uint32_t width, const uint32_t height, const uint32_t row, const uint32_t col)
+{
+	if (row == 0)
+	{
+		return col == 1;
+	}
+	else if (row == height-1)
+	{
+		return col == width-2;
+	}
+	else if (col == 0 || col == width-1)
+	{
+		return 0;
+	}
+
+	return (row % 2) || (col % 2);
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 4)
+	{
+		fprintf(stderr, "Usage: %s <width> <height> <maze.bmp>\n", argv[0]);
+		return 1;
+	}
+
+	const unsigned long width = strtoul(argv[1], NULL, 10),
+	                    height = strtoul(argv[2], NULL, 10);
+
+	if (width < 3 || height < 3 || width % 2 == 0 || height % 2 == 0 ||
+	    width > INT32_MAX || height > INT32_MAX)
+	{
+		fprintf(stderr, "The width and height must be odd numbers between 3 and %d.\n", INT32_MAX);
+		return 1;
+	}
+
+	const size_t row_size = ((width*BYTES_PER_PIXEL + 3)/4)*4;
+	unsigned char header[HEADER_SIZE];
+	unsigned char *const row_bytes = calloc(row_size, 1);
+
+	if (row_bytes == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for a row of the image.\n");
+		return 1;
+	}
+
+	FILE *const image = fopen(argv[3], "wb");
+
+	if (image == NULL)
+	{
+		fprintf(stderr, "Could not open %s for writing.\n", argv[3]);
+		free(row_bytes);
+		return 1;
+	}
+
+	int ret_val = 0;
+
+	fill_header(header, width, height, HEADER_SIZE + (uint64_t)row_size*height);
+
+	if (fwrite(header, HEADER_SIZE, 1, image) != 1)
+	{
+		ret_val = 1;
+	}
+
+	for (uint32_t row = 0; row < height && ret_val == 0; row++)
+	{
+		for (uint32_t col = 0; col < width; col++)
+		{
+			memset(row_bytes + (size_t)col*BYTES_PER_PIXEL,
+			       is_clear(width, height, row, col) ? CLEAR_BYTE : HURDLE_BYTE, BYTES_PER_PIXEL);
+		}
+
+		if (fwrite(row_bytes, row_size, 1, image) != 1)
+		{
+			ret_val = 1;
+		}
+	}
+
+	if (fclose(image) || ret_val)
+	{
+		fprintf(stderr, "Could not write the image into %s.\n", argv[3]);
+		ret_val = 1;
+	}
+	else
+	{
+		printf("%lu\n", (height-1) + (width-3));
+	}
+
+	free(row_bytes);
+	return ret_val;
+}
@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include "live_solve.h"
+#include "../bmp/bmp_helpers.h"
+#include "../maze_solver_helpers.h"
+
+static void *fail_solve(struct live_solve *const solve, const int status)
+{
+	solve->status = status;
+	__atomic_store_n(&solve->state, SOLVE_FAILED, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+/**
+ * Move the path in 'sp' into the pixels of the path of the solve.
+ *
+ * Returns 0 on success and non-zero value on failure. The queue is
+ * emptied in both cases.
+ */
+static int keep_path(struct live_solve *const solve, struct sp_queue_head *const sp, const size_t length)
+{
+	const unsigned width = solve->grid->width;
+
+	solve->path_pixels = malloc((length+1)*sizeof(struct path_pixel));
+	solve->path_length = 0;
+
+	while (!sp_queue_empty(sp))
+	{
+		struct sp_queue_elem *const elem = sp_remove_elem(sp);
+
+		if (solve->path_pixels != NULL)
+		{
+			solve->path_pixels[solve->path_length].row = elem->elem/width;
+			solve->path_pixels[solve->path_length].col = elem->elem%width;
+			solve->path_length++;
+		}
+
+		free(elem);
+	}
+
+	return solve->path_pixels == NULL;
+}
+
+static void *solve_thread(void *const data)
+{
+	struct live_solve *const solve = data;
+	struct maze_image *const maze = &solve->file.maze;
+
+	int status = read_maze_file(solve->path, &solve->file);
+
+	if (status)
+	{
+		return fail_solve(solve, status);
+	}
+
+	maze->padding = find_padding(maze->width);
+	solve->gates = find_openings(maze);
+
+	if (solve->gates == NULL)
+	{
+		free_maze_file(&solve->file);
+		return fail_solve(solve, ERROPENINGS);
+	}
+
+	solve->grid = create_graph(maze, NULL, GRID_STORAGE_HEAP);
+
+	// the grid is all that the search needs
+	free_maze_file(&solve->file);
+
+	if (solve->grid == NULL)
+	{
+		return fail_solve(solve, ERRMEMORY);
+	}
+
+	if (!a_star_costs_fit(grid_clear_pixels(solve->grid), solve->grid->width, solve->grid->height,
+	                      solve->options.connectivity, solve->options.weight))
+	{
+		return fail_solve(solve, ERRMAZESIZE);
+	}
+
+	__atomic_store_n(&solve->state, SOLVE_SEARCHING, __ATOMIC_RELEASE);
+
+	struct sp_queue_head sp;
+	initialise_sp_queue(&sp);
+
+	const size_t length = find_shortest_path(solve->grid, solve->gates, &solve->options, &sp);
+
+	if (keep_path(solve, &sp, length) || length == 0)
+	{
+		return fail_solve(solve, (length == 0) ? ERRSHPATH : ERRMEMORY);
+	}
+
+	__atomic_store_n(&solve->state, SOLVE_DONE, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+int start_live_solve(struct live_solve *const solve, const char *const path,
+                     const struct maze_solver_options *const options)
+{
+	solve->path = path;
+	initialise_solver_options(&solve->options);
+	solve->options.connectivity = options->connectivity;
+	solve->options.heuristic = options->heuristic;
+	solve->options.weight = options->weight;
+	solve->options.threads = options->threads;
+
+	solve->state = SOLVE_LOADING;
+	solve->status = 0;
+	solve->file.maze.data = NULL;
+	solve->gates = NULL;
+	solve->grid = NULL;
+	solve->path_pixels = NULL;
+	solve->path_length = 0;
+
+	return pthread_create(&solve->thread, NULL, solve_thread, solve);
+}
+
+enum live_solve_state live_solve_state(const struct live_solve *const solve)
+{
+	return __atomic_load_n(&solve->state, __ATOMIC_ACQUIRE);
+}
+
+void finish_live_solve(struct live_solve *const solve)
+{
+	pthread_join(solve->thread, NULL);
+
+	free(solve->path_pixels);
+	delete_graph(solve->grid);
+	free(solve->gates);
+
+	solve->path_pixels = NULL;
+	solve->grid = NULL;
+	solve->gates = NULL;
+}
@@ -0,0 +1,83 @@
+#ifndef KS_MAZE_VIEWER_LIVE_SOLVE
+#define KS_MAZE_VIEWER_LIVE_SOLVE
+
+#include <pthread.h>
+#include "../maze_solver.h"
+#include "../maze_file.h"
+#include "../grid/maze_grid.h"
+
+/**
+ * Solving the maze shown by the viewer in a thread of its own.
+ *
+ * The thread reads the maze, creates its grid and searches it like the
+ * solver does. The grid is published as soon as it is created so that the
+ * viewer could show the pixels reached by the search (the expanding
+ * frontier) while the search runs. The viewer only reads the distances of
+ * the pixels, the same way the threads of the parallel search read the
+ * distances of the pixels owned by the others (see "a_star/hda_star.c").
+ *
+ * The path found is kept as the rows and columns of its pixels in the maze
+ * (whose rows are bottom-up; see "maze_pyramid.h").
+ */
+
+enum live_solve_state
+{
+	SOLVE_LOADING,    // reading the maze and creating the grid
+	SOLVE_SEARCHING,  // the grid is available
+	SOLVE_DONE,       // the path is available
+	SOLVE_FAILED
+};
+
+struct path_pixel
+{
+	unsigned row, col;
+};
+
+struct live_solve
+{
+	const char *path;
+	struct maze_solver_options options;
+	pthread_t thread;
+
+	enum live_solve_state state;  // read and written atomically
+	int status;                   // the error when SOLVE_FAILED
+
+	struct maze_file file;
+	struct openings *gates;
+	struct maze_grid *grid;       // valid once the state is SOLVE_SEARCHING
+	struct path_pixel *path_pixels;
+	size_t path_length;           // pixels in the path
+};
+
+/**
+ * Start solving the maze in the BMP image found at 'path' using the given
+ * options (only the connectivity, heuristic, weight and threads are used).
+ *
+ * Returns 0 on success and non-zero value if the thread couldn't be started.
+ */
+int start_live_solve(struct live_solve *const solve, const char *const path,
+                     const struct maze_solver_options *const options);
+
+/**
+ * Returns the current state of the solve.
+ */
+enum live_solve_state live_solve_state(const struct live_solve *const solve);
+
+/**
+ * Returns non-zero value if the pixel at (row, col) of the maze has been
+ * reached by the search. The state must be SOLVE_SEARCHING or later.
+ */
+static inline
+int live_solve_reached(const struct live_solve *const solve, unsigned row, unsigned col)
+{
+	const struct maze_grid *const grid = solve->grid;
+
+	return __atomic_load_n(grid->dist + grid_cell(grid, row, col), __ATOMIC_RELAXED) != GRID_UNVISITED;
+}
+
+/**
+ * Wait for the solve to finish and free the memory held by it.
+ */
+void finish_live_solve(struct live_solve *const solve);
+
+#endif
@@ -0,0 +1,264 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "maze_pyramid.h"
+
+#ifdef KS_MAZE_VIEWER_PYRAMID_DEBUG
+#include <stdio.h>
+#endif
+
+#define BMP_HEADER_SIZE 54
+#define BMP_BYTES_PER_PIXEL 3
+
+static uint32_t get_le(const unsigned char *const bytes, const unsigned size)
+{
+	uint32_t value = 0;
+
+	for (unsigned byte = size; byte > 0; byte--)
+	{
+		value = (value << 8) | bytes[byte-1];
+	}
+
+	return value;
+}
+
+/**
+ * Returns the level 0 cell of the pixel whose bytes are given.
+ */
+static inline
+unsigned char pixel_cell(const unsigned char *const pixel)
+{
+	if (pixel[0] == 0xFF && pixel[1] == 0xFF && pixel[2] == 0xFF)
+	{
+		return PYRAMID_CLEAR_MAX;
+	}
+	else if (pixel[0] == 0 && pixel[1] == 0 && pixel[2] == 0)
+	{
+		return 0;
+	}
+
+	// the path is clear
+	return PYRAMID_PATH_BIT | PYRAMID_CLEAR_MAX;
+}
+
+unsigned char pyramid_cell(const struct maze_pyramid *const pyramid, const unsigned level,
+                           const unsigned row, const unsigned col)
+{
+	if (level == 0)
+	{
+		return pixel_cell(pyramid->data + (size_t)(pyramid->height-1 - row)*pyramid->row_size +
+		                  (size_t)col*BMP_BYTES_PER_PIXEL);
+	}
+
+	const struct pyramid_level *const curr = pyramid->level + level;
+
+	return curr->cells[(size_t)row*curr->width + col];
+}
+
+/**
+ * Build level 1 from the image. The clear pixels (at most 4) and the path
+ * bit of every cell are counted first and turned into the fraction after.
+ */
+static void build_first_level(struct maze_pyramid *const pyramid)
+{
+	struct pyramid_level *const first = pyramid->level + 1;
+
+	// the rows are read in the order they are stored in the file
+	for (unsigned image_row = 0; image_row < pyramid->height; image_row++)
+	{
+		const unsigned char *const pixels = pyramid->data + (size_t)image_row*pyramid->row_size;
+		unsigned char *const cells = first->cells + (size_t)((pyramid->height-1 - image_row)/2)*first->width;
+
+		for (unsigned col = 0; col < pyramid->width; col++)
+		{
+			const unsigned char cell = pixel_cell(pixels + (size_t)col*BMP_BYTES_PER_PIXEL);
+
+			cells[col/2] += (cell & PYRAMID_CLEAR_MAX) ? 1 : 0;
+			cells[col/2] |= cell & PYRAMID_PATH_BIT;
+		}
+	}
+
+	for (unsigned row = 0; row < first->height; row++)
+	{
+		const unsigned rows = (2*row + 1 < pyramid->height) ? 2 : 1;
+
+		for (unsigned col = 0; col < first->width; col++)
+		{
+			unsigned char *const cell = first->cells + (size_t)row*first->width + col;
+			const unsigned covered = rows*((2*col + 1 < pyramid->width) ? 2 : 1);
+
+			*cell = (*cell & PYRAMID_PATH_BIT) |
+			        ((*cell & ~PYRAMID_PATH_BIT)*PYRAMID_CLEAR_MAX + covered/2)/covered;
+		}
+	}
+}
+
+/**
+ * Build the given level (above 1) from the one below it.
+ */
+static void build_level(struct maze_pyramid *const pyramid, const unsigned level)
+{
+	const struct pyramid_level *const below = pyramid->level + level - 1;
+	struct pyramid_level *const curr = pyramid->level + level;
+
+	for (unsigned row = 0; row < curr->height; row++)
+	{
+		for (unsigned col = 0; col < curr->width; col++)
+		{
+			unsigned clear = 0, covered = 0;
+			unsigned char path = 0;
+
+			for (unsigned below_row = 2*row; below_row < 2*row + 2 && below_row < below->height; below_row++)
+			{
+				for (unsigned below_col = 2*col; below_col < 2*col + 2 && below_col < below->width; below_col++)
+				{
+					const unsigned char cell = below->cells[(size_t)below_row*below->width + below_col];
+
+					clear += cell & PYRAMID_CLEAR_MAX;
+					path |= cell & PYRAMID_PATH_BIT;
+					covered++;
+				}
+			}
+
+			curr->cells[(size_t)row*curr->width + col] = path | (clear + covered/2)/covered;
+		}
+	}
+}
+
+/**
+ * Map the image and read its header.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ */
+static int map_image(const char *const path, struct maze_pyramid *const pyramid)
+{
+	const int fd = open(path, O_RDONLY);
+	struct stat image_stat;
+
+	if (fd == -1)
+	{
+		return ERRPYRAMIDOPEN;
+	}
+
+	if (fstat(fd, &image_stat) || (size_t)image_stat.st_size < BMP_HEADER_SIZE)
+	{
+		close(fd);
+		return ERRPYRAMIDFORMAT;
+	}
+
+	pyramid->mapping_size = image_stat.st_size;
+	pyramid->mapping = mmap(NULL, pyramid->mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (pyramid->mapping == MAP_FAILED)
+	{
+		pyramid->mapping = NULL;
+		return ERRPYRAMIDOPEN;
+	}
+
+	const unsigned char *const header = pyramid->mapping;
+	const uint32_t data_offset = get_le(header + 10, 4);
+	const int32_t width = get_le(header + 18, 4),
+	              height = get_le(header + 22, 4);
+
+	if (header[0] != 'B' || header[1] != 'M' || width <= 0 || height <= 0 ||
+	    get_le(header + 28, 2) != 8*BMP_BYTES_PER_PIXEL)
+	{
+		return ERRPYRAMIDFORMAT;
+	}
+
+	pyramid->width = width;
+	pyramid->height = height;
+	pyramid->row_size = (((size_t)width*BMP_BYTES_PER_PIXEL + 3)/4)*4;
+	pyramid->data = header + data_offset;
+
+	// the image must hold every row
+	if (data_offset > pyramid->mapping_size ||
+	    (pyramid->mapping_size - data_offset)/pyramid->row_size < (size_t)height)
+	{
+		return ERRPYRAMIDFORMAT;
+	}
+
+	return 0;
+}
+
+int open_maze_pyramid(const char *const path, struct maze_pyramid *const pyramid)
+{
+	pyramid->mapping = NULL;
+	pyramid->levels = 0;
+
+	int ret_val = map_image(path, pyramid);
+
+	if (ret_val)
+	{
+		close_maze_pyramid(pyramid);
+		return ret_val;
+	}
+
+	pyramid->level[0].width = pyramid->width;
+	pyramid->level[0].height = pyramid->height;
+	pyramid->level[0].cells = NULL;
+	pyramid->levels = 1;
+
+	while (pyramid->levels < PYRAMID_MAX_LEVELS &&
+	       (pyramid->level[pyramid->levels-1].width > PYRAMID_TILE_SIZE ||
+	        pyramid->level[pyramid->levels-1].height > PYRAMID_TILE_SIZE))
+	{
+		const struct pyramid_level *const below = pyramid->level + pyramid->levels - 1;
+		struct pyramid_level *const curr = pyramid->level + pyramid->levels;
+
+		curr->width = (below->width + 1)/2;
+		curr->height = (below->height + 1)/2;
+		curr->cells = calloc((size_t)curr->width*curr->height, 1);
+
+		// counted before the check so that it is freed on failure
+		pyramid->levels++;
+
+		if (curr->cells == NULL)
+		{
+			close_maze_pyramid(pyramid);
+			return ERRPYRAMIDMEMORY;
+		}
+	}
+
+	// the image is read once from the start to the end
+	madvise(pyramid->mapping, pyramid->mapping_size, MADV_SEQUENTIAL);
+
+	if (pyramid->levels > 1)
+	{
+		build_first_level(pyramid);
+	}
+
+	for (unsigned level = 2; level < pyramid->levels; level++)
+	{
+		build_level(pyramid, level);
+	}
+
+	// only the visible tiles are read from now on
+	madvise(pyramid->mapping, pyramid->mapping_size, MADV_RANDOM);
+
+#ifdef KS_MAZE_VIEWER_PYRAMID_DEBUG
+	printf("open_maze_pyramid: %ux%u pixels, %u levels\n", pyramid->width, pyramid->height, pyramid->levels);
+#endif
+
+	return 0;
+}
+
+void close_maze_pyramid(struct maze_pyramid *const pyramid)
+{
+	for (unsigned level = 1; level < pyramid->levels; level++)
+	{
+		free(pyramid->level[level].cells);
+	}
+
+	pyramid->levels = 0;
+
+	if (pyramid->mapping != NULL)
+	{
+		munmap(pyramid->mapping, pyramid->mapping_size);
+		pyramid->mapping = NULL;
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef KS_MAZE_VIEWER_PYRAMID
+#define KS_MAZE_VIEWER_PYRAMID
+
+#include <stddef.h>
+
+/**
+ * The mipmap pyramid of a maze image for the viewer.
+ *
+ * The BMP image is mapped into memory and is never read as a whole; it is
+ * level 0 of the pyramid. Every level above it halves the width and height
+ * of the one below. A cell of a level covers a square of 2^level pixels
+ * on a side and holds the fraction of the clear pixels among them
+ * (0 to PYRAMID_CLEAR_MAX) along with PYRAMID_PATH_BIT when any of them is
+ * coloured (i.e., on the path of a solved maze). So, a thin corridor or a
+ * path doesn't vanish when the maze is zoomed out.
+ *
+ * The levels above 0 are built when the pyramid is opened, reading the image
+ * once from top to bottom. They take a third of a byte per pixel of the image
+ * in total. The levels stop once the whole maze fits in a tile.
+ *
+ * The rows of a level are from the top of the image to the bottom, unlike
+ * the rows of the BMP image (and of the maze seen by the solver) which are
+ * stored bottom-up.
+ */
+
+// #define KS_MAZE_VIEWER_PYRAMID_DEBUG
+
+/**
+ * Error codes
+ */
+#define ERRPYRAMIDOPEN 1
+#define ERRPYRAMIDFORMAT 2
+#define ERRPYRAMIDMEMORY 4
+
+#define PYRAMID_TILE_SIZE 256
+#define PYRAMID_MAX_LEVELS 32
+
+#define PYRAMID_CLEAR_MAX 0x7F
+#define PYRAMID_PATH_BIT 0x80
+
+struct pyramid_level
+{
+	unsigned width;
+	unsigned height;
+	unsigned char *cells;  // row-major; NULL for level 0
+};
+
+struct maze_pyramid
+{
+	unsigned width;             // width of the maze in pixels
+	unsigned height;            // height of the maze in pixels
+	unsigned levels;            // number of levels including level 0
+
+	void *mapping;              // the mapped BMP image
+	size_t mapping_size;
+	const unsigned char *data;  // the pixels of the image (bottom row first)
+	size_t row_size;            // bytes in a row of the image including the padding
+
+	struct pyramid_level level[PYRAMID_MAX_LEVELS];
+};
+
+/**
+ * Map the 24-bit BMP image of a maze found at 'path' and build its pyramid.
+ *
+ * Returns 0 on success and a non-zero value indicating the error on failure.
+ * On failure, no memory is held by 'pyramid'.
+ */
+int open_maze_pyramid(const char *const path, struct maze_pyramid *const pyramid);
+
+/**
+ * Unmap the image and free the levels of the pyramid.
+ */
+void close_maze_pyramid(struct maze_pyramid *const pyramid);
+
+/**
+ * Returns the cell at (row, col) of the given level. Row 0 is the top of
+ * the image. The cell must be within the level.
+ */
+unsigned char pyramid_cell(const struct maze_pyramid *const pyramid, unsigned level,
+                           unsigned row, unsigned col);
+
+#endif
@@ -0,0 +1,696 @@
+/**
+ * An interactive viewer for (very) large mazes.
+ *
+ * The maze is mapped into memory and only the tiles of the pyramid (see
+ * "maze_pyramid.h") visible at the current zoom level are rendered. The
+ * rendered tiles are cached (see "tile_cache.h"), so panning and zooming
+ * mostly draws the cached tiles.
+ *
+ * The maze could be solved in a thread of its own while it is being
+ * viewed (see "live_solve.h"). The path found is drawn over the maze. The
+ * pixels reached by the search could be shown as the search runs.
+ *
+ * Usage: maze_viewer.out [options] <maze.bmp>
+ *
+ *   -s, --solve               solve the maze and show the path found
+ *   -f, --frontier            show the pixels reached by the search as it
+ *                             runs (implies --solve)
+ *   -c, --connectivity=<4|8>  the pixels a pixel could move to (default: 4)
+ *   -T, --threads=<n>         number of threads searching for the path
+ *
+ * Controls: drag to pan, scroll to zoom around the pointer, '+' and '-' to
+ * zoom around the centre, the arrow keys to pan and '0' to fit the maze in
+ * the window.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <gtk/gtk.h>
+#include "maze_pyramid.h"
+#include "tile_cache.h"
+#include "live_solve.h"
+
+#define VIEWER_MAX_ZOOM 64.0
+#define VIEWER_ZOOM_STEP 1.25
+#define VIEWER_PAN_STEP 0.1   // fraction of the view panned by an arrow key
+
+/**
+ * The pixels reached by the search are looked up for every block of
+ * OVERLAY_SCALE x OVERLAY_SCALE screen pixels once in OVERLAY_REFRESH_FRAMES
+ * frames, which keeps the cost of showing them well within a frame.
+ */
+#define OVERLAY_SCALE 2
+#define OVERLAY_REFRESH_FRAMES 6
+#define OVERLAY_COLOUR 0x801A3380  // translucent blue (premultiplied ARGB)
+
+#define BACKGROUND_GREY 0.5
+
+struct viewer
+{
+	const char *path;
+	struct maze_pyramid pyramid;
+	struct tile_cache tiles;
+	GtkWidget *window;
+	GtkWidget *area;
+
+	double zoom;              // screen pixels per pixel of the maze
+	double left, top;         // the point of the maze at the top-left corner of the view
+	gboolean fitted;          // the maze has been fitted in the view once
+	gboolean dragging;
+	double drag_x, drag_y;
+
+	gboolean solving;
+	gboolean show_frontier;
+	struct maze_solver_options options;
+	struct live_solve solve;
+	enum live_solve_state shown_state;  // the state when the view was last drawn
+	enum live_solve_state titled_state; // the state shown in the title
+
+	cairo_surface_t *overlay; // the pixels reached by the search
+	gboolean overlay_stale;   // the view changed since the overlay was made
+	unsigned overlay_age;     // frames since the overlay was made
+};
+
+/**
+ * Returns the least zoom at which the maze fits in the view.
+ */
+static double fit_zoom(const struct viewer *const viewer, const int width, const int height)
+{
+	const double zoom = fmin((double)width/viewer->pyramid.width, (double)height/viewer->pyramid.height);
+
+	return fmin(zoom, VIEWER_MAX_ZOOM);
+}
+
+static void fit_maze(struct viewer *const viewer)
+{
+	const int width = gtk_widget_get_allocated_width(viewer->area),
+	          height = gtk_widget_get_allocated_height(viewer->area);
+
+	viewer->zoom = fit_zoom(viewer, width, height);
+
+	// centre the maze
+	viewer->left = (viewer->pyramid.width - width/viewer->zoom)/2;
+	viewer->top = (viewer->pyramid.height - height/viewer->zoom)/2;
+	viewer->overlay_stale = TRUE;
+}
+
+/**
+ * Zoom by 'factor' keeping the point of the maze at (x, y) of the view
+ * where it is.
+ */
+static void zoom_at(struct viewer *const viewer, const double factor, const double x, const double y)
+{
+	const int width = gtk_widget_get_allocated_width(viewer->area),
+	          height = gtk_widget_get_allocated_height(viewer->area);
+
+	// the whole maze is shown at the least zoom
+	const double min_zoom = fmin(fit_zoom(viewer, width, height), 1.0);
+	const double maze_x = viewer->left + x/viewer->zoom,
+	             maze_y = viewer->top + y/viewer->zoom;
+
+	viewer->zoom = fmax(min_zoom, fmin(VIEWER_MAX_ZOOM, viewer->zoom*factor));
+	viewer->left = maze_x - x/viewer->zoom;
+	viewer->top = maze_y - y/viewer->zoom;
+	viewer->overlay_stale = TRUE;
+
+	gtk_widget_queue_draw(viewer->area);
+}
+
+static void pan(struct viewer *const viewer, const double dx, const double dy)
+{
+	viewer->left += dx/viewer->zoom;
+	viewer->top += dy/viewer->zoom;
+	viewer->overlay_stale = TRUE;
+
+	gtk_widget_queue_draw(viewer->area);
+}
+
+/**
+ * Returns the level of the pyramid to draw at the current zoom: the
+ * smallest level whose cells take up at least a screen pixel.
+ */
+static unsigned view_level(const struct viewer *const viewer)
+{
+	unsigned level = 0;
+
+	while (level+1 < viewer->pyramid.levels && viewer->zoom*(1u << level) < 1.0)
+	{
+		level++;
+	}
+
+	return level;
+}
+
+/**
+ * Draw the visible tiles of the given level.
+ */
+static void draw_tiles(struct viewer *const viewer, cairo_t *const cr, const unsigned level,
+                       const int width, const int height)
+{
+	const struct pyramid_level *const curr = viewer->pyramid.level + level;
+	const double cell_pixels = (double)(1u << level),        // pixels of the maze in a cell
+	             tile_pixels = PYRAMID_TILE_SIZE*cell_pixels,  // pixels of the maze in a tile
+	             scale = viewer->zoom*cell_pixels;             // screen pixels in a cell
+
+	const long tile_rows = (curr->height + PYRAMID_TILE_SIZE - 1)/PYRAMID_TILE_SIZE,
+	           tile_cols = (curr->width + PYRAMID_TILE_SIZE - 1)/PYRAMID_TILE_SIZE;
+
+	const long first_row = fmax(0, floor(viewer->top/tile_pixels)),
+	           first_col = fmax(0, floor(viewer->left/tile_pixels)),
+	           last_row = fmin(tile_rows-1, floor((viewer->top + height/viewer->zoom)/tile_pixels)),
+	           last_col = fmin(tile_cols-1, floor((viewer->left + width/viewer->zoom)/tile_pixels));
+
+	for (long row = first_row; row <= last_row; row++)
+	{
+		for (long col = first_col; col <= last_col; col++)
+		{
+			const struct tile *const tile = lookup_tile(&viewer->tiles, level, row, col);
+			cairo_surface_t *const surface =
+				cairo_image_surface_create_for_data((unsigned char *)tile->pixels, CAIRO_FORMAT_RGB24,
+				                                    tile->width, tile->height,
+				                                    PYRAMID_TILE_SIZE*sizeof(uint32_t));
+
+			cairo_save(cr);
+			cairo_translate(cr, (col*tile_pixels - viewer->left)*viewer->zoom,
+			                    (row*tile_pixels - viewer->top)*viewer->zoom);
+			cairo_scale(cr, scale, scale);
+			cairo_set_source_surface(cr, surface, 0, 0);
+
+			// the pixels are shown as squares when zoomed in
+			cairo_pattern_set_filter(cairo_get_source(cr), (level == 0) ? CAIRO_FILTER_NEAREST
+			                                                            : CAIRO_FILTER_GOOD);
+			cairo_rectangle(cr, 0, 0, tile->width, tile->height);
+			cairo_fill(cr);
+			cairo_restore(cr);
+
+			cairo_surface_destroy(surface);
+		}
+	}
+}
+
+/**
+ * Mark the pixels reached by the search in the overlay.
+ */
+static void update_overlay(struct viewer *const viewer, const int width, const int height)
+{
+	const int overlay_width = (width + OVERLAY_SCALE - 1)/OVERLAY_SCALE,
+	          overlay_height = (height + OVERLAY_SCALE - 1)/OVERLAY_SCALE;
+
+	if (viewer->overlay == NULL ||
+	    cairo_image_surface_get_width(viewer->overlay) != overlay_width ||
+	    cairo_image_surface_get_height(viewer->overlay) != overlay_height)
+	{
+		if (viewer->overlay != NULL)
+		{
+			cairo_surface_destroy(viewer->overlay);
+		}
+
+		viewer->overlay = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, overlay_width, overlay_height);
+	}
+
+	cairo_surface_flush(viewer->overlay);
+
+	unsigned char *const data = cairo_image_surface_get_data(viewer->overlay);
+	const int stride = cairo_image_surface_get_stride(viewer->overlay);
+
+	for (int y = 0; y < overlay_height; y++)
+	{
+		uint32_t *const pixels = (uint32_t *)(data + (size_t)y*stride);
+		const double maze_y = viewer->top + (y + 0.5)*OVERLAY_SCALE/viewer->zoom;
+
+		for (int x = 0; x < overlay_width; x++)
+		{
+			const double maze_x = viewer->left + (x + 0.5)*OVERLAY_SCALE/viewer->zoom;
+
+			pixels[x] = 0;
+
+			if (maze_x >= 0 && maze_y >= 0 && maze_x < viewer->pyramid.width && maze_y < viewer->pyramid.height &&
+			    live_solve_reached(&viewer->solve, viewer->pyramid.height-1 - (unsigned)maze_y, (unsigned)maze_x))
+			{
+				pixels[x] = OVERLAY_COLOUR;
+			}
+		}
+	}
+
+	cairo_surface_mark_dirty(viewer->overlay);
+
+	viewer->overlay_stale = FALSE;
+	viewer->overlay_age = 0;
+}
+
+/**
+ * Draw the path found. Consecutive pixels of the path that fall within the
+ * same screen pixel are drawn as one point, so a long path zoomed out
+ * costs no more than the pixels it covers on the screen.
+ */
+static void draw_path(const struct viewer *const viewer, cairo_t *const cr)
+{
+	const struct path_pixel *const path = viewer->solve.path_pixels;
+	double last_x = -1, last_y = -1;
+
+	cairo_set_source_rgb(cr, ((TILE_PATH_COLOUR >> 16) & 0xFF)/255.0, ((TILE_PATH_COLOUR >> 8) & 0xFF)/255.0,
+	                     (TILE_PATH_COLOUR & 0xFF)/255.0);
+	cairo_set_line_width(cr, fmax(2.0, viewer->zoom));
+	cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+
+	for (size_t pixel = 0; pixel < viewer->solve.path_length; pixel++)
+	{
+		// the rows of the maze are bottom-up
+		const double x = (path[pixel].col + 0.5 - viewer->left)*viewer->zoom,
+		             y = (viewer->pyramid.height-1 - path[pixel].row + 0.5 - viewer->top)*viewer->zoom;
+
+		if (pixel > 0 && pixel+1 < viewer->solve.path_length && fabs(x - last_x) < 1 && fabs(y - last_y) < 1)
+		{
+			continue;
+		}
+
+		if (pixel == 0)
+		{
+			cairo_move_to(cr, x, y);
+		}
+		else
+		{
+			cairo_line_to(cr, x, y);
+		}
+
+		last_x = x;
+		last_y = y;
+	}
+
+	cairo_stroke(cr);
+}
+
+static
+gboolean draw_cb(GtkWidget *widget,
+                 cairo_t *cr,
+                 gpointer data)
+{
+	struct viewer *const viewer = data;
+	const int width = gtk_widget_get_allocated_width(widget),
+	          height = gtk_widget_get_allocated_height(widget);
+
+	if (!viewer->fitted)
+	{
+		fit_maze(viewer);
+		viewer->fitted = TRUE;
+	}
+
+	cairo_set_source_rgb(cr, BACKGROUND_GREY, BACKGROUND_GREY, BACKGROUND_GREY);
+	cairo_paint(cr);
+
+	draw_tiles(viewer, cr, view_level(viewer), width, height);
+
+	if (!viewer->solving)
+	{
+		return FALSE;
+	}
+
+	const enum live_solve_state state = live_solve_state(&viewer->solve);
+
+	if (viewer->show_frontier && state >= SOLVE_SEARCHING && state != SOLVE_FAILED)
+	{
+		if (viewer->overlay_stale || viewer->overlay_age >= OVERLAY_REFRESH_FRAMES ||
+		    state != viewer->shown_state)
+		{
+			update_overlay(viewer, width, height);
+		}
+
+		viewer->overlay_age++;
+
+		cairo_save(cr);
+		cairo_scale(cr, OVERLAY_SCALE, OVERLAY_SCALE);
+		cairo_set_source_surface(cr, viewer->overlay, 0, 0);
+		cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
+		cairo_paint(cr);
+		cairo_restore(cr);
+	}
+
+	if (state == SOLVE_DONE)
+	{
+		draw_path(viewer, cr);
+	}
+
+	viewer->shown_state = state;
+	return FALSE;
+}
+
+/**
+ * Redraw while the search is running (every frame when its progress is
+ * shown) and once more when it ends.
+ */
+static
+gboolean tick_cb(GtkWidget *widget,
+                 GdkFrameClock *frame_clock,
+                 gpointer data)
+{
+	struct viewer *const viewer = data;
+	const enum live_solve_state state = live_solve_state(&viewer->solve);
+
+	if (state == viewer->titled_state && (state == SOLVE_DONE || state == SOLVE_FAILED))
+	{
+		return G_SOURCE_REMOVE;
+	}
+
+	if (state != viewer->titled_state)
+	{
+		static const char *const state_names[] = {
+			[SOLVE_LOADING]   = "loading",
+			[SOLVE_SEARCHING] = "searching",
+			[SOLVE_DONE]      = "solved",
+			[SOLVE_FAILED]    = "not solved"
+		};
+
+		gchar *const title = g_strdup_printf("%s (%s)", viewer->path, state_names[state]);
+
+		gtk_window_set_title(GTK_WINDOW(viewer->window), title);
+		g_free(title);
+
+		if (state == SOLVE_FAILED)
+		{
+			g_printerr("%s\n", maze_error_message(viewer->solve.status));
+		}
+
+		viewer->titled_state = state;
+		gtk_widget_queue_draw(widget);
+	}
+	else if (state == SOLVE_SEARCHING && viewer->show_frontier)
+	{
+		gtk_widget_queue_draw(widget);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static
+gboolean scroll_event_cb(GtkWidget *widget,
+                         GdkEventScroll *event,
+                         gpointer data)
+{
+	struct viewer *const viewer = data;
+	double steps = 0;
+
+	switch (event->direction)
+	{
+	case GDK_SCROLL_UP:
+		steps = 1;
+		break;
+
+	case GDK_SCROLL_DOWN:
+		steps = -1;
+		break;
+
+	case GDK_SCROLL_SMOOTH:
+		steps = -event->delta_y;
+		break;
+
+	default:
+		return FALSE;
+	}
+
+	zoom_at(viewer, pow(VIEWER_ZOOM_STEP, steps), event->x, event->y);
+	return TRUE;
+}
+
+static
+gboolean button_press_event_cb(GtkWidget *widget,
+                               GdkEventButton *event,
+                               gpointer data)
+{
+	struct viewer *const viewer = data;
+
+	if (event->button != GDK_BUTTON_PRIMARY)
+	{
+		return FALSE;
+	}
+
+	viewer->dragging = TRUE;
+	viewer->drag_x = event->x;
+	viewer->drag_y = event->y;
+	return TRUE;
+}
+
+static
+gboolean button_release_event_cb(GtkWidget *widget,
+                                 GdkEventButton *event,
+                                 gpointer data)
+{
+	struct viewer *const viewer = data;
+
+	if (event->button == GDK_BUTTON_PRIMARY)
+	{
+		viewer->dragging = FALSE;
+	}
+
+	return TRUE;
+}
+
+static
+gboolean motion_notify_event_cb(GtkWidget *widget,
+                                GdkEventMotion *event,
+                                gpointer data)
+{
+	struct viewer *const viewer = data;
+
+	if (!viewer->dragging)
+	{
+		return FALSE;
+	}
+
+	pan(viewer, viewer->drag_x - event->x, viewer->drag_y - event->y);
+	viewer->drag_x = event->x;
+	viewer->drag_y = event->y;
+	return TRUE;
+}
+
+static
+gboolean key_press_event_cb(GtkWidget *widget,
+                            GdkEventKey *event,
+                            gpointer data)
+{
+	struct viewer *const viewer = data;
+	const int width = gtk_widget_get_allocated_width(viewer->area),
+	          height = gtk_widget_get_allocated_height(viewer->area);
+
+	switch (event->keyval)
+	{
+	case GDK_KEY_plus:
+	case GDK_KEY_equal:
+	case GDK_KEY_KP_Add:
+		zoom_at(viewer, VIEWER_ZOOM_STEP, width/2.0, height/2.0);
+		break;
+
+	case GDK_KEY_minus:
+	case GDK_KEY_KP_Subtract:
+		zoom_at(viewer, 1/VIEWER_ZOOM_STEP, width/2.0, height/2.0);
+		break;
+
+	case GDK_KEY_0:
+	case GDK_KEY_Home:
+		fit_maze(viewer);
+		gtk_widget_queue_draw(viewer->area);
+		break;
+
+	case GDK_KEY_Left:
+		pan(viewer, -VIEWER_PAN_STEP*width, 0);
+		break;
+
+	case GDK_KEY_Right:
+		pan(viewer, VIEWER_PAN_STEP*width, 0);
+		break;
+
+	case GDK_KEY_Up:
+		pan(viewer, 0, -VIEWER_PAN_STEP*height);
+		break;
+
+	case GDK_KEY_Down:
+		pan(viewer, 0, VIEWER_PAN_STEP*height);
+		break;
+
+	default:
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static
+void activate(GtkApplication *app,
+              gpointer data)
+{
+	struct viewer *const viewer = data;
+
+	viewer->window = gtk_application_window_new(app);
+	gtk_window_set_title(GTK_WINDOW(viewer->window), viewer->path);
+	gtk_window_set_default_size(GTK_WINDOW(viewer->window), 1024, 768);
+
+	viewer->area = gtk_drawing_area_new();
+	gtk_container_add(GTK_CONTAINER(viewer->window), viewer->area);
+
+	g_signal_connect(viewer->area, "draw", G_CALLBACK(draw_cb), viewer);
+	g_signal_connect(viewer->area, "scroll-event", G_CALLBACK(scroll_event_cb), viewer);
+	g_signal_connect(viewer->area, "button-press-event", G_CALLBACK(button_press_event_cb), viewer);
+	g_signal_connect(viewer->area, "button-release-event", G_CALLBACK(button_release_event_cb), viewer);
+	g_signal_connect(viewer->area, "motion-notify-event", G_CALLBACK(motion_notify_event_cb), viewer);
+	g_signal_connect(viewer->window, "key-press-event", G_CALLBACK(key_press_event_cb), viewer);
+
+	gtk_widget_set_events(viewer->area, gtk_widget_get_events(viewer->area)
+	                                    | GDK_SCROLL_MASK
+	                                    | GDK_SMOOTH_SCROLL_MASK
+	                                    | GDK_BUTTON_PRESS_MASK
+	                                    | GDK_BUTTON_RELEASE_MASK
+	                                    | GDK_POINTER_MOTION_MASK);
+
+	if (viewer->solving)
+	{
+		// the title is set to show the state on the first tick
+		viewer->titled_state = -1;
+		gtk_widget_add_tick_callback(viewer->area, tick_cb, viewer, NULL);
+	}
+
+	gtk_widget_show_all(viewer->window);
+}
+
+static void print_usage(const char *const program)
+{
+	fprintf(stderr, "Usage: %s [options] <maze.bmp>\n\n", program);
+	fprintf(stderr, "  -s, --solve               solve the maze and show the path found\n");
+	fprintf(stderr, "  -f, --frontier            show the pixels reached by the search as it runs\n");
+	fprintf(stderr, "                            (implies --solve)\n");
+	fprintf(stderr, "  -c, --connectivity=<4|8>  the pixels a pixel could move to (default: 4)\n");
+	fprintf(stderr, "  -T, --threads=<n>         number of threads searching for the path\n");
+	fprintf(stderr, "                            (default: 1)\n");
+}
+
+/**
+ * Parse the command line options into 'viewer'.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+static int parse_options(int argc, char *argv[], struct viewer *const viewer)
+{
+	static const struct option long_options[] = {
+		{ "solve",        no_argument,       NULL, 's' },
+		{ "frontier",     no_argument,       NULL, 'f' },
+		{ "connectivity", required_argument, NULL, 'c' },
+		{ "threads",      required_argument, NULL, 'T' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	int opt;
+	char *end;
+
+	initialise_solver_options(&viewer->options);
+	viewer->solving = FALSE;
+	viewer->show_frontier = FALSE;
+
+	while ((opt = getopt_long(argc, argv, "sfc:T:", long_options, NULL)) != -1)
+	{
+		switch (opt)
+		{
+		case 's':
+			viewer->solving = TRUE;
+			break;
+
+		case 'f':
+			viewer->solving = TRUE;
+			viewer->show_frontier = TRUE;
+			break;
+
+		case 'c':
+			if (strcmp(optarg, "4") == 0)
+			{
+				viewer->options.connectivity = CONNECTIVITY_4;
+			}
+			else if (strcmp(optarg, "8") == 0)
+			{
+				viewer->options.connectivity = CONNECTIVITY_8;
+				viewer->options.heuristic = HEURISTIC_OCTILE;
+			}
+			else
+			{
+				return 1;
+			}
+			break;
+
+		case 'T':
+			viewer->options.threads = strtoul(optarg, &end, 10);
+
+			if (*optarg == '\0' || *end != '\0' || viewer->options.threads == 0 ||
+			    viewer->options.threads > 4096)
+			{
+				return 1;
+			}
+			break;
+
+		default:
+			return 1;
+		}
+	}
+
+	if (optind+1 != argc)
+	{
+		return 1;
+	}
+
+	viewer->path = argv[optind];
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct viewer viewer;
+
+	memset(&viewer, 0, sizeof(struct viewer));
+
+	if (parse_options(argc, argv, &viewer))
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	const int pyramid_status = open_maze_pyramid(viewer.path, &viewer.pyramid);
+
+	if (pyramid_status)
+	{
+		fprintf(stderr, "Could not open the maze %s: %s\n", viewer.path,
+		        (pyramid_status == ERRPYRAMIDMEMORY) ? "not enough memory" : "not a 24-bit BMP image");
+		return 1;
+	}
+
+	if (initialise_tile_cache(&viewer.tiles, &viewer.pyramid))
+	{
+		fprintf(stderr, "Not enough memory for the tiles!\n");
+		close_maze_pyramid(&viewer.pyramid);
+		return 1;
+	}
+
+	if (viewer.solving && start_live_solve(&viewer.solve, viewer.path, &viewer.options))
+	{
+		fprintf(stderr, "Could not start solving the maze.\n");
+		viewer.solving = FALSE;
+	}
+
+	GtkApplication *const app = gtk_application_new(NULL, G_APPLICATION_FLAGS_NONE);
+	g_signal_connect(app, "activate", G_CALLBACK(activate), &viewer);
+
+	// the options have been parsed already
+	const int status = g_application_run(G_APPLICATION(app), 1, argv);
+	g_object_unref(app);
+
+	// a search that is still running ends along with the process
+	if (viewer.solving && live_solve_state(&viewer.solve) >= SOLVE_DONE)
+	{
+		finish_live_solve(&viewer.solve);
+	}
+
+	if (viewer.overlay != NULL)
+	{
+		cairo_surface_destroy(viewer.overlay);
+	}
+
+	delete_tile_cache(&viewer.tiles);
+	close_maze_pyramid(&viewer.pyramid);
+	return status;
+}
@@ -0,0 +1,97 @@
+#include <stdlib.h>
+#include "tile_cache.h"
+
+int initialise_tile_cache(struct tile_cache *const cache, const struct maze_pyramid *const pyramid)
+{
+	cache->pyramid = pyramid;
+	cache->clock = 0;
+	cache->pixels = malloc((size_t)TILE_CACHE_TILES*PYRAMID_TILE_SIZE*PYRAMID_TILE_SIZE*sizeof(uint32_t));
+
+	if (cache->pixels == NULL)
+	{
+		return 1;
+	}
+
+	for (unsigned tile = 0; tile < TILE_CACHE_TILES; tile++)
+	{
+		cache->tiles[tile].last_used = 0;
+		cache->tiles[tile].pixels = cache->pixels + (size_t)tile*PYRAMID_TILE_SIZE*PYRAMID_TILE_SIZE;
+	}
+
+	return 0;
+}
+
+/**
+ * Returns the colour of the given cell of the pyramid.
+ */
+static inline
+uint32_t cell_colour(const unsigned char cell)
+{
+	if (cell & PYRAMID_PATH_BIT)
+	{
+		return TILE_PATH_COLOUR;
+	}
+
+	// the share of the clear pixels as a shade of grey
+	const uint32_t grey = (cell*255 + PYRAMID_CLEAR_MAX/2)/PYRAMID_CLEAR_MAX;
+
+	return (grey << 16) | (grey << 8) | grey;
+}
+
+static void render_tile(const struct maze_pyramid *const pyramid, struct tile *const tile)
+{
+	const struct pyramid_level *const level = pyramid->level + tile->level;
+	const unsigned first_row = tile->row*PYRAMID_TILE_SIZE,
+	               first_col = tile->col*PYRAMID_TILE_SIZE;
+
+	tile->width = (level->width - first_col < PYRAMID_TILE_SIZE) ? level->width - first_col : PYRAMID_TILE_SIZE;
+	tile->height = (level->height - first_row < PYRAMID_TILE_SIZE) ? level->height - first_row : PYRAMID_TILE_SIZE;
+
+	for (unsigned row = 0; row < tile->height; row++)
+	{
+		uint32_t *const pixels = tile->pixels + (size_t)row*PYRAMID_TILE_SIZE;
+
+		for (unsigned col = 0; col < tile->width; col++)
+		{
+			pixels[col] = cell_colour(pyramid_cell(pyramid, tile->level, first_row + row, first_col + col));
+		}
+	}
+}
+
+const struct tile *lookup_tile(struct tile_cache *const cache, const unsigned level,
+                               const unsigned row, const unsigned col)
+{
+	struct tile *victim = cache->tiles;
+
+	cache->clock++;
+
+	for (unsigned tile = 0; tile < TILE_CACHE_TILES; tile++)
+	{
+		struct tile *const curr = cache->tiles + tile;
+
+		if (curr->last_used != 0 && curr->level == level && curr->row == row && curr->col == col)
+		{
+			curr->last_used = cache->clock;
+			return curr;
+		}
+
+		if (curr->last_used < victim->last_used)
+		{
+			victim = curr;
+		}
+	}
+
+	victim->level = level;
+	victim->row = row;
+	victim->col = col;
+	victim->last_used = cache->clock;
+	render_tile(cache->pyramid, victim);
+
+	return victim;
+}
+
+void delete_tile_cache(struct tile_cache *const cache)
+{
+	free(cache->pixels);
+	cache->pixels = NULL;
+}
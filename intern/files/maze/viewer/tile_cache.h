@@ -0,0 +1,58 @@
+#ifndef KS_MAZE_VIEWER_TILE_CACHE
+#define KS_MAZE_VIEWER_TILE_CACHE
+
+#include <stdint.h>
+#include "maze_pyramid.h"
+
+/**
+ * The tiles of the pyramid rendered for the screen.
+ *
+ * A tile is PYRAMID_TILE_SIZE cells on a side of a level of the pyramid
+ * rendered into 32-bit pixels (0x00RRGGBB, i.e., CAIRO_FORMAT_RGB24). Only
+ * the tiles that are visible are rendered. The least recently used tile is
+ * rendered over when the cache is full. A frame that only pans or zooms
+ * within a level draws the tiles from the cache.
+ */
+
+#define TILE_CACHE_TILES 256
+
+#define TILE_HURDLE_COLOUR 0x000000
+#define TILE_CLEAR_COLOUR 0xFFFFFF
+#define TILE_PATH_COLOUR 0xE02020
+
+struct tile
+{
+	unsigned level, row, col;  // the tile at (row, col) of the tiles of the level
+	unsigned width, height;    // cells in the tile (smaller at the right and bottom edges)
+	uint64_t last_used;        // 0 if unused
+	uint32_t *pixels;          // PYRAMID_TILE_SIZE pixels a row
+};
+
+struct tile_cache
+{
+	const struct maze_pyramid *pyramid;
+	struct tile tiles[TILE_CACHE_TILES];
+	uint32_t *pixels;          // the pixels of all the tiles
+	uint64_t clock;
+};
+
+/**
+ * Initialise an empty cache for the tiles of the given pyramid.
+ *
+ * Returns 0 on success and non-zero value on failure.
+ */
+int initialise_tile_cache(struct tile_cache *const cache, const struct maze_pyramid *const pyramid);
+
+/**
+ * Returns the tile at (row, col) of the given level, rendering it if it
+ * isn't in the cache. The tile is valid until TILE_CACHE_TILES other tiles
+ * have been looked up.
+ */
+const struct tile *lookup_tile(struct tile_cache *const cache, unsigned level, unsigned row, unsigned col);
+
+/**
+ * Free the memory held by the cache.
+ */
+void delete_tile_cache(struct tile_cache *const cache);
+
+#endif
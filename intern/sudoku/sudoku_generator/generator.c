@@ -0,0 +1,472 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "generator.h"
+#include "../sudoku_solver/sudoku_solver.h"
+#include "../sudoku_solver/puzzle_format.h"
+
+// the order and the number of cells of the largest table
+#define TABLE_ORDER_LARGEST (SQUARE_ORDER_MAX*SQUARE_ORDER_MAX)
+#define CELLS_MAX (TABLE_ORDER_LARGEST*TABLE_ORDER_LARGEST)
+
+// the guesses made to prove that a puzzle has a unique solution before giving up
+// on it (and keeping the clues that were to be removed)
+#define UNIQUENESS_GUESSES_MAX 1024
+
+// the random solutions tried in a row without finding a puzzle of the difficulty
+// asked for before giving up on it (the tables of some orders are too small to
+// need some of the techniques)
+#define DIFFICULTY_MISSES_MAX 100000
+
+/**
+  * The state shared by the generator threads. Every field below 'lock' is
+  * protected by it.
+  */
+struct generator
+{
+	const struct generator_options *options;
+	FILE *out;
+
+	pthread_mutex_t lock;
+	struct generator_stats *stats;
+	size_t misses;    // random solutions tried since the last puzzle was written
+	int status;       // ERRGENERATEWRITE once a puzzle couldn't be written or
+	                  // ERRGENERATEDIFFICULTY once there were too many misses
+};
+
+/**
+  * A generator thread and its random numbers.
+  */
+struct generator_thread
+{
+	struct generator *generator;
+	uint64_t random;  // the state of the random numbers (never 0)
+	pthread_t thread;
+};
+
+static double elapsed_seconds(const struct timespec *const start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec)/1e9;
+}
+
+void initialise_generator_options(struct generator_options *const options)
+{
+	const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+	options->square_order = 3;
+	options->threads = (processors > 0) ? processors : 1;
+	options->puzzles = 1;
+	options->difficulty = DIFFICULTY_ANY;
+	options->seed = time(NULL);
+}
+
+const char *difficulty_name(enum sudoku_difficulty difficulty)
+{
+	static const char *const names[DIFFICULTIES] = {
+		[DIFFICULTY_EASY]   = "easy",
+		[DIFFICULTY_MEDIUM] = "medium",
+		[DIFFICULTY_HARD]   = "hard",
+		[DIFFICULTY_EXPERT] = "expert"
+	};
+
+	return names[difficulty];
+}
+
+/**
+  * Returns the seed of the random numbers of the given thread ("splitmix64" of
+  * the seed and the thread), which is never 0.
+  */
+static uint64_t thread_seed(uint64_t seed, unsigned thread)
+{
+	uint64_t mixed = seed + (thread+1)*UINT64_C(0x9e3779b97f4a7c15);
+
+	mixed = (mixed ^ (mixed >> 30))*UINT64_C(0xbf58476d1ce4e5b9);
+	mixed = (mixed ^ (mixed >> 27))*UINT64_C(0x94d049bb133111eb);
+	mixed ^= mixed >> 31;
+
+	return (mixed != 0) ? mixed : 1;
+}
+
+/**
+  * Returns a random number in the range [0, bound) ("xorshift64*").
+  */
+static unsigned random_below(uint64_t *const random, unsigned bound)
+{
+	*random ^= *random >> 12;
+	*random ^= *random << 25;
+	*random ^= *random >> 27;
+
+	return ((*random*UINT64_C(0x2545f4914f6cdd1d)) >> 32)*bound >> 32;
+}
+
+/**
+  * Shuffle the given values (Fisher-Yates).
+  */
+static void shuffle(unsigned *const values, size_t count, uint64_t *const random)
+{
+	for (size_t index = count; index > 1; index--)
+	{
+		const size_t other = random_below(random, index);
+		const unsigned value = values[index-1];
+
+		values[index-1] = values[other];
+		values[other] = value;
+	}
+}
+
+/**
+  * Fill 'order' with a random order of the rows (or the columns) of a table that
+  * keeps the rows of a band together: the bands are shuffled and so are the rows
+  * in every band.
+  */
+static void shuffle_lines(unsigned *const order, unsigned square_order, uint64_t *const random)
+{
+	unsigned bands[SQUARE_ORDER_MAX], lines[SQUARE_ORDER_MAX];
+
+	for (unsigned band = 0; band < square_order; band++)
+	{
+		bands[band] = band;
+	}
+
+	shuffle(bands, square_order, random);
+
+	for (unsigned band = 0; band < square_order; band++)
+	{
+		for (unsigned line = 0; line < square_order; line++)
+		{
+			lines[line] = line;
+		}
+
+		shuffle(lines, square_order, random);
+
+		for (unsigned line = 0; line < square_order; line++)
+		{
+			order[band*square_order + line] = bands[band]*square_order + lines[line];
+		}
+	}
+}
+
+/**
+  * Fill 'solution' with a random solution of a table whose squares are of the
+  * given order.
+  *
+  * The squares on the diagonal share no row or column, so they are filled with
+  * random values and the rest is found by the solver. The solution is then
+  * shuffled by moving its rows and columns (within and along with their bands)
+  * and by renaming its values, which keeps it a solution.
+  */
+static void random_solution(unsigned square_order, unsigned *const solution, uint64_t *const random)
+{
+	const unsigned table_order = square_order*square_order;
+	unsigned table[CELLS_MAX], values[TABLE_ORDER_LARGEST+1];
+	unsigned rows[TABLE_ORDER_LARGEST], cols[TABLE_ORDER_LARGEST];
+
+	do
+	{
+		memset(table, 0, sizeof(table));
+
+		for (unsigned square = 0; square < square_order; square++)
+		{
+			for (unsigned value = 0; value < table_order; value++)
+			{
+				values[value] = value+1;
+			}
+
+			shuffle(values, table_order, random);
+
+			for (unsigned cell = 0; cell < table_order; cell++)
+			{
+				const unsigned row = square*square_order + cell/square_order;
+				const unsigned col = square*square_order + cell%square_order;
+
+				table[row*table_order + col] = values[cell];
+			}
+		}
+	}
+	while (!solve_sudoku_order(square_order, table, NULL));
+
+	// the new name of every value (values[0] stays 0)
+	values[0] = 0;
+
+	for (unsigned value = 1; value <= table_order; value++)
+	{
+		values[value] = value;
+	}
+
+	shuffle(values+1, table_order, random);
+	shuffle_lines(rows, square_order, random);
+	shuffle_lines(cols, square_order, random);
+
+	for (unsigned row = 0; row < table_order; row++)
+	{
+		for (unsigned col = 0; col < table_order; col++)
+		{
+			solution[row*table_order + col] = values[table[rows[row]*table_order + cols[col]]];
+		}
+	}
+}
+
+bool rate_sudoku(unsigned square_order, const unsigned *puzzle,
+		 enum sudoku_difficulty *const difficulty)
+{
+	const size_t cells = (size_t)square_order*square_order*square_order*square_order;
+	unsigned table[CELLS_MAX];
+	struct sudoku_stats moves;
+
+	if (square_order < SQUARE_ORDER_MIN || square_order > SQUARE_ORDER_MAX)
+	{
+		return false;
+	}
+
+	// the uniqueness is checked first as the search for a solution of a puzzle that
+	// has many of them could take long (and can't give up like the count)
+	if (count_sudoku_solutions(square_order, puzzle, 2, UNIQUENESS_GUESSES_MAX) != 1)
+	{
+		return false;
+	}
+
+	memcpy(table, puzzle, cells*sizeof(*puzzle));
+	solve_sudoku_techniques(square_order, SUDOKU_ALL_TECHNIQUES, table, &moves);
+
+	if (moves.guesses != 0)
+	{
+		*difficulty = DIFFICULTY_EXPERT;
+	}
+	else if (moves.naked_doubles != 0 || moves.pointing != 0 || moves.box_line != 0 ||
+		 moves.naked_triples != 0 || moves.hidden_pairs != 0 || moves.hidden_triples != 0 ||
+		 moves.x_wings != 0 || moves.swordfish != 0)
+	{
+		*difficulty = DIFFICULTY_HARD;
+	}
+	else if (moves.hidden_singles != 0)
+	{
+		*difficulty = DIFFICULTY_MEDIUM;
+	}
+	else
+	{
+		*difficulty = DIFFICULTY_EASY;
+	}
+
+	return true;
+}
+
+/**
+  * Returns true if the given puzzle could be kept while removing the clues: it
+  * has a unique solution and isn't harder than asked for.
+  *
+  * Only the uniqueness matters for puzzles of any difficulty, so they are
+  * checked by counting (at most 2 of) the solutions, which is much faster than
+  * solving them using every technique.
+  */
+static bool keep_puzzle(const struct generator_options *const options, const unsigned *const puzzle)
+{
+	enum sudoku_difficulty difficulty;
+
+	if (options->difficulty == DIFFICULTY_ANY)
+	{
+		return count_sudoku_solutions(options->square_order, puzzle, 2,
+					      UNIQUENESS_GUESSES_MAX) == 1;
+	}
+
+	return rate_sudoku(options->square_order, puzzle, &difficulty) &&
+	       difficulty <= options->difficulty;
+}
+
+/**
+  * Generate a puzzle from a random solution by removing the clues in symmetric
+  * pairs as long as it has a unique solution and isn't harder than asked for.
+  *
+  * Returns false if the puzzle is easier than asked for (the solution is to be
+  * thrown away).
+  */
+static bool generate_puzzle(const struct generator_options *const options, unsigned *const puzzle,
+			    enum sudoku_difficulty *const difficulty, uint64_t *const random)
+{
+	const size_t cells = (size_t)options->square_order*options->square_order*
+			     options->square_order*options->square_order;
+	unsigned pairs[(CELLS_MAX+1)/2];
+
+	random_solution(options->square_order, puzzle, random);
+
+	// the cell 'cell' pairs up with the cell 'cells-1-cell' (the centre with itself)
+	for (unsigned cell = 0; cell < (cells+1)/2; cell++)
+	{
+		pairs[cell] = cell;
+	}
+
+	shuffle(pairs, (cells+1)/2, random);
+
+	for (size_t pair = 0; pair < (cells+1)/2; pair++)
+	{
+		const size_t first = pairs[pair], second = cells-1-pairs[pair];
+		const unsigned first_clue = puzzle[first], second_clue = puzzle[second];
+
+		puzzle[first] = puzzle[second] = 0;
+
+		if (!keep_puzzle(options, puzzle))
+		{
+			puzzle[first] = first_clue;
+			puzzle[second] = second_clue;
+		}
+	}
+
+	rate_sudoku(options->square_order, puzzle, difficulty);
+
+	return options->difficulty == DIFFICULTY_ANY || *difficulty == options->difficulty;
+}
+
+/**
+  * The generator threads: generate puzzles until enough of them are written.
+  */
+static void *generator_thread(void *const data)
+{
+	struct generator_thread *const thread = data;
+	struct generator *const generator = thread->generator;
+	const struct generator_options *const options = generator->options;
+	const size_t cells = (size_t)options->square_order*options->square_order*
+			     options->square_order*options->square_order;
+	unsigned puzzle[CELLS_MAX];
+	char line[CELLS_MAX+16];
+
+	while (1)
+	{
+		pthread_mutex_lock(&generator->lock);
+		const bool done = generator->stats->puzzles == options->puzzles || generator->status != 0;
+		pthread_mutex_unlock(&generator->lock);
+
+		if (done)
+		{
+			break;
+		}
+
+		enum sudoku_difficulty difficulty;
+		const bool generated = generate_puzzle(options, puzzle, &difficulty, &thread->random);
+		unsigned clues = 0;
+
+		for (size_t cell = 0; cell < cells; cell++)
+		{
+			line[cell] = value_symbol(puzzle[cell]);
+			clues += (puzzle[cell] != 0);
+		}
+
+		snprintf(line+cells, sizeof(line)-cells, " %s\n", difficulty_name(difficulty));
+
+		pthread_mutex_lock(&generator->lock);
+
+		generator->stats->solutions++;
+
+		// another thread might have written the last puzzle in the meantime
+		if (generated && generator->stats->puzzles < options->puzzles && generator->status == 0)
+		{
+			if (fputs(line, generator->out) == EOF)
+			{
+				generator->status = ERRGENERATEWRITE;
+			}
+
+			generator->stats->puzzles++;
+			generator->stats->difficulties[difficulty]++;
+			generator->stats->clues += clues;
+			generator->misses = 0;
+		}
+		else if (!generated && ++generator->misses == DIFFICULTY_MISSES_MAX && generator->status == 0)
+		{
+			generator->status = ERRGENERATEDIFFICULTY;
+		}
+
+		pthread_mutex_unlock(&generator->lock);
+	}
+
+	return NULL;
+}
+
+int generate_sudoku_puzzles(FILE *const out, const struct generator_options *const options,
+			    struct generator_stats *const stats)
+{
+	struct generator generator = {
+		.options = options,
+		.out = out,
+		.stats = stats,
+		.misses = 0,
+		.status = 0
+	};
+
+	struct timespec start;
+	struct generator_thread *threads = NULL;
+	unsigned started = 0;
+	int ret_val = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	memset(stats, 0, sizeof(*stats));
+
+	if (options->square_order < SQUARE_ORDER_MIN || options->square_order > SQUARE_ORDER_MAX)
+	{
+		return ERRGENERATEORDER;
+	}
+
+	threads = malloc(options->threads*sizeof(struct generator_thread));
+
+	if (threads == NULL)
+	{
+		return ERRGENERATEMEMORY;
+	}
+
+	pthread_mutex_init(&generator.lock, NULL);
+
+	for (; started < options->threads; started++)
+	{
+		threads[started].generator = &generator;
+		threads[started].random = thread_seed(options->seed, started);
+
+		if (pthread_create(&threads[started].thread, NULL, generator_thread, &threads[started]) != 0)
+		{
+			break;
+		}
+	}
+
+	if (started == 0)
+	{
+		ret_val = ERRGENERATEMEMORY;
+		goto DESTROY_LOCK;
+	}
+
+	for (unsigned thread = 0; thread < started; thread++)
+	{
+		pthread_join(threads[thread].thread, NULL);
+	}
+
+	ret_val = generator.status;
+
+	if (ret_val == 0 && fflush(out) != 0)
+	{
+		ret_val = ERRGENERATEWRITE;
+	}
+
+DESTROY_LOCK:
+	pthread_mutex_destroy(&generator.lock);
+	free(threads);
+
+	stats->wall_seconds = elapsed_seconds(&start);
+	return ret_val;
+}
+
+void print_generator_stats(FILE *const stream, const struct generator_stats *const stats)
+{
+	fprintf(stream, "\nPuzzles: %zu (from %zu random solutions)\n", stats->puzzles, stats->solutions);
+	fprintf(stream, "Time: %.3f s (%.0f puzzles/s)\n", stats->wall_seconds,
+		(stats->wall_seconds > 0) ? stats->puzzles/stats->wall_seconds : 0.0);
+	fprintf(stream, "Clues: %.1f a puzzle\n",
+		(stats->puzzles > 0) ? (double) stats->clues/stats->puzzles : 0.0);
+
+	fprintf(stream, "\nPuzzles by difficulty:\n");
+
+	for (unsigned difficulty = 0; difficulty < DIFFICULTIES; difficulty++)
+	{
+		fprintf(stream, "\t%-16s %zu\n", difficulty_name(difficulty), stats->difficulties[difficulty]);
+	}
+}
@@ -0,0 +1,111 @@
+#ifndef KS_SUDOKU_GENERATOR_GENERATOR
+#define KS_SUDOKU_GENERATOR_GENERATOR
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+  * Generate sudoku puzzles that have a unique solution.
+  *
+  * A random solution is found for every puzzle and its clues are removed in pairs
+  * that are symmetric about the centre of the table (in a random order). A pair
+  * is put back when the puzzle no longer has a unique solution or gets harder
+  * than the difficulty asked for. The puzzles are rated using the moves the
+  * solver needed to solve them (see 'rate_sudoku').
+  *
+  * The puzzles are written a line each in the format read by the batch mode of
+  * the solver: a symbol every cell ('.' for an empty one) followed by the
+  * difficulty of the puzzle.
+  */
+
+/**
+  * Error codes
+  */
+#define ERRGENERATEWRITE 1
+#define ERRGENERATEMEMORY 2
+#define ERRGENERATEORDER 4
+#define ERRGENERATEDIFFICULTY 8
+
+/**
+  * The difficulty of a puzzle: the hardest move needed to solve it.
+  */
+enum sudoku_difficulty
+{
+	DIFFICULTY_EASY,    // naked singles
+	DIFFICULTY_MEDIUM,  // hidden singles
+	DIFFICULTY_HARD,    // the techniques beyond the singles (see 'sudoku_solver.h')
+	DIFFICULTY_EXPERT,  // guesses
+	DIFFICULTIES
+};
+
+/**
+  * Puzzles of any difficulty (as few clues as possible).
+  */
+#define DIFFICULTY_ANY DIFFICULTIES
+
+struct generator_options
+{
+	unsigned square_order;  // order of the squares of the tables (3 for 9*9 tables)
+	unsigned threads;       // number of generator threads
+	size_t puzzles;         // number of puzzles to be generated
+	unsigned difficulty;    // the difficulty of the puzzles or DIFFICULTY_ANY
+	uint64_t seed;          // seed of the random numbers of the first thread
+};
+
+/**
+  * Aggregate results of the puzzles generated.
+  */
+struct generator_stats
+{
+	size_t puzzles;                    // number of puzzles written
+	size_t difficulties[DIFFICULTIES]; // puzzles written, by difficulty
+	size_t solutions;                  // random solutions tried (the puzzles that missed
+	                                   // the difficulty are thrown away)
+	unsigned long long clues;          // clues of all the puzzles written
+	double wall_seconds;               // elapsed time for all the puzzles
+};
+
+/**
+  * Initialise the given options to their defaults: a 9*9 puzzle of any difficulty
+  * using a generator thread per online processor, seeded using the time.
+  */
+void initialise_generator_options(struct generator_options *const options);
+
+/**
+  * Returns the name of the given difficulty ("easy", "medium", ...).
+  */
+const char *difficulty_name(enum sudoku_difficulty difficulty);
+
+/**
+  * Rate the given puzzle whose squares are of the given order (the cells given
+  * row after row, 0 for an empty cell). The puzzle is solved using every technique
+  * of the solver and rated by the hardest move it needed.
+  *
+  * Returns false if the puzzle doesn't have a unique solution (or it couldn't be
+  * proven without too much guessing; see 'count_sudoku_solutions').
+  */
+bool rate_sudoku(unsigned square_order, const unsigned *puzzle,
+		 enum sudoku_difficulty *const difficulty);
+
+/**
+  * Generate the puzzles asked for in 'options' using a pool of threads and write
+  * them into 'out' (in the order they are found, so the puzzles are reproduced
+  * from a seed only by a single thread). The statistics are filled into 'stats'.
+  *
+  * Returns 0 on success, ERRGENERATEWRITE when the puzzles couldn't be written,
+  * ERRGENERATEMEMORY when the threads couldn't be set up, ERRGENERATEORDER when
+  * the order of the squares isn't supported or ERRGENERATEDIFFICULTY when too
+  * many random solutions in a row didn't give a puzzle of the difficulty asked
+  * for (the puzzles found until then are written).
+  */
+int generate_sudoku_puzzles(FILE *const out, const struct generator_options *const options,
+			    struct generator_stats *const stats);
+
+/**
+  * Print the given statistics to 'stream'.
+  */
+void print_generator_stats(FILE *const stream, const struct generator_stats *const stats);
+
+#endif
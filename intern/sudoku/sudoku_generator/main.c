@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include "generator.h"
+#include "../sudoku_solver/sudoku_solver.h"
+
+void print_usage(const char *const program)
+{
+	fprintf(stderr, "Usage: %s [options]\n\n", program);
+	fprintf(stderr, "Generate sudoku puzzles that have a unique solution, a puzzle a line.\n\n");
+	fprintf(stderr, "  -n, --order=<n>       order of the squares of the tables in [%u, %u]\n",
+		SQUARE_ORDER_MIN, SQUARE_ORDER_MAX);
+	fprintf(stderr, "                        (default: 3 i.e., 9*9 tables; 4 for 16*16 tables)\n");
+	fprintf(stderr, "  -c, --count=<n>       number of puzzles to be generated (default: 1)\n");
+	fprintf(stderr, "  -d, --difficulty=<d>  difficulty of the puzzles: easy, medium, hard, expert\n");
+	fprintf(stderr, "                        or any (default: any)\n");
+	fprintf(stderr, "  -o, --output=<file>   write the puzzles into the given file (default: stdout)\n");
+	fprintf(stderr, "  -j, --threads=<n>     number of generator threads (default: online processors)\n");
+	fprintf(stderr, "  -s, --seed=<n>        seed of the random numbers (default: the time)\n");
+}
+
+/**
+  * Parse a count (in the range [1, max]) given as an option argument.
+  *
+  * Returns 0 on success and non-zero value on failure.
+  */
+static int parse_count(const char *const arg, const unsigned long max, unsigned long *const count)
+{
+	char *end;
+	const unsigned long value = strtoul(arg, &end, 10);
+
+	if (*arg == '\0' || *end != '\0' || value == 0 || value > max)
+	{
+		fprintf(stderr, "Invalid count: %s\n", arg);
+		return 1;
+	}
+
+	*count = value;
+	return 0;
+}
+
+/**
+  * Parse a difficulty given as an option argument.
+  *
+  * Returns 0 on success and non-zero value on failure.
+  */
+static int parse_difficulty(const char *const arg, unsigned *const difficulty)
+{
+	if (strcmp(arg, "any") == 0)
+	{
+		*difficulty = DIFFICULTY_ANY;
+		return 0;
+	}
+
+	for (unsigned level = 0; level < DIFFICULTIES; level++)
+	{
+		if (strcmp(arg, difficulty_name(level)) == 0)
+		{
+			*difficulty = level;
+			return 0;
+		}
+	}
+
+	fprintf(stderr, "Invalid difficulty: %s\n", arg);
+	return 1;
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct option long_options[] = {
+		{ "order",      required_argument, NULL, 'n' },
+		{ "count",      required_argument, NULL, 'c' },
+		{ "difficulty", required_argument, NULL, 'd' },
+		{ "output",     required_argument, NULL, 'o' },
+		{ "threads",    required_argument, NULL, 'j' },
+		{ "seed",       required_argument, NULL, 's' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	struct generator_options options;
+	struct generator_stats stats;
+	const char *output = NULL;
+	FILE *out = stdout;
+	unsigned long count;
+	char *end;
+	int opt, generator_status;
+
+	initialise_generator_options(&options);
+
+	while ((opt = getopt_long(argc, argv, "n:c:d:o:j:s:", long_options, NULL)) != -1)
+	{
+		switch (opt)
+		{
+			case 'n':
+				if (parse_count(optarg, SQUARE_ORDER_MAX, &count))
+				{
+					return 1;
+				}
+
+				if (count < SQUARE_ORDER_MIN)
+				{
+					fprintf(stderr, "Invalid order: %s\n", optarg);
+					return 1;
+				}
+
+				options.square_order = count;
+				break;
+
+			case 'c':
+				if (parse_count(optarg, 1UL << 30, &count))
+				{
+					return 1;
+				}
+
+				options.puzzles = count;
+				break;
+
+			case 'd':
+				if (parse_difficulty(optarg, &options.difficulty))
+				{
+					return 1;
+				}
+				break;
+
+			case 'o':
+				output = optarg;
+				break;
+
+			case 'j':
+				if (parse_count(optarg, 4096, &count))
+				{
+					return 1;
+				}
+
+				options.threads = count;
+				break;
+
+			case 's':
+				options.seed = strtoull(optarg, &end, 10);
+
+				if (*optarg == '\0' || *end != '\0')
+				{
+					fprintf(stderr, "Invalid seed: %s\n", optarg);
+					return 1;
+				}
+				break;
+
+			default:
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if (optind < argc)
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (output != NULL && (out = fopen(output, "w")) == NULL)
+	{
+		fprintf(stderr, "Could not open the output: %s\n", output);
+		return 1;
+	}
+
+	generator_status = generate_sudoku_puzzles(out, &options, &stats);
+
+	if (generator_status == ERRGENERATEWRITE)
+	{
+		fprintf(stderr, "Could not write the puzzles!\n");
+	}
+	else if (generator_status == ERRGENERATEMEMORY)
+	{
+		fprintf(stderr, "Not enough memory to set up the generator!\n");
+	}
+	else if (generator_status == ERRGENERATEDIFFICULTY)
+	{
+		fprintf(stderr, "Could not find %s puzzles of the order %u!\n",
+			difficulty_name(options.difficulty), options.square_order);
+	}
+
+	if (generator_status != ERRGENERATEMEMORY)
+	{
+		print_generator_stats(stderr, &stats);
+	}
+
+	if (out != stdout && fclose(out) != 0 && generator_status == 0)
+	{
+		fprintf(stderr, "Could not write the puzzles!\n");
+		generator_status = ERRGENERATEWRITE;
+	}
+
+	return generator_status;
+}
@@ -0,0 +1,517 @@
+#include "common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "batch.h"
+#include "puzzle_format.h"
+
+/**
+  * A chunk of puzzles. The puzzles are held as the lines to be written and
+  * are solved in place.
+  */
+struct batch_chunk
+{
+	size_t puzzles;
+	char *lines;              // a line of a symbol for every cell for every puzzle
+	bool solved;
+	struct batch_stats stats; // the statistics of the puzzles of this chunk
+};
+
+/**
+  * The state shared by the threads of a batch. The chunks are used as a ring:
+  * the chunk with sequence number 'seq' is 'chunk[seq % options->in_flight]'.
+  * Every field below 'lock' is protected by it.
+  */
+struct batch
+{
+	const struct batch_options *options;
+	struct batch_chunk *chunk;
+	size_t cells;     // number of cells of a puzzle
+
+	pthread_mutex_t lock;
+	pthread_cond_t chunk_read;   // signalled when a chunk has been read (or the puzzles are over)
+	pthread_cond_t chunk_solved; // signalled when a chunk has been solved
+
+	size_t read;      // number of chunks read
+	size_t taken;     // number of chunks taken up by the solver threads
+	bool done;        // set when no more chunks would be read
+};
+
+static double elapsed_seconds(const struct timespec *const start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec)/1e9;
+}
+
+void initialise_batch_options(struct batch_options *const options)
+{
+	const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+	options->square_order = 3;
+	options->threads = (processors > 0) ? processors : 1;
+	options->chunk_puzzles = BATCH_CHUNK_PUZZLES;
+	options->in_flight = 4*options->threads;
+	options->techniques = SUDOKU_DEFAULT_TECHNIQUES;
+}
+
+/**
+  * Returns the bucket of the histogram for the given number of guesses (> 0).
+  */
+static unsigned guess_bucket(unsigned guesses)
+{
+	unsigned bucket = 0;
+
+	while (guesses > 1 && bucket < BATCH_GUESS_BUCKETS-1)
+	{
+		guesses >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+/**
+  * Count a puzzle solved with the given moves into 'stats'.
+  */
+static void count_puzzle(struct batch_stats *const stats, const bool solved,
+			 const struct sudoku_stats *const moves)
+{
+	const unsigned technique_moves[BATCH_TECHNIQUES] = {
+		[TECHNIQUE_NAKED_SINGLES]  = moves->naked_singles,
+		[TECHNIQUE_HIDDEN_SINGLES] = moves->hidden_singles,
+		[TECHNIQUE_POINTING]       = moves->pointing,
+		[TECHNIQUE_BOX_LINE]       = moves->box_line,
+		[TECHNIQUE_NAKED_DOUBLES]  = moves->naked_doubles,
+		[TECHNIQUE_NAKED_TRIPLES]  = moves->naked_triples,
+		[TECHNIQUE_HIDDEN_PAIRS]   = moves->hidden_pairs,
+		[TECHNIQUE_HIDDEN_TRIPLES] = moves->hidden_triples,
+		[TECHNIQUE_X_WING]         = moves->x_wings,
+		[TECHNIQUE_SWORDFISH]      = moves->swordfish
+	};
+	unsigned hardest = TECHNIQUE_NAKED_SINGLES;
+
+	stats->puzzles++;
+	stats->total_guesses += moves->guesses;
+
+	for (unsigned technique = 0; technique < BATCH_TECHNIQUES; technique++)
+	{
+		stats->moves[technique] += technique_moves[technique];
+
+		if (technique_moves[technique] != 0)
+		{
+			hardest = technique;
+		}
+	}
+
+	if (!solved)
+	{
+		stats->unsolvable++;
+		return;
+	}
+
+	stats->solved++;
+
+	if (moves->guesses != 0)
+	{
+		stats->guesses[guess_bucket(moves->guesses)]++;
+	}
+	else
+	{
+		stats->techniques[hardest]++;
+	}
+}
+
+/**
+  * Add the statistics of a chunk to those of the batch.
+  */
+static void add_stats(struct batch_stats *const stats, const struct batch_stats *const chunk_stats)
+{
+	stats->puzzles += chunk_stats->puzzles;
+	stats->solved += chunk_stats->solved;
+	stats->unsolvable += chunk_stats->unsolvable;
+
+	for (unsigned technique = 0; technique < BATCH_TECHNIQUES; technique++)
+	{
+		stats->techniques[technique] += chunk_stats->techniques[technique];
+		stats->moves[technique] += chunk_stats->moves[technique];
+	}
+
+	for (unsigned bucket = 0; bucket < BATCH_GUESS_BUCKETS; bucket++)
+	{
+		stats->guesses[bucket] += chunk_stats->guesses[bucket];
+	}
+
+	stats->total_guesses += chunk_stats->total_guesses;
+}
+
+/**
+  * Solve the puzzles of the given chunk in place.
+  */
+static void solve_chunk(const struct batch *const batch, struct batch_chunk *const chunk)
+{
+	unsigned table[SQUARE_ORDER_MAX*SQUARE_ORDER_MAX*SQUARE_ORDER_MAX*SQUARE_ORDER_MAX];
+	struct sudoku_stats moves;
+
+	for (size_t puzzle = 0; puzzle < chunk->puzzles; puzzle++)
+	{
+		char *const line = chunk->lines + puzzle*(batch->cells+1);
+
+		for (size_t cell = 0; cell < batch->cells; cell++)
+		{
+			table[cell] = symbol_value(line[cell]);
+		}
+
+		const bool solved = solve_sudoku_techniques(batch->options->square_order, batch->options->techniques,
+							   table, &moves);
+
+		for (size_t cell = 0; cell < batch->cells; cell++)
+		{
+			line[cell] = value_symbol(table[cell]);
+		}
+
+		count_puzzle(&chunk->stats, solved, &moves);
+	}
+}
+
+/**
+  * The solver threads: solve the chunks in the order they are read.
+  */
+static void *solver_thread(void *const arg)
+{
+	struct batch *const batch = arg;
+
+	pthread_mutex_lock(&batch->lock);
+
+	while (1)
+	{
+		while (batch->taken == batch->read && !batch->done)
+		{
+			pthread_cond_wait(&batch->chunk_read, &batch->lock);
+		}
+
+		if (batch->taken == batch->read)
+		{
+			break;
+		}
+
+		struct batch_chunk *const chunk = &batch->chunk[batch->taken % batch->options->in_flight];
+		batch->taken++;
+		pthread_mutex_unlock(&batch->lock);
+
+		solve_chunk(batch, chunk);
+
+		pthread_mutex_lock(&batch->lock);
+		chunk->solved = true;
+		pthread_cond_broadcast(&batch->chunk_solved);
+	}
+
+	pthread_mutex_unlock(&batch->lock);
+	return NULL;
+}
+
+/**
+  * Read the next chunk of puzzles from 'in'. 'line' and 'capacity' hold the
+  * buffer used to read the lines and 'line_number' the number of lines read.
+  *
+  * Returns 0 on success (the chunk is empty when the puzzles are over) and
+  * ERRBATCHREAD or ERRBATCHFORMAT on failure.
+  */
+static int read_chunk(FILE *const in, const struct batch *const batch, struct batch_chunk *const chunk,
+		      char **const line, size_t *const capacity, size_t *const line_number)
+{
+	const unsigned table_order = batch->options->square_order*batch->options->square_order;
+	unsigned cells[SQUARE_ORDER_MAX*SQUARE_ORDER_MAX*SQUARE_ORDER_MAX*SQUARE_ORDER_MAX];
+	ssize_t length;
+
+	chunk->puzzles = 0;
+
+	while (chunk->puzzles < batch->options->chunk_puzzles && (length = getline(line, capacity, in)) != -1)
+	{
+		(*line_number)++;
+
+		// ignore the line terminators (and any trailing whitespace)
+		while (length > 0 && ((*line)[length-1] == '\n' || (*line)[length-1] == '\r' ||
+				      (*line)[length-1] == ' ' || (*line)[length-1] == '\t'))
+		{
+			length--;
+		}
+
+		if (length == 0 || (*line)[0] == '#')
+		{
+			continue;
+		}
+
+		if (parse_puzzle(*line, length, table_order, cells))
+		{
+			return ERRBATCHFORMAT;
+		}
+
+		// the puzzle is kept as a symbol a cell (to be solved in place)
+		char *const puzzle = chunk->lines + chunk->puzzles*(batch->cells+1);
+
+		for (size_t cell = 0; cell < batch->cells; cell++)
+		{
+			puzzle[cell] = value_symbol(cells[cell]);
+		}
+
+		puzzle[batch->cells] = '\n';
+		chunk->puzzles++;
+	}
+
+	return ferror(in) ? ERRBATCHREAD : 0;
+}
+
+/**
+  * Wait for the chunk with the given sequence number to be solved and write
+  * its solutions into 'out' (unless it is NULL).
+  *
+  * Returns 0 on success and ERRBATCHWRITE on failure.
+  */
+static int write_chunk(struct batch *const batch, const size_t seq, FILE *const out,
+		       struct batch_stats *const stats)
+{
+	struct batch_chunk *const chunk = &batch->chunk[seq % batch->options->in_flight];
+
+	pthread_mutex_lock(&batch->lock);
+
+	while (!chunk->solved)
+	{
+		pthread_cond_wait(&batch->chunk_solved, &batch->lock);
+	}
+
+	pthread_mutex_unlock(&batch->lock);
+
+	add_stats(stats, &chunk->stats);
+
+	if (out != NULL && chunk->puzzles != 0 && fwrite(chunk->lines, chunk->puzzles*(batch->cells+1), 1, out) == 0)
+	{
+		return ERRBATCHWRITE;
+	}
+
+	return 0;
+}
+
+int solve_sudoku_batch(FILE *const in, FILE *const out, const struct batch_options *const options,
+		       struct batch_stats *const stats)
+{
+	struct batch batch = {
+		.options = options,
+		.cells = (size_t)options->square_order*options->square_order*options->square_order*options->square_order,
+		.read = 0,
+		.taken = 0,
+		.done = false
+	};
+
+	struct timespec start;
+	pthread_t *threads = NULL;
+	unsigned started = 0;
+	size_t written = 0, line_number = 0, capacity = 0;
+	char *line = NULL;
+	int ret_val = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	memset(stats, 0, sizeof(*stats));
+
+	if (options->square_order < SQUARE_ORDER_MIN || options->square_order > SQUARE_ORDER_MAX)
+	{
+		return ERRBATCHORDER;
+	}
+
+	batch.chunk = calloc(options->in_flight, sizeof(struct batch_chunk));
+	threads = malloc(options->threads*sizeof(pthread_t));
+
+	if (batch.chunk == NULL || threads == NULL)
+	{
+		ret_val = ERRBATCHMEMORY;
+		goto FREE_CHUNKS;
+	}
+
+	for (unsigned chunk = 0; chunk < options->in_flight; chunk++)
+	{
+		batch.chunk[chunk].lines = malloc((size_t)options->chunk_puzzles*(batch.cells+1));
+
+		if (batch.chunk[chunk].lines == NULL)
+		{
+			ret_val = ERRBATCHMEMORY;
+			goto FREE_CHUNKS;
+		}
+	}
+
+	pthread_mutex_init(&batch.lock, NULL);
+	pthread_cond_init(&batch.chunk_read, NULL);
+	pthread_cond_init(&batch.chunk_solved, NULL);
+
+	while (started < options->threads &&
+	       pthread_create(&threads[started], NULL, solver_thread, &batch) == 0)
+	{
+		started++;
+	}
+
+	if (started == 0)
+	{
+		ret_val = ERRBATCHMEMORY;
+		goto DESTROY_LOCKS;
+	}
+
+	while (1)
+	{
+		// every chunk is in flight; wait for the oldest one to be written
+		if (batch.read - written == options->in_flight)
+		{
+			if ((ret_val = write_chunk(&batch, written, out, stats)) != 0)
+			{
+				break;
+			}
+
+			written++;
+		}
+
+		// the chunk being read isn't in use by the solver threads
+		struct batch_chunk *const chunk = &batch.chunk[batch.read % options->in_flight];
+		const int read_status = read_chunk(in, &batch, chunk, &line, &capacity, &line_number);
+
+		chunk->solved = false;
+		memset(&chunk->stats, 0, sizeof(chunk->stats));
+
+		// the puzzles read before a line that isn't one are still solved
+		if (chunk->puzzles != 0)
+		{
+			pthread_mutex_lock(&batch.lock);
+			batch.read++;
+			pthread_cond_signal(&batch.chunk_read);
+			pthread_mutex_unlock(&batch.lock);
+		}
+
+		if (read_status != 0)
+		{
+			ret_val = read_status;
+
+			if (read_status == ERRBATCHFORMAT)
+			{
+				stats->error_line = line_number;
+			}
+
+			break;
+		}
+
+		if (chunk->puzzles < options->chunk_puzzles)
+		{
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&batch.lock);
+	batch.done = true;
+	pthread_cond_broadcast(&batch.chunk_read);
+	pthread_mutex_unlock(&batch.lock);
+
+	// write the rest of the chunks (only to wait for them after a write failed)
+	while (written < batch.read)
+	{
+		const int write_status = write_chunk(&batch, written, (ret_val == ERRBATCHWRITE) ? NULL : out, stats);
+
+		if (ret_val == 0)
+		{
+			ret_val = write_status;
+		}
+
+		written++;
+	}
+
+	for (unsigned thread = 0; thread < started; thread++)
+	{
+		pthread_join(threads[thread], NULL);
+	}
+
+	if (ret_val == 0 && fflush(out) != 0)
+	{
+		ret_val = ERRBATCHWRITE;
+	}
+
+DESTROY_LOCKS:
+	pthread_cond_destroy(&batch.chunk_solved);
+	pthread_cond_destroy(&batch.chunk_read);
+	pthread_mutex_destroy(&batch.lock);
+
+FREE_CHUNKS:
+	if (batch.chunk != NULL)
+	{
+		for (unsigned chunk = 0; chunk < options->in_flight; chunk++)
+		{
+			free(batch.chunk[chunk].lines);
+		}
+	}
+
+	free(line);
+	free(threads);
+	free(batch.chunk);
+
+	stats->wall_seconds = elapsed_seconds(&start);
+	return ret_val;
+}
+
+void print_batch_stats(FILE *const stream, const struct batch_stats *const stats)
+{
+	static const char *const technique_names[BATCH_TECHNIQUES] = {
+		[TECHNIQUE_NAKED_SINGLES]  = "naked singles",
+		[TECHNIQUE_HIDDEN_SINGLES] = "hidden singles",
+		[TECHNIQUE_POINTING]       = "pointing",
+		[TECHNIQUE_BOX_LINE]       = "box/line",
+		[TECHNIQUE_NAKED_DOUBLES]  = "naked doubles",
+		[TECHNIQUE_NAKED_TRIPLES]  = "naked triples",
+		[TECHNIQUE_HIDDEN_PAIRS]   = "hidden pairs",
+		[TECHNIQUE_HIDDEN_TRIPLES] = "hidden triples",
+		[TECHNIQUE_X_WING]         = "X-Wing",
+		[TECHNIQUE_SWORDFISH]      = "Swordfish"
+	};
+
+	fprintf(stream, "\nPuzzles: %zu (solved: %zu, no solution: %zu)\n",
+		stats->puzzles, stats->solved, stats->unsolvable);
+	fprintf(stream, "Time: %.3f s (%.0f puzzles/s)\n", stats->wall_seconds,
+		(stats->wall_seconds > 0) ? stats->puzzles/stats->wall_seconds : 0.0);
+
+	fprintf(stream, "\nSolved without guessing, by the hardest technique needed:\n");
+
+	for (unsigned technique = 0; technique < BATCH_TECHNIQUES; technique++)
+	{
+		fprintf(stream, "\t%-16s %zu\n", technique_names[technique], stats->techniques[technique]);
+	}
+
+	fprintf(stream, "\nSolved by guessing, by the number of guesses:\n");
+
+	for (unsigned bucket = 0; bucket < BATCH_GUESS_BUCKETS; bucket++)
+	{
+		char range[32];
+		const unsigned first = 1u << bucket;
+
+		if (bucket == BATCH_GUESS_BUCKETS-1)
+		{
+			snprintf(range, sizeof(range), "%u+", first);
+		}
+		else if (first == 1)
+		{
+			snprintf(range, sizeof(range), "%u", first);
+		}
+		else
+		{
+			snprintf(range, sizeof(range), "%u-%u", first, 2*first-1);
+		}
+
+		fprintf(stream, "\t%-16s %zu\n", range, stats->guesses[bucket]);
+	}
+
+	fprintf(stream, "\nMoves made, by technique:\n");
+
+	for (unsigned technique = 0; technique < BATCH_TECHNIQUES; technique++)
+	{
+		fprintf(stream, "\t%-16s %llu\n", technique_names[technique], stats->moves[technique]);
+	}
+
+	fprintf(stream, "\t%-16s %llu\n", "guesses", stats->total_guesses);
+}
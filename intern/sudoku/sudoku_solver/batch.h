@@ -0,0 +1,117 @@
+#ifndef KS_SUDOKU_SOLVER_BATCH
+#define KS_SUDOKU_SOLVER_BATCH
+
+#include <stdio.h>
+#include <stddef.h>
+#include "sudoku_solver.h"
+
+/**
+  * Batch mode: solve many sudoku tables in a single process.
+  *
+  * Every puzzle is a line: the cells of the table row after row, a symbol
+  * every cell (81 characters for a 9*9 table) or separated by whitespace (see
+  * 'puzzle_format.h'). '0' or '.' is a cell that is yet to be filled. Whatever
+  * follows the cells in the line is ignored. Empty lines and lines starting
+  * with '#' are skipped.
+  *
+  * The puzzles are read in chunks that are solved by a pool of threads. The
+  * solutions are written a symbol every cell in the order of the puzzles.
+  * At most a few chunks per thread are held in memory at a time.
+  */
+
+/**
+  * Error codes
+  */
+#define ERRBATCHREAD 1
+#define ERRBATCHFORMAT 2
+#define ERRBATCHWRITE 4
+#define ERRBATCHMEMORY 8
+#define ERRBATCHORDER 16
+
+/**
+  * The number of puzzles in a chunk (by default).
+  */
+#define BATCH_CHUNK_PUZZLES 256
+
+struct batch_options
+{
+	unsigned square_order;  // order of the squares of the tables (3 for 9*9 tables)
+	unsigned threads;       // number of solver threads
+	unsigned chunk_puzzles; // number of puzzles solved by a thread at a time
+	unsigned in_flight;     // maximum number of chunks held in memory at a time
+	unsigned techniques;    // techniques applied besides the singles (SUDOKU_* flags)
+};
+
+/**
+  * The techniques, from the easiest to the hardest. The hardest one needed by
+  * the puzzles solved without guessing is counted.
+  */
+enum batch_technique
+{
+	TECHNIQUE_NAKED_SINGLES,
+	TECHNIQUE_HIDDEN_SINGLES,
+	TECHNIQUE_POINTING,
+	TECHNIQUE_BOX_LINE,
+	TECHNIQUE_NAKED_DOUBLES,
+	TECHNIQUE_NAKED_TRIPLES,
+	TECHNIQUE_HIDDEN_PAIRS,
+	TECHNIQUE_HIDDEN_TRIPLES,
+	TECHNIQUE_X_WING,
+	TECHNIQUE_SWORDFISH,
+	BATCH_TECHNIQUES
+};
+
+/**
+  * The puzzles that needed guessing are counted by the number of guesses
+  * in buckets of powers of two: 1, 2-3, 4-7, ... and the rest.
+  */
+#define BATCH_GUESS_BUCKETS 10
+
+/**
+  * Aggregate results of a batch.
+  */
+struct batch_stats
+{
+	size_t puzzles;        // number of puzzles read
+	size_t solved;         // number of puzzles solved completely
+	size_t unsolvable;     // number of puzzles that have no solution
+	size_t error_line;     // the line that isn't a puzzle (for ERRBATCHFORMAT)
+
+	size_t techniques[BATCH_TECHNIQUES];     // puzzles solved without guessing
+	size_t guesses[BATCH_GUESS_BUCKETS];     // puzzles solved by guessing
+
+	// the moves made for all the puzzles
+	unsigned long long moves[BATCH_TECHNIQUES];
+	unsigned long long total_guesses;
+
+	double wall_seconds;   // elapsed time for the whole batch
+};
+
+/**
+  * Initialise the given options to their defaults: 9*9 tables, a solver thread
+  * per online processor, BATCH_CHUNK_PUZZLES puzzles a chunk, four chunks
+  * in flight per solver thread and SUDOKU_DEFAULT_TECHNIQUES.
+  */
+void initialise_batch_options(struct batch_options *const options);
+
+/**
+  * Solve the puzzles read from 'in' and write their solutions into 'out'. The
+  * solution of a puzzle that has no solution is filled only as far as the
+  * techniques could ('.' for the cells left empty). The statistics of the batch
+  * are filled into 'stats'.
+  *
+  * Returns 0 on success, ERRBATCHREAD or ERRBATCHWRITE when the puzzles couldn't
+  * be read or the solutions couldn't be written, ERRBATCHFORMAT when a line isn't
+  * a puzzle (the puzzles before it are solved), ERRBATCHMEMORY when the batch
+  * couldn't be set up or ERRBATCHORDER when the order of the squares isn't
+  * supported.
+  */
+int solve_sudoku_batch(FILE *const in, FILE *const out, const struct batch_options *const options,
+		       struct batch_stats *const stats);
+
+/**
+  * Print the given statistics to 'stream'.
+  */
+void print_batch_stats(FILE *const stream, const struct batch_stats *const stats);
+
+#endif
@@ -1,13 +1,13 @@
 #include <stdio.h>
 #include "common.h"
 
-void print_table(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
+void print_table(const unsigned *sudoku_table, size_t table_order)
 {
-       for (size_t row=0; row<TABLE_ORDER_MAX; row++)
+       for (size_t row=0; row<table_order; row++)
        {
-               for (size_t col=0; col<TABLE_ORDER_MAX; col++)
+               for (size_t col=0; col<table_order; col++)
                {
-                       printf("%u\t", sudoku_table[row][col]);
+                       printf("%u\t", sudoku_table[row*table_order + col]);
                }
                printf("\n\n");
        }
@@ -2,13 +2,10 @@
 #define KS_SUDOKE_SOLVER_COMMON
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "sudoku_solver.h"
 
-#define MIN_VALUE 1
-#define MAX_VALUE 9
-#define NUMBER_OF_VALUES 9
-#define SQUARE_DIMENSION 3
-
 /**** DEV ****/
 //#define KS_SUDOKU_DEBUG
 //#define KS_SUDOKU_DEBUG_NAKED_DOUBLE_SEARCH
@@ -18,29 +15,30 @@
 /**** DEV *****/
 
 /**
-  * Type to hold the possible values for a cell (identified by row and column).
+  * The solvers specialised for every order of the squares (see 'solver_kernel.h').
+  * The cells of the table are given row after row and only the given techniques
+  * (SUDOKU_* flags) are applied besides the singles.
   */
-struct possible_entries
-{
-	// an index is set to 'true' if the corresponding value is possible.
-	// Indexed from 1 to MAX_VALUE.
-	bool possible[MAX_VALUE+1];
-
-	// the number of possible values for a cell
-	unsigned possibilities;
-};
+bool solve_sudoku_order_2(unsigned *sudoku_table, unsigned techniques, struct sudoku_stats *stats);
+bool solve_sudoku_order_3(unsigned *sudoku_table, unsigned techniques, struct sudoku_stats *stats);
+bool solve_sudoku_order_4(unsigned *sudoku_table, unsigned techniques, struct sudoku_stats *stats);
+bool solve_sudoku_order_5(unsigned *sudoku_table, unsigned techniques, struct sudoku_stats *stats);
 
-/*
- * Type to hold the naked double values.
- */
-struct naked_double_values
-{
-	unsigned vals[2];
-};
+/**
+  * The functions counting the solutions for every order of the squares.
+  */
+unsigned count_sudoku_solutions_order_2(const unsigned *sudoku_table, unsigned limit,
+					unsigned max_guesses);
+unsigned count_sudoku_solutions_order_3(const unsigned *sudoku_table, unsigned limit,
+					unsigned max_guesses);
+unsigned count_sudoku_solutions_order_4(const unsigned *sudoku_table, unsigned limit,
+					unsigned max_guesses);
+unsigned count_sudoku_solutions_order_5(const unsigned *sudoku_table, unsigned limit,
+					unsigned max_guesses);
 
 /**
-  * Print the sudoku table to 'stdout'.
+  * Print the sudoku table (of the given order) to 'stdout'.
   */
-void print_table(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX]);
+void print_table(const unsigned *sudoku_table, size_t table_order);
 
 #endif
@@ -1,42 +1,315 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
 #include "common.h"
 #include "sudoku_solver.h"
+#include "batch.h"
+#include "puzzle_format.h"
 
-void print_welcome_message(void)
+// the number of cells of the largest table
+#define CELLS_MAX (SQUARE_ORDER_MAX*SQUARE_ORDER_MAX*SQUARE_ORDER_MAX*SQUARE_ORDER_MAX)
+
+void print_welcome_message(unsigned table_order)
 {
 	printf("\n\tWelcome to the Sudoku solver!\n");
 	printf("\nIt tries to solve sudoku by using the following techniques:\n\n");
-	printf("\t1. Naked single detection\n\t2. Hidden single detection\n\t3. Naked double detection\n\n");
+	printf("\t1. Naked single detection\n\t2. Hidden single detection\n");
+	printf("\t3. Naked double detection, pointing pairs and box/line reduction\n");
+	printf("\t4. Searching (with the above) when they don't suffice\n\n");
 	printf("Enter a VALID sudoku table:\n");
 	printf("A VALID sudoku table satisfies the following criteria\n");
-	printf("\t- It is a 9*9 table\n");
+	printf("\t- It is a %u*%u table\n", table_order, table_order);
 	printf("\t- A cell that is yet to be filled is represented by 0\n");
-	printf("\t- A cell only has valid entries [0, 9]\n");
+	printf("\t- A cell only has valid entries [0, %u]\n", table_order);
 }
 
-void get_table(unsigned int table[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
+/**
+  * Read a table of the given order (the cells separated by whitespace).
+  *
+  * Returns 0 on success and non-zero value if a cell isn't valid.
+  */
+int get_table(unsigned *table, unsigned table_order)
 {
-	for (size_t row=0; row<TABLE_ORDER_MAX; row++)
+	char symbol[8];
+
+	for (size_t cell=0; cell<(size_t)table_order*table_order; cell++)
 	{
-		for (size_t col=0; col<TABLE_ORDER_MAX; col++)
+		if (scanf("%7s", symbol) != 1 ||
+		    parse_symbol(symbol, strlen(symbol), table_order, &table[cell]))
 		{
-			scanf("%u", &table[row][col]);
+			return 1;
 		}
 	}
+
+	return 0;
 }
 
-void print_solution(unsigned int table[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
+void print_solution(unsigned *table, unsigned table_order, bool solved)
 {
 	printf("\nSolved table:\n");
-	print_table(table);
-	printf("Note: Solutions might be partial if the table cannot be solved using techniques mentioned before.\n");
+	print_table(table, table_order);
+
+	if (!solved)
+	{
+		printf("Note: The table has no solution. It is filled only as far as the techniques could.\n");
+	}
+}
+
+void print_usage(const char *const program)
+{
+	fprintf(stderr, "Usage: %s [options]\n\n", program);
+	fprintf(stderr, "Without options a single table is read from 'stdin' and solved.\n\n");
+	fprintf(stderr, "  -n, --order=<n>       order of the squares of the tables in [%u, %u]\n",
+		SQUARE_ORDER_MIN, SQUARE_ORDER_MAX);
+	fprintf(stderr, "                        (default: 3 i.e., 9*9 tables; 4 for 16*16 tables)\n");
+	fprintf(stderr, "  -b, --batch=<file>    solve the puzzles in the given file ('-' for stdin),\n");
+	fprintf(stderr, "                        a puzzle a line: the n^4 cells of the table (81 for\n");
+	fprintf(stderr, "                        the order 3) row after row, a character a cell or\n");
+	fprintf(stderr, "                        separated by whitespace ('0' or '.' for an empty cell)\n");
+	fprintf(stderr, "  -o, --output=<file>   write the solutions into the given file (default: stdout)\n");
+	fprintf(stderr, "  -j, --threads=<n>     number of solver threads (default: online processors)\n");
+	fprintf(stderr, "  -k, --chunk=<n>       number of puzzles solved by a thread at a time (default: %u)\n",
+		BATCH_CHUNK_PUZZLES);
+	fprintf(stderr, "  -t, --techniques=<list>\n");
+	fprintf(stderr, "                        techniques applied besides the singles, separated by\n");
+	fprintf(stderr, "                        commas: naked-doubles, pointing, box-line, naked-triples,\n");
+	fprintf(stderr, "                        hidden-pairs, hidden-triples, x-wing, swordfish, all or\n");
+	fprintf(stderr, "                        none (default: naked-doubles,pointing,box-line)\n");
+}
+
+/**
+  * Parse a count (in the range [1, max]) given as an option argument.
+  *
+  * Returns 0 on success and non-zero value on failure.
+  */
+static int parse_count(const char *const arg, const unsigned long max, unsigned *const count)
+{
+	char *end;
+	const unsigned long value = strtoul(arg, &end, 10);
+
+	if (*arg == '\0' || *end != '\0' || value == 0 || value > max)
+	{
+		fprintf(stderr, "Invalid count: %s\n", arg);
+		return 1;
+	}
+
+	*count = value;
+	return 0;
+}
+
+/**
+  * Parse a list of techniques separated by commas given as an option argument.
+  *
+  * Returns 0 on success and non-zero value on failure.
+  */
+static int parse_techniques(const char *arg, unsigned *const techniques)
+{
+	static const struct
+	{
+		const char *name;
+		unsigned techniques;
+	} names[] = {
+		{ "naked-doubles",  SUDOKU_NAKED_DOUBLES },
+		{ "pointing",       SUDOKU_POINTING },
+		{ "box-line",       SUDOKU_BOX_LINE },
+		{ "naked-triples",  SUDOKU_NAKED_TRIPLES },
+		{ "hidden-pairs",   SUDOKU_HIDDEN_PAIRS },
+		{ "hidden-triples", SUDOKU_HIDDEN_TRIPLES },
+		{ "x-wing",         SUDOKU_X_WING },
+		{ "swordfish",      SUDOKU_SWORDFISH },
+		{ "all",            SUDOKU_ALL_TECHNIQUES },
+		{ "none",           0 }
+	};
+
+	*techniques = 0;
+
+	while (1)
+	{
+		const size_t length = strcspn(arg, ",");
+		size_t name = 0;
+
+		while (name < sizeof(names)/sizeof(names[0]) &&
+		       (strlen(names[name].name) != length || strncmp(arg, names[name].name, length) != 0))
+		{
+			name++;
+		}
+
+		if (name == sizeof(names)/sizeof(names[0]))
+		{
+			fprintf(stderr, "Invalid technique: %.*s\n", (int) length, arg);
+			return 1;
+		}
+
+		*techniques |= names[name].techniques;
+
+		if (arg[length] == '\0')
+		{
+			return 0;
+		}
+
+		arg += length+1;
+	}
+}
+
+/**
+  * Solve the puzzles in the given file and write their solutions into 'output'.
+  * The statistics of the batch are printed to 'stderr'.
+  *
+  * Returns the exit status of the program.
+  */
+static int solve_batch(const char *const source, const char *const output,
+		       const struct batch_options *const options)
+{
+	FILE *const in = (strcmp(source, "-") == 0) ? stdin : fopen(source, "r");
+	FILE *out = stdout;
+	struct batch_stats stats;
+	int batch_status = 1;
+
+	if (in == NULL)
+	{
+		fprintf(stderr, "Could not open the puzzles: %s\n", source);
+		return 1;
+	}
+
+	if (output != NULL && (out = fopen(output, "w")) == NULL)
+	{
+		fprintf(stderr, "Could not open the output: %s\n", output);
+		goto CLOSE_IN;
+	}
+
+	batch_status = solve_sudoku_batch(in, out, options, &stats);
+
+	if (batch_status == ERRBATCHREAD)
+	{
+		fprintf(stderr, "Could not read the puzzles from: %s\n", source);
+	}
+	else if (batch_status == ERRBATCHFORMAT)
+	{
+		fprintf(stderr, "Line %zu of %s is not a puzzle\n", stats.error_line, source);
+	}
+	else if (batch_status == ERRBATCHWRITE)
+	{
+		fprintf(stderr, "Could not write the solutions!\n");
+	}
+	else if (batch_status == ERRBATCHMEMORY)
+	{
+		fprintf(stderr, "Not enough memory to set up the batch!\n");
+	}
+
+	if (batch_status != ERRBATCHMEMORY)
+	{
+		print_batch_stats(stderr, &stats);
+	}
+
+	if (out != stdout && fclose(out) != 0 && batch_status == 0)
+	{
+		fprintf(stderr, "Could not write the solutions!\n");
+		batch_status = ERRBATCHWRITE;
+	}
+
+CLOSE_IN:
+	if (in != stdin)
+	{
+		fclose(in);
+	}
+
+	return batch_status;
 }
 
-int main(void)
+int main(int argc, char *argv[])
 {
-	unsigned table[TABLE_ORDER_MAX][TABLE_ORDER_MAX] = {0};
-	print_welcome_message();
-	get_table(table);
-	solve_sudoku(table);
-	print_solution(table);
+	static const struct option long_options[] = {
+		{ "order",   required_argument, NULL, 'n' },
+		{ "batch",   required_argument, NULL, 'b' },
+		{ "output",  required_argument, NULL, 'o' },
+		{ "threads", required_argument, NULL, 'j' },
+		{ "chunk",   required_argument, NULL, 'k' },
+		{ "techniques", required_argument, NULL, 't' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	struct batch_options options;
+	const char *source = NULL, *output = NULL;
+	int opt;
+
+	initialise_batch_options(&options);
+
+	while ((opt = getopt_long(argc, argv, "n:b:o:j:k:t:", long_options, NULL)) != -1)
+	{
+		switch (opt)
+		{
+			case 'n':
+				if (parse_count(optarg, SQUARE_ORDER_MAX, &options.square_order))
+				{
+					return 1;
+				}
+
+				if (options.square_order < SQUARE_ORDER_MIN)
+				{
+					fprintf(stderr, "Invalid order: %s\n", optarg);
+					return 1;
+				}
+				break;
+
+			case 'b':
+				source = optarg;
+				break;
+
+			case 'o':
+				output = optarg;
+				break;
+
+			case 'j':
+				if (parse_count(optarg, 4096, &options.threads))
+				{
+					return 1;
+				}
+				options.in_flight = 4*options.threads;
+				break;
+
+			case 'k':
+				if (parse_count(optarg, 1 << 20, &options.chunk_puzzles))
+				{
+					return 1;
+				}
+				break;
+
+			case 't':
+				if (parse_techniques(optarg, &options.techniques))
+				{
+					return 1;
+				}
+				break;
+
+			default:
+				print_usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if (optind < argc || (source == NULL && output != NULL))
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	if (source != NULL)
+	{
+		return solve_batch(source, output, &options);
+	}
+
+	const unsigned table_order = options.square_order*options.square_order;
+	unsigned table[CELLS_MAX] = {0};
+
+	print_welcome_message(table_order);
+
+	if (get_table(table, table_order))
+	{
+		fprintf(stderr, "Invalid sudoku table!\n");
+		return 1;
+	}
+
+	const bool solved = solve_sudoku_techniques(options.square_order, options.techniques, table, NULL);
+	print_solution(table, table_order, solved);
 }
@@ -1,51 +1,143 @@
 #ifndef KS_SUDOKE_SOLVER_NAKED_SINGLE_QUEUE
 #define KS_SUDOKE_SOLVER_NAKED_SINGLE_QUEUE
 
+/**
+  * The queue of the "naked single" moves to be done.
+  *
+  * Every solve has a queue of its own (in its 'possible_entries'), so tables
+  * could be solved in many threads at once. It is a ring with a slot for every
+  * cell of the table. A cell is queued at most once at a time (the cells queued
+  * are kept in a bitset), so the ring never overflows and no memory is allocated.
+  *
+  * It is included by 'solver_order.h' once 'TABLE_ORDER' is defined.
+  */
+
+#ifndef TABLE_ORDER
+#error "TABLE_ORDER must be defined to the order of the table"
+#endif
+
+#include <stdbool.h>
 #include <stddef.h>
-#include <sys/queue.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef KS_SUDOKU_DEBUG
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+#define NAKED_SINGLE_SLOTS (TABLE_ORDER*TABLE_ORDER)
+#define NAKED_SINGLE_WORDS ((NAKED_SINGLE_SLOTS+63)/64)
 
 /**
-  * The tail-queue that holds the "naked single" moves to be done.
+  * A "naked single" move (identified by [row, col]).
   */
 struct naked_single
 {
 	size_t row, col;
-	STAILQ_ENTRY(naked_single) entries;     /* Tail queue. */
+};
+
+struct naked_single_queue
+{
+	uint16_t cell[NAKED_SINGLE_SLOTS];    // the cells queued (row*TABLE_ORDER + col)
+	uint64_t queued[NAKED_SINGLE_WORDS];  // the bit of every cell in the queue
+	unsigned first, size;
 };
 
 /**
-  * Initialises the head of the naked single queue.
-  * It is a singleton function i.e., initialisation is done only once.
-  * Redundant calls have no effect.
+  * Initialises the given queue to be empty.
   */
-void initialise_naked_single_queue(void);
+static inline void initialise_naked_single_queue(struct naked_single_queue *queue)
+{
+	memset(queue->queued, 0, sizeof(queue->queued));
+	queue->first = 0;
+	queue->size = 0;
+}
 
 /**
-  * Inserts a "naked single" move (identified by [row, col]) into the tail-queue.
+  * Inserts a "naked single" move (identified by [row, col]) into the queue
+  * unless it is already in it.
   */
-void insert_naked_single(size_t row, size_t col);
+static inline void insert_naked_single(struct naked_single_queue *queue, size_t row, size_t col)
+{
+
+#ifdef KS_SUDOKU_DEBUG
+	if (row >= TABLE_ORDER || col >= TABLE_ORDER)
+	{
+		fprintf(stderr, "insert_naked_single: invalid insertion\n"
+				"row: %zu, col: %zu", row, col);
+		exit(EXIT_FAILURE);
+	}
+#endif
+
+	const unsigned cell = row*TABLE_ORDER + col;
+	const uint64_t cell_bit = UINT64_C(1) << (cell%64);
+
+	if (queue->queued[cell/64] & cell_bit)
+	{
+		return;
+	}
+
+	queue->queued[cell/64] |= cell_bit;
+
+	unsigned last = queue->first + queue->size++;
+
+	if (last >= NAKED_SINGLE_SLOTS)
+	{
+		last -= NAKED_SINGLE_SLOTS;
+	}
+
+	queue->cell[last] = cell;
+}
 
 /**
   * Returns 'true' when there are naked single moves available.
   * Else returns 'false'.
   */
-int is_naked_single_available(void);
+static inline bool is_naked_single_available(const struct naked_single_queue *queue)
+{
+	return queue->size != 0;
+}
 
 /**
-  * Returns the first node in the naked single queue.
+  * Remove the first move in the (non-empty) queue and return it.
   */
-struct naked_single *get_first_naked_single(void);
+static inline struct naked_single remove_first_naked_single(struct naked_single_queue *queue)
+{
+	const unsigned cell = queue->cell[queue->first];
+
+	queue->queued[cell/64] &= ~(UINT64_C(1) << (cell%64));
+	queue->size--;
+
+	if (++queue->first == NAKED_SINGLE_SLOTS)
+	{
+		queue->first = 0;
+	}
+
+	return (struct naked_single) { .row = cell/TABLE_ORDER, .col = cell%TABLE_ORDER };
+}
 
 /**
-  * Prints the nodes in the naked single queue.
+  * Remove all the moves in the queue.
   */
-void print_naked_singles(void);
+static inline void clear_naked_singles(struct naked_single_queue *queue)
+{
+	initialise_naked_single_queue(queue);
+}
 
+#ifdef KS_SUDOKU_DEBUG
 /**
-  * Remove the first node in the naked single queue.
-  * Memory for the node is not free()d automatically. It must
-  * be done manually by obtaining the node using 'get_first_naked_single'
+  * Prints the moves in the queue.
   */
-void remove_first_naked_single(void);
+static inline void print_naked_singles(const struct naked_single_queue *queue)
+{
+	for (unsigned index = 0; index < queue->size; index++)
+	{
+		const unsigned cell = queue->cell[(queue->first + index) % NAKED_SINGLE_SLOTS];
+
+		printf("%u\t%u\n", cell/TABLE_ORDER, cell%TABLE_ORDER);
+	}
+}
+#endif
 
 #endif
@@ -0,0 +1,85 @@
+#include <ctype.h>
+#include "puzzle_format.h"
+
+int parse_symbol(const char *symbol, size_t length, unsigned table_order, unsigned *value)
+{
+	if (length == 1 && (symbol[0] == '.' || symbol[0] == '0'))
+	{
+		*value = 0;
+		return 0;
+	}
+
+	if (length == 1 && table_order > 9 && isalpha((unsigned char)symbol[0]))
+	{
+		*value = toupper((unsigned char)symbol[0]) - 'A' + 10;
+		return *value > table_order;
+	}
+
+	// a decimal number without leading zeroes
+	if (length == 0 || length > 2 || symbol[0] == '0')
+	{
+		return 1;
+	}
+
+	*value = 0;
+
+	for (size_t index=0; index<length; index++)
+	{
+		if (!isdigit((unsigned char)symbol[index]))
+		{
+			return 1;
+		}
+
+		*value = *value*10 + (symbol[index] - '0');
+	}
+
+	return *value > table_order;
+}
+
+int parse_puzzle(const char *line, size_t length, unsigned table_order, unsigned *cells)
+{
+	const size_t num_cells = (size_t)table_order*table_order;
+	size_t cell = 0, index = 0;
+
+	// the cells are written one character after another
+	while (index < length && index < num_cells && !isspace((unsigned char)line[index]))
+	{
+		index++;
+	}
+
+	if (index == num_cells)
+	{
+		for (cell=0; cell<num_cells; cell++)
+		{
+			if (parse_symbol(line+cell, 1, table_order, &cells[cell]))
+			{
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+
+	// the cells are separated by whitespace
+	for (index=0; cell<num_cells; cell++)
+	{
+		while (index < length && isspace((unsigned char)line[index]))
+		{
+			index++;
+		}
+
+		const size_t start = index;
+
+		while (index < length && !isspace((unsigned char)line[index]))
+		{
+			index++;
+		}
+
+		if (parse_symbol(line+start, index-start, table_order, &cells[cell]))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
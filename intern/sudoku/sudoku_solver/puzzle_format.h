@@ -0,0 +1,51 @@
+#ifndef KS_SUDOKU_SOLVER_PUZZLE_FORMAT
+#define KS_SUDOKU_SOLVER_PUZZLE_FORMAT
+
+#include <stddef.h>
+
+/**
+  * The symbols of the values of the cells.
+  *
+  * A value is written as a single character: '1' to '9' and then 'A' for 10,
+  * 'B' for 11 and so on ('P' for 25). An empty cell is written as '.'.
+  *
+  * When reading, a value could also be a (multi-character) decimal number
+  * ("10", "16", "25", ...) and an empty cell '0'. The letters are read only for
+  * tables that have more than 9 values (in either case).
+  */
+
+/**
+  * Returns the symbol of the given value (0 for an empty cell).
+  */
+static inline char value_symbol(unsigned value)
+{
+	return (value == 0) ? '.' : (value <= 9) ? '0' + value : 'A' + (value - 10);
+}
+
+/**
+  * Returns the value of the given symbol (as written by 'value_symbol').
+  */
+static inline unsigned symbol_value(char symbol)
+{
+	return (symbol == '.') ? 0 : (symbol <= '9') ? (unsigned)(symbol - '0') : (unsigned)(symbol - 'A' + 10);
+}
+
+/**
+  * Parse the symbol of 'length' characters into 'value' (0 for an empty cell)
+  * for a table with 'table_order' values.
+  *
+  * Returns 0 on success and non-zero value if it isn't a symbol of such a table.
+  */
+int parse_symbol(const char *symbol, size_t length, unsigned table_order, unsigned *value);
+
+/**
+  * Parse the puzzle in the given line (of 'length' characters) into 'cells'
+  * (the cells row after row) for a table with 'table_order' rows. The cells are
+  * either written one character after another or separated by whitespace.
+  * Whatever follows the cells is ignored.
+  *
+  * Returns 0 on success and non-zero value if the line isn't such a puzzle.
+  */
+int parse_puzzle(const char *line, size_t length, unsigned table_order, unsigned *cells);
+
+#endif
@@ -1,267 +1,65 @@
 #include "common.h"
 
-#ifdef KS_SUDOKU_DEBUG
-#include <stdio.h>
-#endif
-
 #include <stdbool.h>
 #include <stddef.h>
-#include <stdlib.h>
 
 #include "sudoku_solver.h"
-#include "naked_single_queue.h"
-#include "solver_helpers.h"
 
 /**
-  * Idenitfy the "naked doubles" in a group (row, column or square) and update
-  * the corresponding group to remove them as possibilities.
-  * This might reveal other possibilities such as "naked singles", "hidden signles"
-  * or even other "naked doubles".
+  * The solvers for every order of the squares in [SQUARE_ORDER_MIN, SQUARE_ORDER_MAX].
   */
-static bool solve_naked_doubles(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-				struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
-{
-	bool found_naked_double = false;
-
-	// search for naked doubles in rows
-
-#ifdef KS_SUDOKU_DEBUG_NAKED_DOUBLE_SEARCH
-	printf("solve_naked_doubles: searching for naked doubles in rows\n");
-#endif
-
-	for (size_t row=0; row<TABLE_ORDER_MAX; row++)
-	{
-		found_naked_double |= solve_naked_doubles_helper(sudoku_table, possible_values,
-								row, row,
-								0, TABLE_ORDER_MAX-1);
-	}
-
-	// search for naked doubles in cols
-
-#ifdef KS_SUDOKU_DEBUG_NAKED_DOUBLE_SEARCH
-	printf("solve_naked_doubles: searching for naked doubles in cols\n");
-#endif
-
-	for (size_t col=0; col<TABLE_ORDER_MAX; col++)
-	{
-		found_naked_double |= solve_naked_doubles_helper(sudoku_table, possible_values,
-								0, TABLE_ORDER_MAX-1,
-								col, col);
-	}
-
-#ifdef KS_SUDOKU_DEBUG_NAKED_DOUBLE_SEARCH
-	printf("solve_naked_doubles: searching for naked doubles in squares\n");
-#endif
-
-	// search for naked doubles in squares
-
-	for (size_t row=0; row<TABLE_ORDER_MAX; row+=SQUARE_DIMENSION)
-	{
-		for (size_t col=0; col<TABLE_ORDER_MAX; col+=SQUARE_DIMENSION)
-		{
-			found_naked_double |= solve_naked_doubles_helper(sudoku_table, possible_values,
-									 row, row+SQUARE_DIMENSION-1,
-									 col, col+SQUARE_DIMENSION-1);
-		}
-	}
-
-	return found_naked_double;
-}
+static bool (*const solvers[SQUARE_ORDER_MAX+1])(unsigned *, unsigned, struct sudoku_stats *) = {
+	[2] = solve_sudoku_order_2,
+	[3] = solve_sudoku_order_3,
+	[4] = solve_sudoku_order_4,
+	[5] = solve_sudoku_order_5
+};
 
 /**
-  * Identify the "hidden singles" and solve (fill in) them.
-  * This might help in identifying other possibilities such as "naked singles",
-  * "naked doubles" or even other "hidden singles".
-  *
-  * This is done by identifying values which occur only once in a group (row, column or square)
-  * and filling that cell with that value and correspindingly updating the possibilities.
+  * The functions counting the solutions for every order of the squares.
   */
-static bool solve_hidden_singles(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-				 struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
+static unsigned (*const counters[SQUARE_ORDER_MAX+1])(const unsigned *, unsigned, unsigned) = {
+	[2] = count_sudoku_solutions_order_2,
+	[3] = count_sudoku_solutions_order_3,
+	[4] = count_sudoku_solutions_order_4,
+	[5] = count_sudoku_solutions_order_5
+};
+
+bool solve_sudoku(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
 {
-	bool found_hidden_single = false;
-	for (unsigned val=MIN_VALUE; val<=MAX_VALUE; val++)
-	{
-
-		// search for hidden singles in rows
-
-#ifdef KS_SUDOKU_DEBUG_HIDDEN_SINGLE_SEARCH
-		printf("solve_hidden_singles: searching for hidden singles in rows for val: %u\n", val);
-#endif
-
-		for (size_t row=0; row<TABLE_ORDER_MAX; row++)
-		{
-			found_hidden_single |= solve_hidden_singles_helper(sudoku_table, possible_values,
-									   row, row,
-									   0, TABLE_ORDER_MAX-1,
-									   val);
-		}
-
-		// search for hidden singles in cols
-
-#ifdef KS_SUDOKU_DEBUG_HIDDEN_SINGLE_SEARCH
-		printf("solve_hidden_singles: searching for hidden singles in cols for val: %u\n", val);
-#endif
-
-		for (size_t col=0; col<TABLE_ORDER_MAX; col++)
-		{
-			found_hidden_single |= solve_hidden_singles_helper(sudoku_table, possible_values,
-									   0, TABLE_ORDER_MAX-1,
-									   col, col,
-									   val);
-		}
-
-		// search for hidden singles in squares
-
-#ifdef KS_SUDOKU_DEBUG_HIDDEN_SINGLE_SEARCH
-		printf("solve_hidden_singles: searching for hidden singles in squares for val: %u\n", val);
-#endif
-
-		for (size_t row=0; row<TABLE_ORDER_MAX; row+=SQUARE_DIMENSION)
-		{
-			for (size_t col=0; col<TABLE_ORDER_MAX; col+=SQUARE_DIMENSION)
-			{
-				found_hidden_single |= solve_hidden_singles_helper(sudoku_table, possible_values,
-										   row, row+SQUARE_DIMENSION-1,
-										   col, col+SQUARE_DIMENSION-1,
-										   val);
-			}
-		}
-	}
-
-#ifdef KS_SUDOKU_DEBUG
-	printf("\n");
-#endif
-
-	return found_hidden_single;
+	return solve_sudoku_order_3(&sudoku_table[0][0], SUDOKU_DEFAULT_TECHNIQUES, NULL);
 }
 
-/**
-  * Solve (fill in) the "naked single" possibilities in the sudoku table.
-  * The 'possible_entries' table should be initialized for the given 'sudoku_table'.
-  * The moves are obtained from the tail-queue whose head is 'naked_singles_head'.
-  */
-static void solve_naked_singles(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-			 struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
+bool solve_sudoku_stats(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
+			struct sudoku_stats *stats)
 {
-	while (is_naked_single_available())
-	{
-		struct naked_single *curr = get_first_naked_single();
-		remove_first_naked_single();
-
-		unsigned naked_single = find_naked_single(possible_values, curr->row, curr->col);
-		sudoku_table[curr->row][curr->col] = naked_single;
-
-#ifdef KS_SUDOKU_DEBUG
-		printf("solve_naked_singles: only possibility %u for row: %zu, col: %zu\n",
-			naked_single, curr->row, curr->col);
-#endif
-
-		update_possibilities(sudoku_table, possible_values, curr->row, curr->col, naked_single);
-
-#ifdef KS_SUDOKU_DEBUG
-		printf("solve_naked_singles: Naked single possibilities:\n");
-		print_naked_singles();
-		printf("\n");
-#endif
-
-		free(curr);
-	}
+	return solve_sudoku_order_3(&sudoku_table[0][0], SUDOKU_DEFAULT_TECHNIQUES, stats);
 }
 
-static void solve(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-	   struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
+bool solve_sudoku_order(unsigned square_order, unsigned *sudoku_table,
+			struct sudoku_stats *stats)
 {
-    bool try_next_round = false;
-    unsigned round = 1;
-    static const unsigned round_limit = 100;
-
-    do
-    {
-	solve_naked_singles(sudoku_table, possible_values);
-
-#ifdef KS_SUDOKU_DEBUG
-	printf("solve: Possibility vectors after trying to solve 'naked singles' in round: %u:\n",
-		round);
-	print_possibility_vector(sudoku_table, possible_values);
-#endif
-
-	bool found_hidden_single = solve_hidden_singles(sudoku_table, possible_values);
-
-#ifdef KS_SUDOKU_DEBUG
-	if (found_hidden_single)
-	{
-		printf("solve: Possibility vectors after trying to solve 'hidden singles' in round: %u:\n",
-			round);
-		print_possibility_vector(sudoku_table, possible_values);
-	}
-	else
-	{
-		printf("solve: No 'hidden single' found in round: %u.\n", round);
-	}
-#endif
-
-	bool found_naked_double = solve_naked_doubles(sudoku_table, possible_values);
+	return solve_sudoku_techniques(square_order, SUDOKU_DEFAULT_TECHNIQUES, sudoku_table, stats);
+}
 
-#ifdef KS_SUDOKU_DEBUG
-	if (found_naked_double)
-	{
-		printf("solve: Possibility vectors after trying to solve 'naked doubles' in round: %u:\n", round);
-		print_possibility_vector(sudoku_table, possible_values);
-	}
-	else
+bool solve_sudoku_techniques(unsigned square_order, unsigned techniques,
+			     unsigned *sudoku_table, struct sudoku_stats *stats)
+{
+	if (square_order < SQUARE_ORDER_MIN || square_order > SQUARE_ORDER_MAX)
 	{
-		printf("solve: No 'naked double' found in round: %u.\n", round);
+		return false;
 	}
-#endif
-
-	try_next_round = found_hidden_single | found_naked_double;
-	round++;
-    } while (try_next_round == true &&
-	     (round <= round_limit)); // to avoid infinite looping due to repeated detection of "naked doubles"
 
+	return solvers[square_order](sudoku_table, techniques & SUDOKU_ALL_TECHNIQUES, stats);
 }
 
-void solve_sudoku(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX])
+unsigned count_sudoku_solutions(unsigned square_order, const unsigned *sudoku_table,
+				unsigned limit, unsigned max_guesses)
 {
-	// the lookup table used to identify the possibilities of different cells
-	struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX];
-
-	initialise_naked_single_queue();
-
-#ifdef KS_SUDOKU_DEBUG
-	printf("\n");
-	printf("solve_sudoku: 'sudoku_table' obtained as input\n");
-	print_table(sudoku_table);
-#endif
-
-	for (size_t row=0; row<TABLE_ORDER_MAX; row++)
+	if (square_order < SQUARE_ORDER_MIN || square_order > SQUARE_ORDER_MAX)
 	{
-		for (size_t col=0; col<TABLE_ORDER_MAX; col++)
-		{
-			if (sudoku_table[row][col] == 0)
-			{
-				// initialise the possible values
-				initialise_possible_values(sudoku_table, possible_values, row, col);
-
-				// This could also be done in 'initialise_possible_values_helper'.
-				// But doing this here saves us some unwanted checking.
-				if (possible_values[row][col].possibilities == 1)
-				{
-					insert_naked_single(row, col);
-				}
-			}
-		}
+		return 0;
 	}
 
-#ifdef KS_SUDOKU_DEBUG
-	printf("solve_sudoku: Possibility vector after initialization:\n");
-	print_possibility_vector(sudoku_table, possible_values);
-
-	printf("solve_sudoku: Naked single possibilities:\n");
-	print_naked_singles();
-	printf("\n");
-#endif
-
-	solve(sudoku_table, possible_values);
+	return counters[square_order](sudoku_table, limit, max_guesses);
 }
@@ -1,16 +1,393 @@
 #ifndef KS_SUDOKU_SOLVER_SOLVER_HELPERS
 #define KS_SUDOKU_SOLVER_SOLVER_HELPERS
 
+/**
+  * The helpers of the solver. They are included by the solver of every order
+  * (see 'solver_kernel.h'), so they are defined for the order in 'solver_order.h'.
+  */
+
 #include <sys/types.h>
 #include <stddef.h>
-#include "common.h"
-#include "sudoku_solver.h"
+#include "solver_order.h"
+
+#ifdef KS_SUDOKU_DEBUG
+#include <stdlib.h>
+#include <stdio.h>
+#endif
 
 /**
   * Returns the "naked single" value for the given cell.
   */
-unsigned find_naked_single(struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-			   size_t row, size_t col);
+static unsigned find_naked_single(struct possible_entries *possible_values,
+				  size_t row, size_t col)
+{
+
+#ifdef KS_SUDOKU_DEBUG
+	if (count_values(possible_values->cell[row][col]) != 1)
+	{
+		fprintf(stderr, "find_naked_single: invalid request.\n"
+				"row: %zu, col: %zu has %u possibilities!\n", row, col,
+				count_values(possible_values->cell[row][col]));
+		exit(EXIT_FAILURE);
+	}
+#endif
+
+	return first_value(possible_values->cell[row][col]);
+}
+
+/**
+  * Add the units of the given cell to the units to be searched by the
+  * techniques other than the singles.
+  */
+static inline void mark_units(struct possible_entries *possible_values,
+			      size_t row, size_t col)
+{
+	const size_t units[3] = { row, TABLE_ORDER + col, 2*TABLE_ORDER + square_of(row, col) };
+
+	for (size_t index=0; index<3; index++)
+	{
+		const uint64_t unit_bit = UINT64_C(1) << (units[index]%64);
+
+		possible_values->naked_double_units.word[units[index]/64] |= unit_bit;
+		possible_values->intersection_units.word[units[index]/64] |= unit_bit;
+		possible_values->subset_units.word[units[index]/64] |= unit_bit;
+	}
+}
+
+/**
+  * Add every unit to the units to be searched and every value to the values
+  * to be searched for fish (or remove every one of them when 'all' is false).
+  */
+static inline void set_all_units(struct possible_entries *possible_values, bool all)
+{
+	for (size_t word=0; word<UNIT_WORDS; word++)
+	{
+		possible_values->naked_double_units.word[word] = 0;
+		possible_values->intersection_units.word[word] = 0;
+		possible_values->subset_units.word[word] = 0;
+	}
+
+	for (size_t unit=0; all && unit<UNITS; unit++)
+	{
+		const uint64_t unit_bit = UINT64_C(1) << (unit%64);
+
+		possible_values->naked_double_units.word[unit/64] |= unit_bit;
+		possible_values->intersection_units.word[unit/64] |= unit_bit;
+		possible_values->subset_units.word[unit/64] |= unit_bit;
+	}
+
+	possible_values->fish_values = all ? ALL_VALUES : 0;
+}
+
+/**
+  * Remove the first unit from the given set.
+  *
+  * Returns the unit removed or UNITS if the set is empty.
+  */
+static inline size_t take_unit(struct unit_set *units)
+{
+	for (size_t word=0; word<UNIT_WORDS; word++)
+	{
+		if (units->word[word] != 0)
+		{
+			const size_t bit = __builtin_ctzll(units->word[word]);
+
+			units->word[word] &= units->word[word] - 1;
+			return word*64 + bit;
+		}
+	}
+
+	return UNITS;
+}
+
+/**
+  * Find the range of the rows and the columns of the cells in the given unit.
+  */
+static inline void unit_cells(size_t unit,
+			      size_t *row_start, size_t *row_end,
+			      size_t *col_start, size_t *col_end)
+{
+	if (unit < TABLE_ORDER)
+	{
+		*row_start = *row_end = unit;
+		*col_start = 0;
+		*col_end = TABLE_ORDER-1;
+	}
+	else if (unit < 2*TABLE_ORDER)
+	{
+		*row_start = 0;
+		*row_end = TABLE_ORDER-1;
+		*col_start = *col_end = unit - TABLE_ORDER;
+	}
+	else
+	{
+		const size_t square = unit - 2*TABLE_ORDER;
+
+		*row_start = (square/SQUARE_ORDER)*SQUARE_ORDER;
+		*row_end = *row_start+SQUARE_ORDER-1;
+		*col_start = (square%SQUARE_ORDER)*SQUARE_ORDER;
+		*col_end = *col_start+SQUARE_ORDER-1;
+	}
+}
+
+/**
+  * Returns the values filled in the given unit.
+  */
+static inline value_mask unit_used(const struct possible_entries *possible_values, size_t unit)
+{
+	if (unit < TABLE_ORDER)
+	{
+		return possible_values->row_used[unit];
+	}
+	else if (unit < 2*TABLE_ORDER)
+	{
+		return possible_values->col_used[unit - TABLE_ORDER];
+	}
+	else
+	{
+		return possible_values->square_used[unit - 2*TABLE_ORDER];
+	}
+}
+
+/**
+  * Find the cell at the given position of the given unit.
+  */
+static inline void unit_cell(size_t unit, size_t position, size_t *row, size_t *col)
+{
+	if (unit < TABLE_ORDER)
+	{
+		*row = unit;
+		*col = position;
+	}
+	else if (unit < 2*TABLE_ORDER)
+	{
+		*row = position;
+		*col = unit - TABLE_ORDER;
+	}
+	else
+	{
+		const size_t square = unit - 2*TABLE_ORDER;
+
+		*row = (square/SQUARE_ORDER)*SQUARE_ORDER + position/SQUARE_ORDER;
+		*col = (square%SQUARE_ORDER)*SQUARE_ORDER + position%SQUARE_ORDER;
+	}
+}
+
+/**
+  * Queue the "hidden single" of the given value in the given unit.
+  */
+static inline void insert_hidden_single(struct possible_entries *possible_values,
+					size_t unit, unsigned val)
+{
+	struct hidden_single_queue *const queue = &possible_values->hidden_singles;
+
+#ifdef KS_SUDOKU_DEBUG
+	if (queue->last == HIDDEN_SINGLES_MAX)
+	{
+		fprintf(stderr, "insert_hidden_single: too many hidden singles\n");
+		exit(EXIT_FAILURE);
+	}
+#endif
+
+	queue->move[queue->last].unit = unit;
+	queue->move[queue->last].value = val;
+	queue->last++;
+}
+
+static inline bool is_hidden_single_available(const struct possible_entries *possible_values)
+{
+	return possible_values->hidden_singles.first != possible_values->hidden_singles.last;
+}
+
+static inline struct hidden_single remove_first_hidden_single(struct possible_entries *possible_values)
+{
+	struct hidden_single_queue *const queue = &possible_values->hidden_singles;
+	const struct hidden_single move = queue->move[queue->first++];
+
+	// start over once every move queued is done
+	if (queue->first == queue->last)
+	{
+		queue->first = queue->last = 0;
+	}
+
+	return move;
+}
+
+static inline void clear_hidden_singles(struct possible_entries *possible_values)
+{
+	possible_values->hidden_singles.first = possible_values->hidden_singles.last = 0;
+}
+
+/**
+  * Remove the given cell from the places of the given values in its units.
+  * A value that is no longer possible in a unit it isn't filled in is a
+  * contradiction and a value possible in only one cell of it is a "hidden
+  * single". The values filled in the units must be up to date.
+  */
+static void remove_places(struct possible_entries *possible_values,
+			  size_t row, size_t col, value_mask values)
+{
+	const size_t square = square_of(row, col);
+	const size_t units[3] = { row, TABLE_ORDER + col, 2*TABLE_ORDER + square };
+	const position_mask positions[3] = {
+		POSITION_BIT(col),
+		POSITION_BIT(row),
+		POSITION_BIT((row%SQUARE_ORDER)*SQUARE_ORDER + col%SQUARE_ORDER)
+	};
+	const value_mask used[3] = {
+		possible_values->row_used[row],
+		possible_values->col_used[col],
+		possible_values->square_used[square]
+	};
+
+	possible_values->fish_values |= values;
+
+	while (values != 0)
+	{
+		const unsigned val = first_value(values);
+		const value_mask val_bit = VALUE_BIT(val);
+
+		values &= ~val_bit;
+
+		for (size_t index=0; index<3; index++)
+		{
+			position_mask *const place = &possible_values->place[units[index]][val-MIN_VALUE];
+
+			*place &= ~positions[index];
+
+			if (used[index] & val_bit)
+			{
+				continue;
+			}
+
+			if (*place == 0)
+			{
+				possible_values->contradiction = true;
+			}
+			else if ((*place & (*place - 1)) == 0)
+			{
+				insert_hidden_single(possible_values, units[index], val);
+			}
+		}
+	}
+}
+
+/**
+  * Add the given cell to the places of the given values in its units.
+  */
+static void add_places(struct possible_entries *possible_values,
+		       size_t row, size_t col, value_mask values)
+{
+	const size_t square = square_of(row, col);
+	const size_t square_position = (row%SQUARE_ORDER)*SQUARE_ORDER + col%SQUARE_ORDER;
+
+	while (values != 0)
+	{
+		const unsigned val = first_value(values);
+
+		values &= ~VALUE_BIT(val);
+		possible_values->place[row][val-MIN_VALUE] |= POSITION_BIT(col);
+		possible_values->place[TABLE_ORDER + col][val-MIN_VALUE] |= POSITION_BIT(row);
+		possible_values->place[2*TABLE_ORDER + square][val-MIN_VALUE] |= POSITION_BIT(square_position);
+	}
+}
+
+/**
+  * Keep the possibilities of the given cell (and the value filled in it) to undo
+  * the change about to be made to it while searching.
+  */
+static inline void record_change(struct possible_entries *possible_values,
+				 size_t row, size_t col, unsigned filled)
+{
+	if (possible_values->searching)
+	{
+
+#ifdef KS_SUDOKU_DEBUG
+		if (possible_values->changes == CHANGES_MAX)
+		{
+			fprintf(stderr, "record_change: too many changes\n");
+			exit(EXIT_FAILURE);
+		}
+#endif
+
+		struct change *const change = possible_values->change + possible_values->changes++;
+
+		change->row = row;
+		change->col = col;
+		change->filled = filled;
+		change->possible = possible_values->cell[row][col];
+	}
+}
+
+/**
+  * Remove the given values from the possibilities of the given cell.
+  * Filled cells have no possibilities, so they are left as they are.
+  *
+  * Returns true if a possibility was removed.
+  */
+static bool remove_possibilities(struct possible_entries *possible_values,
+				 size_t row, size_t col, value_mask values)
+{
+	const value_mask possible = possible_values->cell[row][col];
+
+	if ((possible & values) == 0)
+	{
+		return false;
+	}
+
+	record_change(possible_values, row, col, 0);
+	possible_values->cell[row][col] = possible & ~values;
+	remove_places(possible_values, row, col, possible & values);
+	mark_units(possible_values, row, col);
+
+	if (possible_values->cell[row][col] == 0)
+	{
+		possible_values->contradiction = true;
+	}
+	else if (count_values(possible_values->cell[row][col]) == 1)
+	{
+
+#ifdef KS_SUDOKU_DEBUG_UPDATE_POSSIBILITIES
+		printf("remove_possibilities: only_possibility: %u for row: %zu, col: %zu\n",
+			find_naked_single(possible_values, row, col), row, col);
+#endif
+
+		insert_naked_single(&possible_values->naked_singles, row, col);
+	}
+
+#ifdef KS_SUDOKU_DEBUG_UPDATE_POSSIBILITIES
+	else
+	{
+		printf("remove_possibilities: %u possibilities for row: %zu, col: %zu\n",
+			count_values(possible_values->cell[row][col]), row, col);
+	}
+#endif
+
+	return true;
+}
+
+/**
+  * Remove the given values from the possibilities of the cells at the given
+  * positions of the unit.
+  *
+  * Returns true if a possibility was removed.
+  */
+static bool remove_from_cells(struct possible_entries *possible_values,
+			      size_t unit, position_mask positions, value_mask values)
+{
+	bool removed = false;
+	size_t row, col;
+
+	while (positions != 0)
+	{
+		unit_cell(unit, __builtin_ctz(positions), &row, &col);
+		positions &= positions - 1;
+
+		removed |= remove_possibilities(possible_values, row, col, values);
+	}
+
+	return removed;
+}
 
 /*
  * Update the possibilities of cells as a consequence of assignment of 'val' to the given cell.
@@ -21,29 +398,83 @@ unsigned find_naked_single(struct possible_entries possible_values[TABLE_ORDER_M
  *  (row, col) - the cell due to which the update is being performed
  *  val - the value being inserted into (row, col)
  */
-void update_possibilities(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-			  struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-			  size_t row, size_t col, unsigned val);
+static void update_possibilities(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+				 struct possible_entries *possible_values,
+				 size_t row, size_t col, unsigned val)
+{
+
+#ifdef KS_SUDOKU_DEBUG
+	if (sudoku_table[row][col] != val)
+	{
+		fprintf(stderr, "update_possibilities: row: %zu, col: %zu isn't filled with %u\n",
+			row, col, val);
+		exit(EXIT_FAILURE);
+	}
+#else
+	(void) sudoku_table;
+#endif
+
+	const value_mask val_bit = VALUE_BIT(val);
+	const value_mask possible = possible_values->cell[row][col];
+
+	// the cell is filled
+	record_change(possible_values, row, col, val);
+	possible_values->cell[row][col] = 0;
+	possible_values->row_used[row] |= val_bit;
+	possible_values->col_used[col] |= val_bit;
+	possible_values->square_used[square_of(row, col)] |= val_bit;
+	remove_places(possible_values, row, col, possible);
+	mark_units(possible_values, row, col);
+
+	// remove the value from the other cells of the row, the column and the square
+	// (only the cells where it is still possible are visited)
+	remove_from_cells(possible_values, row,
+			  possible_values->place[row][val-MIN_VALUE], val_bit);
+	remove_from_cells(possible_values, TABLE_ORDER + col,
+			  possible_values->place[TABLE_ORDER + col][val-MIN_VALUE], val_bit);
+	remove_from_cells(possible_values, 2*TABLE_ORDER + square_of(row, col),
+			  possible_values->place[2*TABLE_ORDER + square_of(row, col)][val-MIN_VALUE], val_bit);
+}
 
 /**
-  * Helper function to avoid redundancy in the 'solve_naked_singles' function.
+  * Fill the given "hidden single" in the sudoku table. The value might have been
+  * filled in the unit since the move was queued (then there is nothing to do).
   *
   * sudoku_table - the table containing the sudoku board
   * possible_values - lookup table for possible values of different cells in the
   *                    sudoku board.
-  * (search_row_start, search_row_end) - the range of rows which must be searched
-                                          for a "hidden single"
-  * (search_col_start, search_col_end) - the range of colums which must be searched
-                                          for a "hidden single"
-  * val - the "hidden single" value which is being searched for
-  *
-  * Returns true if the 'val' is found as a "hidden single" in the search space.
+  * move - the unit and the value possible in only one cell of it
   */
-bool solve_hidden_singles_helper(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-				 struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-				 size_t search_row_start, size_t search_row_end,
-				 size_t search_col_start, size_t search_col_end,
-				 unsigned val);
+static void solve_hidden_single(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+				struct possible_entries *possible_values,
+				struct hidden_single move)
+{
+	const position_mask place = possible_values->place[move.unit][move.value-MIN_VALUE];
+	size_t row, col;
+
+	if (unit_used(possible_values, move.unit) & VALUE_BIT(move.value))
+	{
+		return;
+	}
+
+	// the last cell was removed since (a contradiction)
+	if (place == 0)
+	{
+		possible_values->contradiction = true;
+		return;
+	}
+
+	unit_cell(move.unit, __builtin_ctz(place), &row, &col);
+
+#ifdef KS_SUDOKU_DEBUG
+	printf("solve_hidden_single: found hidden single %u for row: %zu, col: %zu\n",
+		(unsigned) move.value, row, col);
+#endif
+
+	sudoku_table[row][col] = move.value;
+	update_possibilities(sudoku_table, possible_values, row, col, move.value);
+	possible_values->stats.hidden_singles++;
+}
 
 /*
  * Update the possibilities of cells as a consequence of detecting a naked double pair
@@ -54,12 +485,69 @@ bool solve_hidden_singles_helper(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_OR
  *                    sudoku board.
  *  (row_1, col_1; row_2, col_2) - the naked double pair due to which the update is being performed
  *  doubles - the values in the naked double pair
+ *
+ * Returns true if a possibility was removed from a cell.
  */
-void update_possibilities_1(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-			  struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-			  size_t row_1, size_t col_1,
-			  size_t row_2, size_t col_2,
-			  struct naked_double_values doubles);
+static bool update_possibilities_1(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+				   struct possible_entries *possible_values,
+				   size_t row_1, size_t col_1,
+				   size_t row_2, size_t col_2,
+				   value_mask doubles)
+{
+	(void) sudoku_table;
+
+	size_t search_row_start, search_row_end, search_col_start, search_col_end;
+
+	if (row_1 == row_2)
+	{
+		// "naked double" in a row
+		search_row_start = search_row_end = row_1;
+		search_col_start = 0;
+		search_col_end = TABLE_ORDER-1;
+	}
+	else if (col_1 == col_2)
+	{
+		// "naked double" in a column
+		search_row_start = 0;
+		search_row_end = TABLE_ORDER-1;
+		search_col_start = search_col_end = col_1;
+	}
+	else
+	{
+		// "naked double" in a square
+		search_row_start = (row_1/SQUARE_ORDER)*SQUARE_ORDER;
+		search_row_end = search_row_start+SQUARE_ORDER-1;
+		search_col_start = (col_1/SQUARE_ORDER)*SQUARE_ORDER;
+		search_col_end = search_col_start+SQUARE_ORDER-1;
+	}
+
+#ifdef KS_SUDOKU_DEBUG_UPDATE_POSSIBILITIES_1
+	printf("update_possibilities_1: updating possibilities for 'naked double':\n");
+	printf("update_possibilities_1: row_1: %zu, col_1: %zu; row_2: %zu, col_2: %zu\n",
+		row_1, col_1, row_2, col_2);
+#endif
+
+	bool removed = false;
+
+	for (size_t search_row=search_row_start; search_row<=search_row_end; search_row++)
+	{
+		for (size_t search_col=search_col_start; search_col<=search_col_end; search_col++)
+		{
+			// ignore the "naked double" cells
+			if (
+			    (search_row == row_1 && search_col == col_1) ||
+			    (search_row == row_2 && search_col == col_2)
+			)
+			{
+				continue;
+			}
+
+			removed |= remove_possibilities(possible_values, search_row, search_col, doubles);
+		}
+	}
+
+	return removed;
+}
 
 /**
   * Helper function to avoid redundancy in the 'solve_naked_doubles' function.
@@ -72,31 +560,263 @@ void update_possibilities_1(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_M
   * (search_col_start, search_col_end) - the range of colums which must be searched
                                           for a "naked double"
   *
-  * Returns true if a "naked double" was found in the search space.
+  * Returns true if a "naked double" was found in the search space that removed
+  * a possibility from another cell.
+  */
+static bool solve_naked_doubles_helper(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+				       struct possible_entries *possible_values,
+				       size_t search_row_start, size_t search_row_end,
+				       size_t search_col_start, size_t search_col_end)
+{
+
+#ifdef KS_SUDOKU_DEBUG_NAKED_DOUBLE_SEARCH
+	printf("solve_naked_doubles_helper: request to search for a 'naked double' in range:\n");
+	printf("solve_naked_doubles_helper: search_row_start: %zu, search_row_end: %zu\n", search_row_start, search_row_end);
+	printf("solve_naked_doubles_helper: search_col_start: %zu, search_col_end: %zu\n", search_col_start, search_col_end);
+#endif
+
+	bool found_naked_double = false;
+
+	// the cells of the search space with two possibilities
+	size_t double_rows[TABLE_ORDER], double_cols[TABLE_ORDER];
+	size_t doubles = 0;
+
+	for (size_t search_row=search_row_start; search_row<=search_row_end; search_row++)
+	{
+		for (size_t search_col=search_col_start; search_col<=search_col_end; search_col++)
+		{
+			if (count_values(possible_values->cell[search_row][search_col]) == 2)
+			{
+				double_rows[doubles] = search_row;
+				double_cols[doubles] = search_col;
+				doubles++;
+			}
+		}
+	}
+
+	for (size_t first=0; first<doubles; first++)
+	{
+		for (size_t second=first+1; second<doubles; second++)
+		{
+			const value_mask d = possible_values->cell[double_rows[first]][double_cols[first]];
+
+			// the possibilities might have changed due to another "naked double"
+			if (count_values(d) != 2 ||
+			    possible_values->cell[double_rows[second]][double_cols[second]] != d)
+			{
+				continue;
+			}
+
+#ifdef KS_SUDOKU_DEBUG
+			printf("solve_naked_doubles: found naked double at\n"
+				"solve_naked_doubles: row_1: %zu, col_1: %zu\n"
+				"solve_naked_doubles: row_2: %zu, col_2: %zu\n",
+				double_rows[first], double_cols[first],
+				double_rows[second], double_cols[second]);
+#endif
+
+			if (update_possibilities_1(sudoku_table, possible_values,
+						   double_rows[first], double_cols[first],
+						   double_rows[second], double_cols[second],
+						   d))
+			{
+				possible_values->stats.naked_doubles++;
+				found_naked_double = true;
+			}
+		}
+	}
+
+	return found_naked_double;
+}
+
+/**
+  * Initialise the values used in every row, column and square of the sudoku table.
+  * This must be done before initialising the possible values of the cells.
+  * A value filled twice in a group is a contradiction.
+  */
+static void initialise_used_values(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+				   struct possible_entries *possible_values)
+{
+	possible_values->contradiction = false;
+	possible_values->searching = false;
+	possible_values->changes = 0;
+	possible_values->stats = (struct sudoku_stats) {0};
+
+	for (size_t index=0; index<TABLE_ORDER; index++)
+	{
+		possible_values->row_used[index] = 0;
+		possible_values->col_used[index] = 0;
+		possible_values->square_used[index] = 0;
+	}
+
+	for (size_t row=0; row<TABLE_ORDER; row++)
+	{
+		for (size_t col=0; col<TABLE_ORDER; col++)
+		{
+			const unsigned val = sudoku_table[row][col];
+
+			possible_values->cell[row][col] = 0;
+
+			if (val != 0)
+			{
+				// the same value filled twice in a group
+				if ((possible_values->row_used[row] | possible_values->col_used[col] |
+				     possible_values->square_used[square_of(row, col)]) & VALUE_BIT(val))
+				{
+					possible_values->contradiction = true;
+				}
+
+				possible_values->row_used[row] |= VALUE_BIT(val);
+				possible_values->col_used[col] |= VALUE_BIT(val);
+				possible_values->square_used[square_of(row, col)] |= VALUE_BIT(val);
+			}
+		}
+	}
+}
+
+/**
+  * Undo the changes made while searching until only the first 'changes' of them
+  * are left. The cells filled by the changes undone are emptied and a
+  * contradiction is forgotten. The techniques are expected to have been stuck
+  * when the first 'changes' were made, so no unit is left to be searched.
   */
-bool solve_naked_doubles_helper(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-				 struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-				 size_t search_row_start, size_t search_row_end,
-				 size_t search_col_start, size_t search_col_end);
+static void undo_changes(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+			 struct possible_entries *possible_values,
+			 size_t changes)
+{
+	while (possible_values->changes > changes)
+	{
+		const struct change *const change = possible_values->change + --possible_values->changes;
+		const size_t row = change->row, col = change->col;
+
+		if (change->filled != 0)
+		{
+			const value_mask val_bit = VALUE_BIT(change->filled);
+
+			sudoku_table[row][col] = 0;
+			possible_values->row_used[row] &= ~val_bit;
+			possible_values->col_used[col] &= ~val_bit;
+			possible_values->square_used[square_of(row, col)] &= ~val_bit;
+		}
+
+		add_places(possible_values, row, col, change->possible & ~possible_values->cell[row][col]);
+		possible_values->cell[row][col] = change->possible;
+	}
+
+	// the units were searched before the changes undone
+	set_all_units(possible_values, false);
+	possible_values->contradiction = false;
+}
 
 /**
   * Initialise 'possible_entries' with values that are possible for a given sudoku cell.
   * Obviously the cell is expected not to be an already filled one.
   *
-  * Initialization is done by identifying values that are not possible for the given square
-  * by linearly searching the corresponding row, column and the square. The 'possible_entries'
-  * is updated accordingly.
+  * The values possible are the ones not used in the row, column or the square
+  * of the cell.
+  */
+static void initialise_possible_values(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+				       struct possible_entries *possible_values,
+				       size_t row, size_t col)
+{
+
+#ifdef KS_SUDOKU_DEBUG
+	if (sudoku_table[row][col] != 0)
+	{
+		fprintf(stderr, "initialise_possible_values: Trying to initialise an already filled cell\n");
+		exit(EXIT_FAILURE);
+	}
+#else
+	(void) sudoku_table;
+#endif
+
+	possible_values->cell[row][col] = ALL_VALUES & ~(possible_values->row_used[row] |
+							 possible_values->col_used[col] |
+							 possible_values->square_used[square_of(row, col)]);
+
+	if (possible_values->cell[row][col] == 0)
+	{
+		possible_values->contradiction = true;
+	}
+}
+
+/**
+  * Initialise the places of the values in every unit once the possible values
+  * of the cells are initialised. The "hidden singles" found are queued.
   */
-void initialise_possible_values(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-				struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-				size_t row, size_t col);
+static void initialise_places(struct possible_entries *possible_values)
+{
+	for (size_t unit=0; unit<UNITS; unit++)
+	{
+		for (size_t value=0; value<NUMBER_OF_VALUES; value++)
+		{
+			possible_values->place[unit][value] = 0;
+		}
+	}
+
+	for (size_t row=0; row<TABLE_ORDER; row++)
+	{
+		for (size_t col=0; col<TABLE_ORDER; col++)
+		{
+			add_places(possible_values, row, col, possible_values->cell[row][col]);
+		}
+	}
+
+	for (size_t unit=0; unit<UNITS; unit++)
+	{
+		const value_mask used = unit_used(possible_values, unit);
+
+		for (unsigned val=MIN_VALUE; val<=MAX_VALUE; val++)
+		{
+			const position_mask place = possible_values->place[unit][val-MIN_VALUE];
+
+			if (used & VALUE_BIT(val))
+			{
+				continue;
+			}
+
+			if (place == 0)
+			{
+				possible_values->contradiction = true;
+			}
+			else if ((place & (place - 1)) == 0)
+			{
+				insert_hidden_single(possible_values, unit, val);
+			}
+		}
+	}
+}
 
 #ifdef KS_SUDOKU_DEBUG
 /**
   * Print the given possibility vector for the sudoku table.
   */
-void print_possibility_vector(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
-			      struct possible_entries possible_values[TABLE_ORDER_MAX][TABLE_ORDER_MAX]);
+static void print_possibility_vector(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+				     struct possible_entries *possible_values)
+{
+	for (size_t row=0; row<TABLE_ORDER; row++)
+	{
+		for (size_t col=0; col<TABLE_ORDER; col++)
+		{
+			if (sudoku_table[row][col] == 0)
+			{
+				const value_mask possible = possible_values->cell[row][col];
+
+				printf("print_possibility_vector: %u possible values for row: %zu, col: %zu\n",
+					count_values(possible), row, col);
+
+				for (size_t value=MIN_VALUE; value<=MAX_VALUE; value++)
+				{
+					if (possible & VALUE_BIT(value))
+					{
+						printf("%zu\t", value);
+					}
+				}
+				printf("\n\n");
+			}
+		}
+	}
+}
 #endif
 
 #endif
@@ -0,0 +1,418 @@
+#ifndef KS_SUDOKU_SOLVER_SOLVER_KERNEL
+#define KS_SUDOKU_SOLVER_SOLVER_KERNEL
+
+/**
+  * The solver for the tables whose squares are of the order 'SQUARE_ORDER'.
+  *
+  * It is included by the 'solver_order_*.c' files (one for every order) which
+  * define 'SQUARE_ORDER' and the name of the function that solves a table,
+  * 'SOLVE_SUDOKU_ORDER' (and the one that counts its solutions,
+  * 'COUNT_SUDOKU_SOLUTIONS_ORDER'). So, the sizes of the table are constants in each of
+  * them and the possibilities use the smallest word that fits (see 'solver_order.h').
+  */
+
+#ifndef SOLVE_SUDOKU_ORDER
+#error "SOLVE_SUDOKU_ORDER must be defined to the name of the solver"
+#endif
+
+#ifndef COUNT_SUDOKU_SOLUTIONS_ORDER
+#error "COUNT_SUDOKU_SOLUTIONS_ORDER must be defined to the name of the function counting solutions"
+#endif
+
+#include "solver_order.h"
+
+#ifdef KS_SUDOKU_DEBUG
+#include <stdio.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "sudoku_solver.h"
+#include "solver_helpers.h"
+#include "solver_techniques.h"
+
+/**
+  * Solve (fill in) the "naked single" possibilities in the sudoku table.
+  * The 'possible_entries' table should be initialized for the given 'sudoku_table'.
+  * The moves are obtained from the queue of the lookup table.
+  */
+static void solve_naked_singles(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+			 struct possible_entries *possible_values)
+{
+	while (is_naked_single_available(&possible_values->naked_singles) && !possible_values->contradiction)
+	{
+		const struct naked_single curr = remove_first_naked_single(&possible_values->naked_singles);
+
+		// the cell might have been filled as a "hidden single" since it was queued
+		if (sudoku_table[curr.row][curr.col] != 0)
+		{
+			continue;
+		}
+
+		unsigned naked_single = find_naked_single(possible_values, curr.row, curr.col);
+		sudoku_table[curr.row][curr.col] = naked_single;
+
+#ifdef KS_SUDOKU_DEBUG
+		printf("solve_naked_singles: only possibility %u for row: %zu, col: %zu\n",
+			naked_single, curr.row, curr.col);
+#endif
+
+		update_possibilities(sudoku_table, possible_values, curr.row, curr.col, naked_single);
+		possible_values->stats.naked_singles++;
+
+#ifdef KS_SUDOKU_DEBUG
+		printf("solve_naked_singles: Naked single possibilities:\n");
+		print_naked_singles(&possible_values->naked_singles);
+		printf("\n");
+#endif
+	}
+}
+
+/**
+  * Apply the techniques until none of them could make a move (or there is a
+  * contradiction).
+  *
+  * The "naked singles" and the "hidden singles" are found as the possibilities
+  * are removed, so they are only queued. Only the units (rows, columns and
+  * squares) whose possibilities changed since they were last searched are
+  * searched by the other techniques (and only the values whose places changed
+  * for fish). The cheaper techniques are tried first: the "naked singles" queued
+  * are filled before a "hidden single", and a unit is searched by a technique
+  * only when no unit is left to be searched by the ones before it: the
+  * intersections, the "naked doubles", the other subsets and then the fish.
+  */
+static void solve(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+		  struct possible_entries *possible_values)
+{
+	size_t unit, row_start, row_end, col_start, col_end;
+
+	while (1)
+	{
+		solve_naked_singles(sudoku_table, possible_values);
+
+		if (possible_values->contradiction)
+		{
+			break;
+		}
+
+		if (is_hidden_single_available(possible_values))
+		{
+			const struct hidden_single move = remove_first_hidden_single(possible_values);
+
+#ifdef KS_SUDOKU_DEBUG_HIDDEN_SINGLE_SEARCH
+			printf("solve: hidden single %u in unit: %u\n",
+				(unsigned) move.value, (unsigned) move.unit);
+#endif
+
+			solve_hidden_single(sudoku_table, possible_values, move);
+		}
+		else if ((possible_values->techniques & (SUDOKU_POINTING | SUDOKU_BOX_LINE)) &&
+			 (unit = take_unit(&possible_values->intersection_units)) != UNITS)
+		{
+			solve_intersections(possible_values, unit);
+		}
+		else if ((possible_values->techniques & SUDOKU_NAKED_DOUBLES) &&
+			 (unit = take_unit(&possible_values->naked_double_units)) != UNITS)
+		{
+
+#ifdef KS_SUDOKU_DEBUG_NAKED_DOUBLE_SEARCH
+			printf("solve: searching for naked doubles in unit: %zu\n", unit);
+#endif
+
+			unit_cells(unit, &row_start, &row_end, &col_start, &col_end);
+			solve_naked_doubles_helper(sudoku_table, possible_values,
+						   row_start, row_end,
+						   col_start, col_end);
+		}
+		else if ((possible_values->techniques & (SUDOKU_NAKED_TRIPLES | SUDOKU_HIDDEN_PAIRS |
+							 SUDOKU_HIDDEN_TRIPLES)) &&
+			 (unit = take_unit(&possible_values->subset_units)) != UNITS)
+		{
+			solve_subsets(possible_values, unit);
+		}
+		else if ((possible_values->techniques & (SUDOKU_X_WING | SUDOKU_SWORDFISH)) &&
+			 possible_values->fish_values != 0)
+		{
+			const unsigned val = first_value(possible_values->fish_values);
+
+			possible_values->fish_values &= ~VALUE_BIT(val);
+			solve_fish(possible_values, val);
+		}
+		else
+		{
+			break;
+		}
+
+		if (possible_values->contradiction)
+		{
+			break;
+		}
+	}
+
+#ifdef KS_SUDOKU_DEBUG
+	printf("solve: Possibility vectors after applying the techniques:\n");
+	print_possibility_vector(sudoku_table, possible_values);
+#endif
+
+}
+
+/**
+  * Find the empty cell with the fewest possibilities (the first one of them).
+  * The techniques are expected to be stuck, so every empty cell has at least
+  * two possibilities and a filled cell (with none) is told apart by them alone.
+  *
+  * Returns false if there is no empty cell.
+  */
+static bool find_search_cell(struct possible_entries *possible_values,
+			     size_t *search_row, size_t *search_col)
+{
+	const value_mask *const cells = &possible_values->cell[0][0];
+	unsigned fewest = NUMBER_OF_VALUES+1;
+	size_t found = 0;
+
+	// there are no fewer than two once the naked singles are filled
+	for (size_t cell = 0; cell < TABLE_ORDER*TABLE_ORDER && fewest > 2; cell++)
+	{
+		const unsigned possibilities = count_values(cells[cell]);
+
+		if (possibilities != 0 && possibilities < fewest)
+		{
+			fewest = possibilities;
+			found = cell;
+		}
+	}
+
+	*search_row = found/TABLE_ORDER;
+	*search_col = found%TABLE_ORDER;
+
+	return fewest <= NUMBER_OF_VALUES;
+}
+
+/**
+  * Complete the table by trying every value possible for the cell with the fewest
+  * possibilities once the techniques above are stuck, and again for the table that
+  * results (in a depth-first manner). The techniques are applied after every
+  * guess. The changes made due to a guess that leads to a contradiction are
+  * undone using the changes recorded since the guess.
+  *
+  * Returns true if the table is solved. Otherwise the table is left as it was.
+  */
+static bool search(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+		   struct possible_entries *possible_values)
+{
+	size_t row = 0, col = 0;
+
+	solve(sudoku_table, possible_values);
+
+	if (possible_values->contradiction)
+	{
+		clear_naked_singles(&possible_values->naked_singles);
+		clear_hidden_singles(possible_values);
+		return false;
+	}
+
+	if (!find_search_cell(possible_values, &row, &col))
+	{
+		return true;
+	}
+
+	const size_t changes = possible_values->changes;
+	value_mask guesses = possible_values->cell[row][col];
+
+	while (guesses != 0)
+	{
+		const unsigned guess = first_value(guesses);
+		guesses &= ~VALUE_BIT(guess);
+
+#ifdef KS_SUDOKU_DEBUG
+		printf("search: guessing %u for row: %zu, col: %zu\n", guess, row, col);
+#endif
+
+		sudoku_table[row][col] = guess;
+		update_possibilities(sudoku_table, possible_values, row, col, guess);
+		possible_values->stats.guesses++;
+
+		if (search(sudoku_table, possible_values))
+		{
+			return true;
+		}
+
+		undo_changes(sudoku_table, possible_values, changes);
+	}
+
+	return false;
+}
+
+/**
+  * Initialise the given lookup table (whose techniques are set) for the table and
+  * apply the techniques until they are stuck. The moves are counted from zero.
+  *
+  * Returns false if there is a contradiction. Otherwise the rest of the table is
+  * to be searched (the changes made from here on are recorded).
+  */
+static bool initialise_table(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+			     struct possible_entries *possible_values)
+{
+	initialise_naked_single_queue(&possible_values->naked_singles);
+	clear_hidden_singles(possible_values);
+
+#ifdef KS_SUDOKU_DEBUG
+	printf("\n");
+	printf("solve_sudoku: 'sudoku_table' obtained as input\n");
+	print_table(&sudoku_table[0][0], TABLE_ORDER);
+#endif
+
+	initialise_used_values(sudoku_table, possible_values);
+
+	// every unit (and value) is to be searched by the other techniques
+	set_all_units(possible_values, true);
+
+	for (size_t row=0; row<TABLE_ORDER; row++)
+	{
+		for (size_t col=0; col<TABLE_ORDER; col++)
+		{
+			if (sudoku_table[row][col] == 0)
+			{
+				// initialise the possible values
+				initialise_possible_values(sudoku_table, possible_values, row, col);
+
+				// This could also be done in 'initialise_possible_values'.
+				// But doing this here saves us some unwanted checking.
+				if (count_values(possible_values->cell[row][col]) == 1)
+				{
+					insert_naked_single(&possible_values->naked_singles, row, col);
+				}
+			}
+		}
+	}
+
+	initialise_places(possible_values);
+
+#ifdef KS_SUDOKU_DEBUG
+	printf("solve_sudoku: Possibility vector after initialization:\n");
+	print_possibility_vector(sudoku_table, possible_values);
+
+	printf("solve_sudoku: Naked single possibilities:\n");
+	print_naked_singles(&possible_values->naked_singles);
+	printf("\n");
+#endif
+
+	if (possible_values->contradiction)
+	{
+		clear_naked_singles(&possible_values->naked_singles);
+		clear_hidden_singles(possible_values);
+		return false;
+	}
+
+	solve(sudoku_table, possible_values);
+
+	if (possible_values->contradiction)
+	{
+		clear_naked_singles(&possible_values->naked_singles);
+		clear_hidden_singles(possible_values);
+		return false;
+	}
+
+	// the techniques are stuck; the rest is found by searching
+	possible_values->searching = true;
+
+	return true;
+}
+
+/**
+  * Count the solutions of the table (once the techniques are stuck) by trying
+  * every value possible for the cell with the fewest possibilities, like 'search',
+  * but going on after a solution is found until 'limit' (> 0) of them are found.
+  * The search gives up once 'max_guesses' (if not 0) values are guessed. The
+  * changes made are undone, so the table is left as it was.
+  *
+  * Returns the number of solutions found or 'limit' if the search gave up.
+  */
+static unsigned count_solutions(unsigned sudoku_table[TABLE_ORDER][TABLE_ORDER],
+				struct possible_entries *possible_values,
+				unsigned limit, unsigned max_guesses)
+{
+	size_t row = 0, col = 0;
+	unsigned solutions = 0;
+
+	solve(sudoku_table, possible_values);
+
+	if (possible_values->contradiction)
+	{
+		clear_naked_singles(&possible_values->naked_singles);
+		clear_hidden_singles(possible_values);
+		return 0;
+	}
+
+	if (!find_search_cell(possible_values, &row, &col))
+	{
+		return 1;
+	}
+
+	const size_t changes = possible_values->changes;
+	value_mask guesses = possible_values->cell[row][col];
+
+	while (guesses != 0 && solutions < limit)
+	{
+		if (max_guesses != 0 && possible_values->stats.guesses == max_guesses)
+		{
+			return limit;
+		}
+
+		const unsigned guess = first_value(guesses);
+		guesses &= ~VALUE_BIT(guess);
+
+		sudoku_table[row][col] = guess;
+		update_possibilities(sudoku_table, possible_values, row, col, guess);
+		possible_values->stats.guesses++;
+
+		solutions += count_solutions(sudoku_table, possible_values, limit - solutions, max_guesses);
+		undo_changes(sudoku_table, possible_values, changes);
+	}
+
+	return solutions;
+}
+
+bool SOLVE_SUDOKU_ORDER(unsigned *sudoku_table, unsigned techniques, struct sudoku_stats *stats)
+{
+	// the lookup table used to identify the possibilities of different cells
+	struct possible_entries possible_values;
+
+	possible_values.techniques = techniques;
+
+	unsigned (*const table)[TABLE_ORDER] = (unsigned (*)[TABLE_ORDER])sudoku_table;
+	const bool solved = initialise_table(table, &possible_values) &&
+			    search(table, &possible_values);
+
+	if (stats != NULL)
+	{
+		*stats = possible_values.stats;
+	}
+
+	return solved;
+}
+
+unsigned COUNT_SUDOKU_SOLUTIONS_ORDER(const unsigned *sudoku_table, unsigned limit,
+				      unsigned max_guesses)
+{
+	struct possible_entries possible_values;
+	unsigned table[TABLE_ORDER][TABLE_ORDER];
+
+	possible_values.techniques = SUDOKU_DEFAULT_TECHNIQUES;
+
+	for (size_t cell=0; cell<TABLE_ORDER*TABLE_ORDER; cell++)
+	{
+		table[cell/TABLE_ORDER][cell%TABLE_ORDER] = sudoku_table[cell];
+	}
+
+	if (limit == 0 || !initialise_table(table, &possible_values))
+	{
+		return 0;
+	}
+
+	return count_solutions(table, &possible_values, limit, max_guesses);
+}
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef KS_SUDOKE_SOLVER_ORDER
+#define KS_SUDOKE_SOLVER_ORDER
+
+/**
+  * The definitions that depend on the order of the table being solved.
+  *
+  * The solver is compiled once for every order of the squares (see the
+  * 'solver_order_*.c' files). Every one of them defines 'SQUARE_ORDER' before
+  * including this, so the sizes below are constants in each of them.
+  */
+
+#ifndef SQUARE_ORDER
+#error "SQUARE_ORDER must be defined to the order of the squares"
+#endif
+
+#include "common.h"
+
+#define TABLE_ORDER (SQUARE_ORDER*SQUARE_ORDER)
+#define MIN_VALUE 1
+#define MAX_VALUE TABLE_ORDER
+#define NUMBER_OF_VALUES TABLE_ORDER
+
+/**
+  * Type of a set of values. The bit 'val-1' is set if the value 'val' is in the set.
+  * The smallest word that has a bit for every value is used.
+  */
+#if NUMBER_OF_VALUES <= 16
+typedef uint16_t value_mask;
+#else
+typedef uint32_t value_mask;
+#endif
+
+#define VALUE_BIT(val) ((value_mask)(1u << ((val) - MIN_VALUE)))
+#define ALL_VALUES ((value_mask)((1ull << NUMBER_OF_VALUES) - 1))
+
+/**
+  * Returns the number of values in the set.
+  */
+static inline unsigned count_values(value_mask values)
+{
+	return __builtin_popcount(values);
+}
+
+/**
+  * Returns the smallest value in the (non-empty) set.
+  */
+static inline unsigned first_value(value_mask values)
+{
+	return __builtin_ctz(values) + MIN_VALUE;
+}
+
+#include "naked_single_queue.h"
+
+/**
+  * The units (groups of cells) of the table: the rows are numbered [0, TABLE_ORDER),
+  * the columns after them and the squares after the columns.
+  */
+#define UNITS (3*TABLE_ORDER)
+#define UNIT_WORDS ((UNITS+63)/64)
+
+/**
+  * Type of a set of units. The bit 'unit%64' of the word 'unit/64' is set if
+  * the unit is in the set.
+  */
+struct unit_set
+{
+	uint64_t word[UNIT_WORDS];
+};
+
+/**
+  * Type of a set of positions of the cells in a unit. The bit 'position' is
+  * set if the cell at the position is in the set. The cells of a row (column)
+  * are at their columns (rows) and the cells of a square are numbered row-wise.
+  * A value mask has a bit for every cell of a unit.
+  */
+typedef value_mask position_mask;
+
+#define POSITION_BIT(position) ((position_mask)(1u << (position)))
+#define ALL_POSITIONS ((position_mask)((1ull << TABLE_ORDER) - 1))
+
+/**
+  * The positions of the cells of a row of a square (the first row) and of
+  * a column of a square (the first column). The former are also the positions
+  * of the cells of a row (column) in a square (the first one).
+  */
+#define SQUARE_ROW_POSITIONS ((position_mask)((1u << SQUARE_ORDER) - 1))
+#define SQUARE_COLUMN_POSITIONS ((position_mask)(ALL_POSITIONS / SQUARE_ROW_POSITIONS))
+
+/**
+  * Type of a "hidden single" found: the value could be filled in only one cell
+  * of the unit. The cell is found when the move is done.
+  */
+struct hidden_single
+{
+	uint8_t unit;
+	uint8_t value;
+};
+
+/**
+  * A "hidden single" is found when the cells of a unit where a value is possible
+  * drop to one. They only drop until a contradiction is undone (and none is left
+  * to be found when they are undone), so every unit and value is found at most once.
+  */
+#define HIDDEN_SINGLES_MAX (UNITS*NUMBER_OF_VALUES)
+
+/**
+  * Type of the queue of "hidden single" moves to be done.
+  */
+struct hidden_single_queue
+{
+	struct hidden_single move[HIDDEN_SINGLES_MAX];
+	unsigned first, last;
+};
+
+/**
+  * Type to hold a change made to the possibilities of a cell so that it
+  * could be undone (see 'undo_changes').
+  */
+struct change
+{
+	uint8_t row, col;
+	uint8_t filled;       // the value filled in the cell (0 if possibilities were only removed)
+	value_mask possible;  // the possibilities of the cell before the change
+};
+
+/**
+  * Every change removes at least one possibility of a cell or fills it,
+  * so there are at most this many changes on the way to a solution.
+  */
+#define CHANGES_MAX (TABLE_ORDER*TABLE_ORDER*(NUMBER_OF_VALUES+1))
+
+/**
+  * Type to hold the possible values of the cells (identified by row and column)
+  * and the values already filled in every row, column and square.
+  */
+struct possible_entries
+{
+	// the values possible for a cell (empty for a filled cell)
+	value_mask cell[TABLE_ORDER][TABLE_ORDER];
+
+	// the values filled in a row, column or square
+	value_mask row_used[TABLE_ORDER];
+	value_mask col_used[TABLE_ORDER];
+	value_mask square_used[TABLE_ORDER];
+
+	// the "naked single" moves to be done
+	struct naked_single_queue naked_singles;
+
+	// the positions of the cells of a unit where a value is possible,
+	// place[unit][val-MIN_VALUE] (kept as the possibilities are removed)
+	position_mask place[UNITS][NUMBER_OF_VALUES];
+
+	// the "hidden single" moves to be done
+	struct hidden_single_queue hidden_singles;
+
+	// the techniques applied besides the singles (SUDOKU_* flags)
+	unsigned techniques;
+
+	// the units whose possibilities changed since they were last searched
+	// for "naked doubles", the intersections of the squares and the lines
+	// and the other subsets (see 'solver_techniques.h')
+	struct unit_set naked_double_units;
+	struct unit_set intersection_units;
+	struct unit_set subset_units;
+
+	// the values whose places changed since they were last searched for fish
+	value_mask fish_values;
+
+	// the moves made so far
+	struct sudoku_stats stats;
+
+	// set when a cell is left with no possibilities or a value could
+	// no longer be filled in a row, column or square
+	bool contradiction;
+
+	// the changes made while searching (not kept otherwise)
+	bool searching;
+	size_t changes;
+	struct change change[CHANGES_MAX];
+};
+
+/**
+  * Returns the index of the square the given cell is in
+  * (the squares are numbered row-wise).
+  */
+static inline size_t square_of(size_t row, size_t col)
+{
+	return (row/SQUARE_ORDER)*SQUARE_ORDER + col/SQUARE_ORDER;
+}
+
+#endif
@@ -0,0 +1,8 @@
+/**
+  * The solver specialised for 4x4 tables.
+  */
+#define SQUARE_ORDER 2
+#define SOLVE_SUDOKU_ORDER solve_sudoku_order_2
+#define COUNT_SUDOKU_SOLUTIONS_ORDER count_sudoku_solutions_order_2
+
+#include "solver_kernel.h"
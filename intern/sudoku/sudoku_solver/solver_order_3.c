@@ -0,0 +1,8 @@
+/**
+  * The solver specialised for 9x9 tables.
+  */
+#define SQUARE_ORDER 3
+#define SOLVE_SUDOKU_ORDER solve_sudoku_order_3
+#define COUNT_SUDOKU_SOLUTIONS_ORDER count_sudoku_solutions_order_3
+
+#include "solver_kernel.h"
@@ -0,0 +1,8 @@
+/**
+  * The solver specialised for 16x16 tables.
+  */
+#define SQUARE_ORDER 4
+#define SOLVE_SUDOKU_ORDER solve_sudoku_order_4
+#define COUNT_SUDOKU_SOLUTIONS_ORDER count_sudoku_solutions_order_4
+
+#include "solver_kernel.h"
@@ -0,0 +1,8 @@
+/**
+  * The solver specialised for 25x25 tables.
+  */
+#define SQUARE_ORDER 5
+#define SOLVE_SUDOKU_ORDER solve_sudoku_order_5
+#define COUNT_SUDOKU_SOLUTIONS_ORDER count_sudoku_solutions_order_5
+
+#include "solver_kernel.h"
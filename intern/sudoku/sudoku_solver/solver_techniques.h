@@ -0,0 +1,452 @@
+#ifndef KS_SUDOKU_SOLVER_SOLVER_TECHNIQUES
+#define KS_SUDOKU_SOLVER_SOLVER_TECHNIQUES
+
+/**
+  * The techniques that only remove possibilities, besides the "naked doubles"
+  * (see 'solver_helpers.h'). They are applied when the singles are stuck and
+  * only when they are turned on (see the SUDOKU_* flags in 'sudoku_solver.h').
+  *
+  * They are found using the places of the values in the units (see
+  * 'remove_places'), so a set of cells or values is checked using a few
+  * bitwise operations.
+  */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "solver_order.h"
+#include "solver_helpers.h"
+
+#ifdef KS_SUDOKU_DEBUG
+#include <stdio.h>
+#endif
+
+/**
+  * Look for the values of the given square confined to a row or a column of it
+  * ("pointing pairs" and "pointing triples"). Such a value is removed from the
+  * rest of the row or the column.
+  */
+static void solve_pointing(struct possible_entries *possible_values, size_t unit)
+{
+	const size_t square = unit - 2*TABLE_ORDER;
+	const size_t top = (square/SQUARE_ORDER)*SQUARE_ORDER;
+	const size_t left = (square%SQUARE_ORDER)*SQUARE_ORDER;
+	value_mask values = ALL_VALUES & ~unit_used(possible_values, unit);
+
+	while (values != 0 && !possible_values->contradiction)
+	{
+		const unsigned val = first_value(values);
+		const value_mask val_bit = VALUE_BIT(val);
+		const position_mask place = possible_values->place[unit][val-MIN_VALUE];
+
+		values &= ~val_bit;
+
+		if (count_values(place) < 2)
+		{
+			continue;
+		}
+
+		const size_t square_row = __builtin_ctz(place)/SQUARE_ORDER;
+		const size_t square_col = __builtin_ctz(place)%SQUARE_ORDER;
+		bool removed = false;
+
+		if ((place & ~(SQUARE_ROW_POSITIONS << (square_row*SQUARE_ORDER))) == 0)
+		{
+			const size_t row = top + square_row;
+
+			removed = remove_from_cells(possible_values, row,
+						    possible_values->place[row][val-MIN_VALUE] &
+						    ~(SQUARE_ROW_POSITIONS << left),
+						    val_bit);
+		}
+		else if ((place & ~(SQUARE_COLUMN_POSITIONS << square_col)) == 0)
+		{
+			const size_t col = left + square_col;
+
+			removed = remove_from_cells(possible_values, TABLE_ORDER + col,
+						    possible_values->place[TABLE_ORDER + col][val-MIN_VALUE] &
+						    ~(SQUARE_ROW_POSITIONS << top),
+						    val_bit);
+		}
+
+		if (removed)
+		{
+
+#ifdef KS_SUDOKU_DEBUG
+			printf("solve_pointing: %u is confined to a line of square: %zu\n", val, square);
+#endif
+
+			possible_values->stats.pointing++;
+		}
+	}
+}
+
+/**
+  * Look for the values of the given row or column confined to a square
+  * ("box/line reduction"). Such a value is removed from the rest of the square.
+  */
+static void solve_box_line(struct possible_entries *possible_values, size_t unit)
+{
+	value_mask values = ALL_VALUES & ~unit_used(possible_values, unit);
+
+	while (values != 0 && !possible_values->contradiction)
+	{
+		const unsigned val = first_value(values);
+		const value_mask val_bit = VALUE_BIT(val);
+		const position_mask place = possible_values->place[unit][val-MIN_VALUE];
+
+		values &= ~val_bit;
+
+		if (count_values(place) < 2)
+		{
+			continue;
+		}
+
+		const size_t band = __builtin_ctz(place)/SQUARE_ORDER;
+
+		if (place & ~(SQUARE_ROW_POSITIONS << (band*SQUARE_ORDER)))
+		{
+			continue;
+		}
+
+		size_t square;
+		position_mask line;  // the positions of the cells of the line in the square
+
+		if (unit < TABLE_ORDER)
+		{
+			square = (unit/SQUARE_ORDER)*SQUARE_ORDER + band;
+			line = SQUARE_ROW_POSITIONS << ((unit%SQUARE_ORDER)*SQUARE_ORDER);
+		}
+		else
+		{
+			const size_t col = unit - TABLE_ORDER;
+
+			square = band*SQUARE_ORDER + col/SQUARE_ORDER;
+			line = SQUARE_COLUMN_POSITIONS << (col%SQUARE_ORDER);
+		}
+
+		if (remove_from_cells(possible_values, 2*TABLE_ORDER + square,
+				      possible_values->place[2*TABLE_ORDER + square][val-MIN_VALUE] & ~line,
+				      val_bit))
+		{
+
+#ifdef KS_SUDOKU_DEBUG
+			printf("solve_box_line: %u is confined to square: %zu of unit: %zu\n", val, square, unit);
+#endif
+
+			possible_values->stats.box_line++;
+		}
+	}
+}
+
+/**
+  * Look for three cells of the given unit whose possibilities are three values
+  * in all ("naked triples"). The values are removed from the other cells of it.
+  */
+static void solve_naked_triples(struct possible_entries *possible_values, size_t unit)
+{
+	// the cells of the unit with two or three possibilities
+	position_mask cells[TABLE_ORDER];
+	value_mask *possible[TABLE_ORDER];
+	size_t count = 0, row, col;
+
+	for (size_t position=0; position<TABLE_ORDER; position++)
+	{
+		unit_cell(unit, position, &row, &col);
+
+		const unsigned possibilities = count_values(possible_values->cell[row][col]);
+
+		if (possibilities == 2 || possibilities == 3)
+		{
+			cells[count] = POSITION_BIT(position);
+			possible[count] = &possible_values->cell[row][col];
+			count++;
+		}
+	}
+
+	for (size_t first=0; first<count; first++)
+	{
+		for (size_t second=first+1; second<count; second++)
+		{
+			for (size_t third=second+1; third<count; third++)
+			{
+				if (possible_values->contradiction)
+				{
+					return;
+				}
+
+				// the possibilities might have changed due to another triple
+				const value_mask triple = *possible[first] | *possible[second] | *possible[third];
+
+				if (count_values(triple) != 3)
+				{
+					continue;
+				}
+
+				if (remove_from_cells(possible_values, unit,
+						      ALL_POSITIONS & ~(cells[first] | cells[second] | cells[third]),
+						      triple))
+				{
+
+#ifdef KS_SUDOKU_DEBUG
+					printf("solve_naked_triples: found naked triple in unit: %zu\n", unit);
+#endif
+
+					possible_values->stats.naked_triples++;
+				}
+			}
+		}
+	}
+}
+
+/**
+  * Remove the other values from the given cells of the unit if the given values
+  * are possible only in them, as many cells as values ("hidden pairs" and
+  * "hidden triples").
+  */
+static void remove_hidden_subset(struct possible_entries *possible_values, size_t unit,
+				 value_mask subset, position_mask cells)
+{
+	if (count_values(cells) != count_values(subset) ||
+	    !remove_from_cells(possible_values, unit, cells, ALL_VALUES & ~subset))
+	{
+		return;
+	}
+
+#ifdef KS_SUDOKU_DEBUG
+	printf("remove_hidden_subset: found hidden subset of %u values in unit: %zu\n",
+		count_values(subset), unit);
+#endif
+
+	if (count_values(subset) == 2)
+	{
+		possible_values->stats.hidden_pairs++;
+	}
+	else
+	{
+		possible_values->stats.hidden_triples++;
+	}
+}
+
+/**
+  * Look for 'size' (two or three) values of the given unit that are possible
+  * in only 'size' cells of it in all. The other values are removed from the cells.
+  */
+static void solve_hidden_subsets(struct possible_entries *possible_values, size_t unit,
+				 unsigned size)
+{
+	const value_mask used = unit_used(possible_values, unit);
+	const position_mask *const place = possible_values->place[unit];
+
+	// the values possible in two to 'size' cells of the unit
+	unsigned values[NUMBER_OF_VALUES];
+	size_t count = 0;
+
+	for (unsigned val=MIN_VALUE; val<=MAX_VALUE; val++)
+	{
+		const unsigned places = count_values(place[val-MIN_VALUE]);
+
+		if ((used & VALUE_BIT(val)) == 0 && places >= 2 && places <= size)
+		{
+			values[count++] = val;
+		}
+	}
+
+	// the places might change due to another subset, so they are read every time
+	for (size_t first=0; first<count && !possible_values->contradiction; first++)
+	{
+		for (size_t second=first+1; second<count && !possible_values->contradiction; second++)
+		{
+			const value_mask pair = VALUE_BIT(values[first]) | VALUE_BIT(values[second]);
+			const position_mask pair_cells = place[values[first]-MIN_VALUE] |
+							 place[values[second]-MIN_VALUE];
+
+			if (size == 2)
+			{
+				remove_hidden_subset(possible_values, unit, pair, pair_cells);
+				continue;
+			}
+
+			for (size_t third=second+1; third<count && !possible_values->contradiction; third++)
+			{
+				remove_hidden_subset(possible_values, unit,
+						     pair | VALUE_BIT(values[third]),
+						     pair_cells | place[values[third]-MIN_VALUE]);
+			}
+		}
+	}
+}
+
+/**
+  * Remove the value from the cover lines but for the cells in the base lines if
+  * it is possible only in as many cover lines as base lines ("X-Wing" and
+  * "Swordfish"). The positions of the cells of a base line are the cover lines
+  * and the other way round, so the cover line 'cover' is the unit 'cover_unit+cover'.
+  *
+  * Returns true if a possibility was removed.
+  */
+static bool remove_fish(struct possible_entries *possible_values, unsigned val, size_t cover_unit,
+			position_mask base_lines, position_mask cover_lines)
+{
+	bool removed = false;
+
+	if (count_values(cover_lines) != count_values(base_lines))
+	{
+		return false;
+	}
+
+	while (cover_lines != 0)
+	{
+		const size_t cover = cover_unit + __builtin_ctz(cover_lines);
+
+		cover_lines &= cover_lines - 1;
+		removed |= remove_from_cells(possible_values, cover,
+					     possible_values->place[cover][val-MIN_VALUE] & ~base_lines,
+					     VALUE_BIT(val));
+	}
+
+	if (!removed)
+	{
+		return false;
+	}
+
+#ifdef KS_SUDOKU_DEBUG
+	printf("remove_fish: found fish of size %u for %u\n", count_values(base_lines), val);
+#endif
+
+	if (count_values(base_lines) == 2)
+	{
+		possible_values->stats.x_wings++;
+	}
+	else
+	{
+		possible_values->stats.swordfish++;
+	}
+
+	return true;
+}
+
+/**
+  * Look for 'size' (two or three) base lines (all rows or all columns, starting
+  * at the unit 'base_unit') in which the given value is possible only in 'size'
+  * cover lines (the columns or the rows, starting at the unit 'cover_unit') in all.
+  * The value is removed from the rest of the cover lines.
+  *
+  * Returns true if a possibility was removed.
+  */
+static bool solve_fish_helper(struct possible_entries *possible_values, unsigned val,
+			      size_t base_unit, size_t cover_unit, unsigned size)
+{
+	bool found_fish = false;
+
+	// the base lines where the value is possible in two to 'size' cells
+	size_t bases[TABLE_ORDER];
+	size_t count = 0;
+
+	for (size_t base=0; base<TABLE_ORDER; base++)
+	{
+		const unsigned places = count_values(possible_values->place[base_unit+base][val-MIN_VALUE]);
+
+		if ((unit_used(possible_values, base_unit+base) & VALUE_BIT(val)) == 0 &&
+		    places >= 2 && places <= size)
+		{
+			bases[count++] = base;
+		}
+	}
+
+	// the places might change due to another fish, so they are read every time
+	for (size_t first=0; first<count && !possible_values->contradiction; first++)
+	{
+		for (size_t second=first+1; second<count && !possible_values->contradiction; second++)
+		{
+			const position_mask base_pair = POSITION_BIT(bases[first]) | POSITION_BIT(bases[second]);
+			const position_mask cover_pair = possible_values->place[base_unit+bases[first]][val-MIN_VALUE] |
+							 possible_values->place[base_unit+bases[second]][val-MIN_VALUE];
+
+			if (size == 2)
+			{
+				found_fish |= remove_fish(possible_values, val, cover_unit, base_pair, cover_pair);
+				continue;
+			}
+
+			for (size_t third=second+1; third<count && !possible_values->contradiction; third++)
+			{
+				found_fish |= remove_fish(possible_values, val, cover_unit,
+							  base_pair | POSITION_BIT(bases[third]),
+							  cover_pair |
+							  possible_values->place[base_unit+bases[third]][val-MIN_VALUE]);
+			}
+		}
+	}
+
+	return found_fish;
+}
+
+/**
+  * Apply the intersection technique turned on for the given unit: "pointing"
+  * for a square and "box/line reduction" for a row or a column.
+  */
+static void solve_intersections(struct possible_entries *possible_values, size_t unit)
+{
+	if (unit >= 2*TABLE_ORDER)
+	{
+		if (possible_values->techniques & SUDOKU_POINTING)
+		{
+			solve_pointing(possible_values, unit);
+		}
+	}
+	else if (possible_values->techniques & SUDOKU_BOX_LINE)
+	{
+		solve_box_line(possible_values, unit);
+	}
+}
+
+/**
+  * Apply the subset techniques turned on (other than the "naked doubles") to
+  * the given unit.
+  */
+static void solve_subsets(struct possible_entries *possible_values, size_t unit)
+{
+	if (possible_values->techniques & SUDOKU_NAKED_TRIPLES)
+	{
+		solve_naked_triples(possible_values, unit);
+	}
+
+	if ((possible_values->techniques & SUDOKU_HIDDEN_PAIRS) && !possible_values->contradiction)
+	{
+		solve_hidden_subsets(possible_values, unit, 2);
+	}
+
+	if ((possible_values->techniques & SUDOKU_HIDDEN_TRIPLES) && !possible_values->contradiction)
+	{
+		solve_hidden_subsets(possible_values, unit, 3);
+	}
+}
+
+/**
+  * Apply the fish turned on for the given value, with the rows as the base
+  * lines and then with the columns.
+  */
+static void solve_fish(struct possible_entries *possible_values, unsigned val)
+{
+	for (unsigned size=2; size<=3; size++)
+	{
+		if ((possible_values->techniques & ((size == 2) ? SUDOKU_X_WING : SUDOKU_SWORDFISH)) == 0)
+		{
+			continue;
+		}
+
+		if (solve_fish_helper(possible_values, val, 0, TABLE_ORDER, size) ||
+		    possible_values->contradiction)
+		{
+			return;
+		}
+
+		if (solve_fish_helper(possible_values, val, TABLE_ORDER, 0, size) ||
+		    possible_values->contradiction)
+		{
+			return;
+		}
+	}
+}
+
+#endif
@@ -4,24 +4,122 @@
 #ifndef KS_SUDOKU_SOLVER
 #define KS_SUDOKU_SOLVER
 
+#include <stdbool.h>
+
+// the order of the classic table (solved by 'solve_sudoku')
 #define TABLE_ORDER_MAX 9
 
+// the orders of the squares of the tables that could be solved by 'solve_sudoku_order'
+#define SQUARE_ORDER_MIN 2
+#define SQUARE_ORDER_MAX 5
+
 /**
   * Assumptions:
   *
-  *   - 9*9 solvable sudoku table
+  *   - 9*9 sudoku table
   *   - empty cells are represneted by '0'
   *   - no invalid table entries (i.e.) table entries are in range [0, 9]
   *
-  * This is not a program that can solve every single sudoku table in the wild.
-  * It currently tries to solve sudoku using the following techniques,
+  * It tries to solve sudoku using the following techniques,
   *
   *    - Naked single detection
   *    - Hidden single detection
   *    - Naked double detection
+  *    - Pointing pairs and triples, box/line reduction
+  *
+  * (the techniques besides the singles are in SUDOKU_DEFAULT_TECHNIQUES below).
+  *
+  * When they don't suffice, the rest of the table is searched for by guessing the
+  * values of the cells with the fewest possibilities (applying the techniques after
+  * every guess).
   *
   * Note: The resulting solved table is stored in the table given as input.
+  *
+  * Returns true if the table was solved. Otherwise the table has no solution and
+  * it is left filled as far as the techniques could fill it.
+  */
+bool solve_sudoku(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX]);
+
+/**
+  * The techniques that could be turned on or off (see 'solve_sudoku_techniques').
+  * "Naked singles" and "hidden singles" are always applied.
+  */
+#define SUDOKU_NAKED_DOUBLES   (1u << 0)
+#define SUDOKU_POINTING        (1u << 1)  // pointing pairs and triples (a square and a line)
+#define SUDOKU_BOX_LINE        (1u << 2)  // box/line reduction (a line and a square)
+#define SUDOKU_NAKED_TRIPLES   (1u << 3)
+#define SUDOKU_HIDDEN_PAIRS    (1u << 4)
+#define SUDOKU_HIDDEN_TRIPLES  (1u << 5)
+#define SUDOKU_X_WING          (1u << 6)
+#define SUDOKU_SWORDFISH       (1u << 7)
+
+#define SUDOKU_ALL_TECHNIQUES  ((1u << 8) - 1)
+
+// the techniques applied by 'solve_sudoku', 'solve_sudoku_stats' and 'solve_sudoku_order'
+#define SUDOKU_DEFAULT_TECHNIQUES (SUDOKU_NAKED_DOUBLES | SUDOKU_POINTING | SUDOKU_BOX_LINE)
+
+/**
+  * The moves made to solve a sudoku table. The techniques other than the singles
+  * are counted when they removed a possibility of another cell.
+  */
+struct sudoku_stats
+{
+	unsigned naked_singles;   // cells filled as "naked singles"
+	unsigned hidden_singles;  // cells filled as "hidden singles"
+	unsigned naked_doubles;   // "naked doubles"
+	unsigned pointing;        // values of a square confined to a line
+	unsigned box_line;        // values of a line confined to a square
+	unsigned naked_triples;   // "naked triples"
+	unsigned hidden_pairs;    // "hidden pairs"
+	unsigned hidden_triples;  // "hidden triples"
+	unsigned x_wings;         // "X-Wings"
+	unsigned swordfish;       // "Swordfish"
+	unsigned guesses;         // values guessed while searching
+};
+
+/**
+  * Same as 'solve_sudoku' but also fills in the moves made into 'stats'.
+  *
+  * It could be called from many threads at once (for different tables).
+  */
+bool solve_sudoku_stats(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX],
+			struct sudoku_stats *stats);
+
+/**
+  * Same as 'solve_sudoku_stats' but for a table whose squares are of the given
+  * order, i.e., a (square_order^2)*(square_order^2) table (16*16 for 4, 25*25 for 5)
+  * with values in the range [1, square_order^2]. The cells of the table are given
+  * row after row. 'stats' could be NULL.
+  *
+  * The solver is specialised at compile time for every order in the range
+  * [SQUARE_ORDER_MIN, SQUARE_ORDER_MAX]. For other orders false is returned and
+  * the table is left as it is.
+  */
+bool solve_sudoku_order(unsigned square_order, unsigned *sudoku_table,
+			struct sudoku_stats *stats);
+
+/**
+  * Same as 'solve_sudoku_order' but only the given techniques (SUDOKU_* flags)
+  * are applied besides the singles. Every table that has a solution is still
+  * solved; the techniques only decide how much is left to be searched.
+  */
+bool solve_sudoku_techniques(unsigned square_order, unsigned techniques,
+			     unsigned *sudoku_table, struct sudoku_stats *stats);
+
+/**
+  * Count the solutions of a table whose squares are of the given order (given
+  * like for 'solve_sudoku_order'), but only up to 'limit' of them. A limit of 2
+  * is enough to tell whether a puzzle has a unique solution. The table is left
+  * as it is.
+  *
+  * Proving that there is no other solution could take a lot of guessing for the
+  * larger tables, so the search gives up after 'max_guesses' guesses (0 for no
+  * limit). It is then taken to have 'limit' solutions, so a puzzle is never taken
+  * to have a unique solution without a proof.
+  *
+  * Returns the number of solutions found (0 for an order that isn't supported).
   */
-void solve_sudoku(unsigned sudoku_table[TABLE_ORDER_MAX][TABLE_ORDER_MAX]);
+unsigned count_sudoku_solutions(unsigned square_order, const unsigned *sudoku_table,
+				unsigned limit, unsigned max_guesses);
 
 #endif